@@ -9,6 +9,8 @@ import numpy as np
 from datetime import datetime, timedelta
 import random
 from pathlib import Path
+import os
+import shutil
 
 # Set random seed for reproducible data
 np.random.seed(42)
@@ -209,9 +211,11 @@ def generate_sales_fact(time_dim, geo_dim, product_dim, customer_dim, num_record
 def main():
     """Generate all dimensions and fact table, then save to both Parquet and CSV files."""
     # Create output directories
-    parquet_dir = Path('olap_data')
+    # OLAP_DATA_PATH and OLAP_SALES_RECORDS size the data set, e.g. for the
+    # olap_bench scale factors (olap_bench_data/sf10M with 10000000 records)
+    parquet_dir = Path(os.environ.get('OLAP_DATA_PATH', 'olap_data'))
     csv_dir = Path('csv_data')
-    parquet_dir.mkdir(exist_ok=True)
+    parquet_dir.mkdir(parents=True, exist_ok=True)
     csv_dir.mkdir(exist_ok=True)
     
     print("Generating OLAP sample data...")
@@ -231,7 +235,8 @@ def main():
     
     # Generate fact table
     print("Generating sales fact table...")
-    sales_fact = generate_sales_fact(time_dim, geo_dim, product_dim, customer_dim, 1000000)
+    sales_fact = generate_sales_fact(time_dim, geo_dim, product_dim, customer_dim,
+                                     int(os.environ.get('OLAP_SALES_RECORDS', 1000000)))
     
     # Save to Parquet files
     print("Saving to Parquet files...")
@@ -240,6 +245,12 @@ def main():
     product_dim.to_parquet(parquet_dir / 'dim_product.parquet', index=False)
     customer_dim.to_parquet(parquet_dir / 'dim_customer.parquet', index=False)
     sales_fact.to_parquet(parquet_dir / 'fact_sales.parquet', index=False)
+    if os.environ.get('OLAP_PARTITION_FACTS') == '1':
+        # Hive-partitioned copy (fact_sales/year=YYYY/month=M/*.parquet); the
+        # analyzers read the directory instead of fact_sales.parquet
+        partitioned = sales_fact.merge(time_dim[['date_key', 'year', 'month']], on='date_key')
+        shutil.rmtree(parquet_dir / 'fact_sales', ignore_errors=True)
+        partitioned.to_parquet(parquet_dir / 'fact_sales', partition_cols=['year', 'month'], index=False)
     
     # Save to CSV files
     print("Saving to CSV files...")
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <arrow/acero/exec_plan.h>
+#include <arrow/acero/options.h>
+#include <arrow/api.h>
+#include <arrow/compute/api.h>
+#include "arrow_kernels.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Building blocks for analyses expressed as Acero execution plans.
+ * A plan is an arrow::acero::Declaration tree (source -> filter -> project
+ * -> hash_join -> aggregate -> order_by) that Acero runs pipelined: each
+ * source batch flows through every node on Arrow's CPU thread pool, so no
+ * operator materializes its whole output before the next one starts. Only
+ * the build side of a hash join and the aggregate's hash table are held in
+ * full. The helpers cover the star-schema shapes the analyzer needs; other
+ * nodes are plain Declarations.
+ */
+namespace olap {
+
+// Source node over an in-memory table, emitting batches of at most batch_rows.
+arrow::acero::Declaration TableSource(std::shared_ptr<arrow::Table> table,
+                                      int64_t batch_rows = kDefaultBatchRows);
+
+// Source node over a batch stream, e.g. ParquetSource::ReadBatches; the
+// reader is drained once, so every run of a plan needs a fresh one.
+arrow::acero::Declaration ReaderSource(std::shared_ptr<arrow::RecordBatchReader> reader);
+
+// Inner hash join of input (probe side) with dimension (build side) on key.
+// The output holds every input column and every dimension column; the
+// dimension's copy of key is renamed <key>_dim.
+arrow::acero::Declaration JoinDimension(arrow::acero::Declaration input,
+                                        std::shared_ptr<arrow::Table> dimension,
+                                        const std::string& key);
+
+// Hash aggregation of input by keys (a scalar aggregation when keys is
+// empty); aggregates name hash_* functions, or their scalar forms when keys
+// is empty.
+arrow::acero::Declaration Aggregate(arrow::acero::Declaration input,
+                                    std::vector<arrow::compute::Aggregate> aggregates,
+                                    std::vector<arrow::FieldRef> keys = {});
+
+arrow::acero::Declaration OrderBy(arrow::acero::Declaration input,
+                                  std::vector<arrow::compute::SortKey> sort_keys);
+
+// Runs plan on Arrow's CPU thread pool and collects its output; buffers
+// come from memory_pool().
+arrow::Result<std::shared_ptr<arrow::Table>> RunPlan(const arrow::acero::Declaration& plan);
+
+}  // namespace olap
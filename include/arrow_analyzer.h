@@ -5,6 +5,19 @@
 #include <parquet/arrow/reader.h>
 #include <arrow/table.h>
 #include <arrow/io/file.h>
+#include "acero_plan.h"
+#include "arrow_kernels.h"
+#include "chunked_column.h"
+#include "dimension_index.h"
+#include "hash_join.h"
+#include "lazy_table.h"
+#include "memory_pool.h"
+#include "morsel_executor.h"
+#include "parquet_source.h"
+#include "row_group_filter.h"
+#include "sales_cube.h"
+#include "tdigest.h"
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -17,40 +30,122 @@
  */
 class ArrowOLAPAnalyzer {
 private:
-    std::shared_ptr<arrow::Table> sales_table_;
-    std::shared_ptr<arrow::Table> time_table_;
-    std::shared_ptr<arrow::Table> geography_table_;
-    std::shared_ptr<arrow::Table> product_table_;
-    std::shared_ptr<arrow::Table> customer_table_;
+    // Opened for metadata only; columns load on first use and stay cached
+    std::shared_ptr<olap::LazyTable> sales_table_;
+    std::shared_ptr<olap::LazyTable> time_table_;
+    std::shared_ptr<olap::LazyTable> geography_table_;
+    std::shared_ptr<olap::LazyTable> product_table_;
+    std::shared_ptr<olap::LazyTable> customer_table_;
+    
+    // Surrogate-key indexes, built over the dimension key columns at load
+    std::shared_ptr<olap::DimensionIndex> time_index_;
+    std::shared_ptr<olap::DimensionIndex> geography_index_;
+    std::shared_ptr<olap::DimensionIndex> product_index_;
+    std::shared_ptr<olap::DimensionIndex> customer_index_;
+    
+    // Streaming mode never caches fact columns; it scans projected record
+    // batches of at most batch_rows_ rows per analysis
+    bool streaming_ = false;
+    int64_t batch_rows_ = olap::kDefaultBatchRows;
+    
+    // Parquet reader settings; the row-group subset applies to the fact table
+    olap::LoadOptions load_options_;
+    
+    // t-digest compression for approximate (streaming and per-group) quantiles
+    double quantile_compression_ = olap::TDigest::kDefaultCompression;
+    
+    // Distinct counts switch to HyperLogLog sketches at high cardinality
+    bool approximate_distinct_ = false;
+    
+    // Worker threads and morsel size of the parallel star-join aggregations
+    olap::MorselExecutor executor_;
+    
+    // Which implementation runs the analyses: the hand-written kernels
+    // (native), Acero execution plans, or both one after the other
+    bool run_native_ = true;
+    bool run_acero_ = false;
+    
+    // Precomputed rollups, set when sales_cube.parquet matches the current
+    // fact and dimension files; the additive rollups (by year, by region,
+    // by region and category) are then re-summed from its cells
+    bool use_cube_ = true;
+    std::shared_ptr<olap::SalesCube> cube_;
 
     // Helper methods
-    arrow::Status LoadParquetFile(const std::string& filename, 
-                                 std::shared_ptr<arrow::Table>& table);
+    arrow::Status OpenParquetFile(const std::string& filename, 
+                                 std::shared_ptr<olap::LazyTable>& table,
+                                 const olap::LoadOptions& options);
     
     arrow::Result<std::shared_ptr<arrow::Table>> JoinTables(
         std::shared_ptr<arrow::Table> left,
         std::shared_ptr<arrow::Table> right,
         const std::string& left_key,
-        const std::string& right_key);
-    
-    arrow::Result<std::shared_ptr<arrow::Table>> GroupByAndSum(
-        std::shared_ptr<arrow::Table> table,
-        const std::vector<std::string>& group_columns,
-        const std::vector<std::string>& sum_columns);
+        const std::string& right_key,
+        olap::JoinType join_type = olap::JoinType::kInner);
     
     void PrintTable(std::shared_ptr<arrow::Table> table, 
                    const std::string& title,
                    int max_rows = 10);
     
-    arrow::Result<std::shared_ptr<arrow::Array>> GetColumnAsArray(
-        std::shared_ptr<arrow::Table> table,
-        const std::string& column_name);
+    // One cached fact table column. Invalid in streaming mode, which never
+    // materializes a whole column: streaming callers go through ScanFacts.
+    arrow::Result<olap::ChunkedColumn> GetFactColumn(const std::string& column_name);
+    
+    // Calls fn on record batches of the projected fact columns, from memory
+    // or streamed from the Parquet file
+    arrow::Status ScanFacts(const std::vector<std::string>& columns,
+                            const std::function<arrow::Status(const arrow::RecordBatch&)>& fn);
+    
+    // ScanFacts over the rows matching every predicate. Row groups whose
+    // statistics rule out a match are skipped before decoding; fn sees the
+    // exactly filtered rows of the others, with the predicate columns added.
+    arrow::Status ScanFactsWhere(const std::vector<std::string>& columns,
+                                 const std::vector<olap::ColumnPredicate>& predicates,
+                                 const std::function<arrow::Status(const arrow::RecordBatch&)>& fn,
+                                 olap::PruneStats* stats = nullptr);
+    
+    // Star join followed by a hash aggregation, one fact morsel at a time,
+    // so the joined fact table is never materialized as a whole. Morsels run
+    // on the executor's workers, each aggregating into its own table; the
+    // partial tables are merged at the end. quantiles maps sum columns to
+    // per-group quantiles estimated with t-digests; distinct_columns are
+    // integer columns counted per group as <column>_distinct.
+    arrow::Result<std::shared_ptr<arrow::Table>> AggregateFacts(
+        const std::vector<std::string>& fact_columns,
+        const std::function<arrow::Result<std::shared_ptr<arrow::Table>>(
+            std::shared_ptr<arrow::Table>)>& star_join,
+        const std::vector<std::string>& group_columns,
+        const std::vector<std::string>& sum_columns,
+        const std::unordered_map<std::string, std::vector<double>>& quantiles = {},
+        const std::vector<std::string>& distinct_columns = {});
+    
+    // Acero source node over the projected fact columns: the cached table,
+    // or in streaming mode a fresh batch stream from the Parquet file
+    arrow::Result<arrow::acero::Declaration> AceroFactSource(const std::vector<std::string>& columns);
+    
+    // Index built at load time for a cached dimension key column, if keys is one
+    std::shared_ptr<olap::DimensionIndex> FindDimensionIndex(const arrow::ChunkedArray& keys) const;
 
 public:
-    ArrowOLAPAnalyzer() = default;
+    // Reads OLAP_ARROW_STREAMING (1 enables streaming mode), OLAP_BATCH_ROWS
+    // (streaming batch size), OLAP_QUANTILE_COMPRESSION (t-digest compression),
+    // OLAP_APPROX_DISTINCT (1 allows approximate distinct counts),
+    // OLAP_ARROW_BACKEND (native, acero or both), OLAP_USE_CUBE (0 ignores
+    // a fresh sales cube), the reader settings of
+    // LoadOptions::FromEnvironment and the executor settings of
+    // MorselExecutor::FromEnvironment
+    ArrowOLAPAnalyzer();
     ~ArrowOLAPAnalyzer() = default;
 
-    // Main interface methods
+    // Streaming mode must be chosen before LoadAllTables
+    void SetStreaming(bool enabled, int64_t batch_rows = olap::kDefaultBatchRows);
+    void SetLoadOptions(const olap::LoadOptions& options) { load_options_ = options; }
+    // Rows of the fact table as opened (after any OLAP_FACT_YEARS filter);
+    // 0 before LoadAllTables
+    int64_t num_fact_rows() const { return sales_table_ ? sales_table_->num_rows() : 0; }
+
+    // Main interface methods; LoadAllTables first moves olap::memory_pool()
+    // onto the allocator named by OLAP_MEMORY_POOL (system, jemalloc or mimalloc)
     arrow::Status LoadAllTables();
     arrow::Status AnalyzeSalesByTime();
     arrow::Status AnalyzeSalesByGeography();
@@ -58,7 +153,12 @@ public:
     arrow::Status AnalyzeCustomerSegments();
     arrow::Status MultidimensionalAnalysis();
     
+    // The grouped analyses above as Acero execution plans, each run
+    // pipelined from the fact source through joins and aggregation
+    arrow::Status RunAceroAnalyses();
+    
     // Utility methods
     void PrintDataInfo();
+    void PrintLoadedColumns();
     arrow::Status RunAllAnalyses();
 };
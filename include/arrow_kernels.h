@@ -0,0 +1,208 @@
+#pragma once
+
+#include <arrow/api.h>
+#include <arrow/util/bit_util.h>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Typed aggregation kernels over Arrow arrays.
+ * Kernels read value buffers and validity bitmaps directly instead of
+ * materializing a Scalar per row. Each call works on a single contiguous
+ * array (one chunk or one record batch column), so callers stream over
+ * chunked data and keep a small per-batch scratch buffer of group codes.
+ *
+ * A group code is a dense non-negative int32 identifying the output group
+ * of a row; -1 marks a row that must be skipped (null or unmatched key).
+ */
+namespace olap {
+
+constexpr int32_t kNoGroup = -1;
+
+// Default number of rows handed to a kernel at a time; keeps the per-batch
+// scratch buffers resident in L2.
+constexpr int64_t kDefaultBatchRows = 64 * 1024;
+
+// Slices table into zero-copy record batches of at most batch_rows rows
+// whose columns are aligned, and calls fn(const arrow::RecordBatch&) on each.
+template <typename Fn>
+arrow::Status ForEachBatch(const arrow::Table& table, int64_t batch_rows, Fn&& fn) {
+    arrow::TableBatchReader reader(table);
+    reader.set_chunksize(batch_rows);
+    std::shared_ptr<arrow::RecordBatch> batch;
+    while (true) {
+        ARROW_RETURN_NOT_OK(reader.ReadNext(&batch));
+        if (!batch) {
+            return arrow::Status::OK();
+        }
+        ARROW_RETURN_NOT_OK(fn(*batch));
+    }
+}
+
+// Calls visitor(const T* values) with the typed value pointer of an
+// integer array (offset already applied).
+template <typename Visitor>
+arrow::Status VisitIntegerValues(const arrow::Array& array, Visitor&& visitor) {
+    switch (array.type_id()) {
+        case arrow::Type::INT32:
+            return visitor(static_cast<const arrow::Int32Array&>(array).raw_values());
+        case arrow::Type::INT64:
+            return visitor(static_cast<const arrow::Int64Array&>(array).raw_values());
+        default:
+            return arrow::Status::TypeError("Expected int32/int64 key column, got ",
+                                            array.type()->ToString());
+    }
+}
+
+// Same for double, int32 and int64 arrays.
+template <typename Visitor>
+arrow::Status VisitNumericValues(const arrow::Array& array, Visitor&& visitor) {
+    if (array.type_id() == arrow::Type::DOUBLE) {
+        return visitor(static_cast<const arrow::DoubleArray&>(array).raw_values());
+    }
+    return VisitIntegerValues(array, visitor);
+}
+
+// Whether type is a dictionary with string values, e.g. a Parquet string
+// column read with LoadOptions::read_dictionary.
+inline bool IsStringDictionary(const arrow::DataType& type) {
+    if (type.id() != arrow::Type::DICTIONARY) {
+        return false;
+    }
+    const auto& value_type = *static_cast<const arrow::DictionaryType&>(type).value_type();
+    return value_type.id() == arrow::Type::STRING || value_type.id() == arrow::Type::LARGE_STRING;
+}
+
+// Calls visitor(int64_t i, std::string_view value) for every valid entry
+// of a string or large_string array, or of a dictionary array of those.
+template <typename Visitor>
+arrow::Status VisitStringValues(const arrow::Array& array, Visitor&& visitor) {
+    auto visit = [&](const auto& strings) {
+        for (int64_t i = 0; i < strings.length(); ++i) {
+            if (strings.IsValid(i)) {
+                visitor(i, std::string_view(strings.GetView(i)));
+            }
+        }
+        return arrow::Status::OK();
+    };
+    switch (array.type_id()) {
+        case arrow::Type::STRING:
+            return visit(static_cast<const arrow::StringArray&>(array));
+        case arrow::Type::LARGE_STRING:
+            return visit(static_cast<const arrow::LargeStringArray&>(array));
+        case arrow::Type::DICTIONARY: {
+            // Each row decoded through its dictionary entry
+            const auto& encoded = static_cast<const arrow::DictionaryArray&>(array);
+            auto decode = [&](const auto& strings) {
+                for (int64_t i = 0; i < encoded.length(); ++i) {
+                    if (encoded.IsValid(i)) {
+                        const int64_t index = encoded.GetValueIndex(i);
+                        if (strings.IsValid(index)) {
+                            visitor(i, std::string_view(strings.GetView(index)));
+                        }
+                    }
+                }
+                return arrow::Status::OK();
+            };
+            const arrow::Array& dictionary = *encoded.dictionary();
+            if (dictionary.type_id() == arrow::Type::STRING) {
+                return decode(static_cast<const arrow::StringArray&>(dictionary));
+            }
+            if (dictionary.type_id() == arrow::Type::LARGE_STRING) {
+                return decode(static_cast<const arrow::LargeStringArray&>(dictionary));
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return arrow::Status::TypeError("Expected string column, got ", array.type()->ToString());
+}
+
+// Resolves every key through lookup(int64_t) -> int32_t and writes the
+// resulting group code to codes[0, keys.length()). Null keys map to kNoGroup.
+template <typename Lookup>
+arrow::Status LookupGroupCodes(const arrow::Array& keys, const Lookup& lookup,
+                               int32_t* codes) {
+    const int64_t length = keys.length();
+    const uint8_t* validity = keys.null_count() > 0 ? keys.null_bitmap_data() : nullptr;
+    const int64_t offset = keys.offset();
+    return VisitIntegerValues(keys, [&](const auto* values) {
+        if (validity == nullptr) {
+            for (int64_t i = 0; i < length; ++i) {
+                codes[i] = lookup(static_cast<int64_t>(values[i]));
+            }
+        } else {
+            for (int64_t i = 0; i < length; ++i) {
+                codes[i] = arrow::bit_util::GetBit(validity, offset + i)
+                               ? lookup(static_cast<int64_t>(values[i]))
+                               : kNoGroup;
+            }
+        }
+        return arrow::Status::OK();
+    });
+}
+
+// Sets codes[i] to kNoGroup wherever array[i] is null, so that later
+// kernels only see rows where every participating column is valid.
+void InvalidateNulls(const arrow::Array& array, int32_t* codes);
+
+// Folds a second code vector into codes as codes * minor_cardinality + minor,
+// producing one composite code per row for two-dimensional grouping.
+void CombineGroupCodes(const int32_t* minor, int32_t minor_cardinality,
+                       int32_t* codes, int64_t length);
+
+// Adds values[i] to sums[codes[i]] for every row with a group code.
+// counts may be null; otherwise counts[codes[i]] is incremented as well.
+// Accepts int32, int64 and double value columns.
+arrow::Status SumByGroup(const arrow::Array& values, const int32_t* codes,
+                         double* sums, int64_t* counts);
+
+// Folds every valid values[i] of a row with a group code into that group's
+// running sum, count, min and max, and into its running mean and sum of
+// squared deviations from the mean (m2) by Welford's update. Null values
+// are skipped, so counts[g] is the number of non-null values seen for group
+// g. Accepts int32, int64 and double value columns; double columns sum into
+// sums, integer columns exactly into integer_sums.
+arrow::Status AccumulateByGroup(const arrow::Array& values, const int32_t* codes,
+                                double* sums, int64_t* integer_sums, int64_t* counts,
+                                double* mins, double* maxs, double* means, double* m2s);
+
+// Folds count_b values with mean mean_b and m2 m2_b into the running mean
+// and m2 of count values (Chan et al.'s pairwise update, which does not
+// cancel like a difference of sums of squares). The caller adds count_b to
+// its count afterwards.
+inline void MergeMoments(int64_t count, double& mean, double& m2,
+                         int64_t count_b, double mean_b, double m2_b) {
+    if (count_b == 0) {
+        return;
+    }
+    const double total = static_cast<double>(count + count_b);
+    const double delta = mean_b - mean;
+    mean += delta * (static_cast<double>(count_b) / total);
+    m2 += m2_b + delta * delta * (static_cast<double>(count) * static_cast<double>(count_b) / total);
+}
+
+// Population variance (ddof 0) of count values from their m2.
+inline double Variance(double m2, int64_t count) {
+    return std::max(0.0, m2 / static_cast<double>(count));
+}
+
+// Widens an int32/int64 column into out[0, array.length()); null slots are
+// left unspecified and should be masked through InvalidateNulls.
+arrow::Status GatherIntegers(const arrow::Array& array, int64_t* out);
+
+/**
+ * Per-group running sums and row counts for a fixed number of groups.
+ */
+struct GroupSums {
+    std::vector<double> sum;
+    std::vector<int64_t> count;
+
+    explicit GroupSums(size_t num_groups = 0) : sum(num_groups, 0.0), count(num_groups, 0) {}
+};
+
+}  // namespace olap
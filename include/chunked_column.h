@@ -0,0 +1,63 @@
+#pragma once
+
+#include <arrow/api.h>
+#include <arrow/compute/api.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Zero-copy view over one column of an arrow::Table.
+ * The column stays split into the chunks it was loaded with (one per
+ * Parquet row group or record batch); nothing is concatenated. Kernels
+ * run chunk by chunk through ForEachChunk, and arrow::compute functions
+ * take the whole column through datum(), which they also evaluate per
+ * chunk.
+ */
+namespace olap {
+
+class ChunkedColumn {
+public:
+    // A default-constructed column, or one made from a null array, is empty
+    // and of type null, so every accessor stays valid.
+    ChunkedColumn();
+    explicit ChunkedColumn(std::shared_ptr<arrow::ChunkedArray> data);
+
+    // View of the named column of table.
+    static arrow::Result<ChunkedColumn> Make(const arrow::Table& table, const std::string& name);
+
+    int64_t length() const { return offsets_.empty() ? 0 : offsets_.back(); }
+    int64_t null_count() const { return data_->null_count(); }
+    int num_chunks() const { return data_->num_chunks(); }
+    const arrow::Array& chunk(int i) const { return *data_->chunk(i); }
+    const std::shared_ptr<arrow::DataType>& type() const { return data_->type(); }
+    const std::shared_ptr<arrow::ChunkedArray>& chunked_array() const { return data_; }
+
+    // The column as an argument for arrow::compute functions.
+    arrow::Datum datum() const { return arrow::Datum(data_); }
+
+    // Calls fn(const arrow::Array& chunk, int64_t first_row) for every
+    // non-empty chunk, in order; first_row is the chunk's logical row id.
+    template <typename Fn>
+    arrow::Status ForEachChunk(Fn&& fn) const {
+        for (int i = 0; i < num_chunks(); ++i) {
+            if (offsets_[i + 1] > offsets_[i]) {
+                ARROW_RETURN_NOT_OK(fn(chunk(i), offsets_[i]));
+            }
+        }
+        return arrow::Status::OK();
+    }
+
+    // (chunk index, index within the chunk) of a logical row.
+    std::pair<int, int64_t> Locate(int64_t row) const;
+
+    arrow::Result<std::shared_ptr<arrow::Scalar>> GetScalar(int64_t row) const;
+
+private:
+    std::shared_ptr<arrow::ChunkedArray> data_;
+    std::vector<int64_t> offsets_;  // first row of every chunk, then length()
+};
+
+}  // namespace olap
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * Layout of the precomputed sales cube, shared by the cube builder and
+ * both analyzers (no Arrow or DuckDB dependency).
+ *
+ * The cube holds the additive measures of fact_sales (gross_sales, profit,
+ * quantity and a row count, records) summed over a few grouping sets of
+ * dimension levels: each hierarchy on its own down to its finest level,
+ * and a cross grouping set of the levels the analyses combine. Every cell
+ * names its grouping set in the grouping_set column; levels outside it are
+ * null, and so are the levels of a hierarchy whose dimension has no row
+ * for the fact (a rollup skips cells null in the levels it asks for, as
+ * a query joining those dimensions skips such facts). A rollup to any levels a grouping set covers re-sums that set's
+ * cells, which are far fewer than the fact rows (coarser levels of the
+ * same set roll up, finer ones drill down).
+ *
+ * The cube records a fingerprint of the files it was built from; once a
+ * fact or dimension file changes, the cube is stale and the analyzers fall
+ * back to the base tables.
+ */
+namespace olap {
+
+constexpr const char* kCubeFileName = "sales_cube.parquet";
+// Parquet key-value metadata entry holding the source fingerprint
+constexpr const char* kCubeFingerprintKey = "olap.cube.source";
+constexpr const char* kGroupingSetColumn = "grouping_set";
+// Row count of a cell, summed like the other measures
+constexpr const char* kRecordsColumn = "records";
+
+// A dimension hierarchy: the dimension table joined on key, and its levels
+// from coarsest to finest.
+struct CubeHierarchy {
+    std::string name;
+    std::string table;  // e.g. dim_time (file dim_time.parquet)
+    std::string key;
+    std::vector<std::string> levels;
+};
+
+const std::vector<CubeHierarchy>& CubeHierarchies();
+
+// Summed fact columns, without records.
+const std::vector<std::string>& CubeMeasures();
+
+// Materialized grouping sets, each a list of levels in hierarchy order.
+const std::vector<std::vector<std::string>>& CubeGroupingSets();
+
+// Value of the grouping_set column for a set: its levels joined by ','.
+std::string GroupingSetName(const std::vector<std::string>& levels);
+
+// The smallest grouping set containing every level, or null if none does.
+const std::vector<std::string>* FindGroupingSet(const std::vector<std::string>& levels);
+
+// Hierarchy a level belongs to, or null.
+const CubeHierarchy* FindHierarchy(const std::string& level);
+
+// Year window of OLAP_FACT_YEARS ("2024" or "2022-2024"), the one parser
+// behind both analyzers' partition filters.
+struct FactYears {
+    bool all = true;  // unset: every year
+    int first = 0;
+    int last = 0;
+};
+
+// Parses OLAP_FACT_YEARS; false with error set when it is not YEAR or
+// FIRST-LAST with FIRST <= LAST.
+bool FactYearsFromEnvironment(FactYears& years, std::string& error);
+
+// Sizes and modification times of fact_sales (file or partitioned
+// directory) and the dimension files under data_path, hashed, plus the
+// OLAP_FACT_YEARS window the facts are read with.
+std::string CubeSourceFingerprint(const std::string& data_path);
+
+}  // namespace olap
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <arrow/api.h>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * Native generator of the star schema written by generate_olap_data.py:
+ * the time, geography, product and customer dimensions and fact_sales,
+ * with the same columns, types and value distributions (uniform dimension
+ * keys, 1-10 units boosted 1.2-1.8x on weekends, list prices varied by
+ * 0.8-1.1x, costs and profit derived from them).
+ *
+ * Every random value is a pure function of (seed, stream, row), drawn from
+ * a counter-based generator, so fact rows can be produced in any order on
+ * any number of threads and the output is identical for every thread
+ * count. The fact table is generated one row group at a time, worker
+ * threads filling slices of it in parallel, and streamed to Parquet
+ * through parquet::arrow::FileWriter; memory stays bounded by a row group
+ * regardless of the number of records.
+ */
+namespace olap {
+
+struct GeneratorOptions {
+    int64_t sales_records = 1000000;
+    // Rows per fact row group, generated and written as one unit
+    int64_t row_group_rows = 1 << 20;
+    // Rows a worker generates per task
+    int64_t slice_rows = 64 * 1024;
+    // 0 means one per hardware core
+    int num_threads = 0;
+    uint64_t seed = 42;
+    // Write fact_sales/year=Y/month=M/part-0.parquet instead of
+    // fact_sales.parquet; every generated group writes its share to each
+    // partition file as a row group of its own, so nothing is buffered
+    // across groups (at the cost of smaller row groups)
+    bool partition_facts = false;
+
+    // Defaults overridden by OLAP_SALES_RECORDS, OLAP_ROW_GROUP_ROWS,
+    // OLAP_EXEC_THREADS, OLAP_SEED and OLAP_PARTITION_FACTS (1 partitions)
+    static GeneratorOptions FromEnvironment();
+};
+
+struct GeneratorStats {
+    int64_t time_rows = 0;
+    int64_t geography_rows = 0;
+    int64_t product_rows = 0;
+    int64_t customer_rows = 0;
+    int64_t fact_rows = 0;
+    int64_t fact_files = 0;
+    int64_t fact_row_groups = 0;
+};
+
+// Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as
+// 1, 2, 3"): 128 random bits per (counter, block), keyed by the seed and a
+// stream id, so each table and column family draws from its own stream.
+class CounterRng {
+public:
+    CounterRng(uint64_t seed, uint32_t stream);
+
+    std::array<uint32_t, 4> operator()(uint64_t counter, uint32_t block = 0) const;
+
+    // An integer in [0, n) from 32 random bits
+    static uint32_t Below(uint32_t bits, uint32_t n) {
+        return static_cast<uint32_t>((static_cast<uint64_t>(bits) * n) >> 32);
+    }
+    // A double in (low, high) from 32 random bits
+    static double Uniform(uint32_t bits, double low, double high) {
+        return low + (high - low) * ((bits + 0.5) * (1.0 / 4294967296.0));
+    }
+
+private:
+    std::array<uint32_t, 2> key_;
+    uint32_t stream_;
+};
+
+// The dimension tables, in the layout of generate_olap_data.py
+arrow::Result<std::shared_ptr<arrow::Table>> GenerateTimeDimension();
+arrow::Result<std::shared_ptr<arrow::Table>> GenerateGeographyDimension();
+arrow::Result<std::shared_ptr<arrow::Table>> GenerateProductDimension(uint64_t seed);
+arrow::Result<std::shared_ptr<arrow::Table>> GenerateCustomerDimension(uint64_t seed);
+
+// Writes the four dimension files and fact_sales (file or partitioned
+// directory; the other form is removed so the analyzers read the new one)
+// under data_path.
+arrow::Result<GeneratorStats> GenerateStarSchema(const std::string& data_path, const GeneratorOptions& options);
+
+}  // namespace olap
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "arrow_kernels.h"
+#include "hash_join.h"
+#include <arrow/api.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Surrogate-key index over a star-schema dimension table.
+ * Dimension keys are usually dense (0..N or 1..N), so the index maps
+ * key - min_key straight to an array slot and every fact-to-dimension
+ * lookup is a range check plus one array load. Sparse key sets fall back
+ * to a compact open-addressing table (linear probing, load factor <= 0.5).
+ */
+namespace olap {
+
+class DimensionIndex {
+public:
+    // Indexes the integer key column of a dimension table. Null keys are
+    // ignored; a duplicate key fails with a KeyError status.
+    static arrow::Result<std::shared_ptr<DimensionIndex>> Make(const arrow::ChunkedArray& keys);
+    static arrow::Result<std::shared_ptr<DimensionIndex>> Make(const arrow::Table& dimension,
+                                                               const std::string& key_column);
+
+    // Dimension row holding key, or kNoMatch.
+    int64_t RowOf(int64_t key) const {
+        int64_t slot = SlotOf(key);
+        return slot < 0 ? kNoMatch : slot_rows_[slot];
+    }
+
+    // Join probe with the same contract as JoinHashTable::Probe; each probe
+    // row matches at most one dimension row.
+    arrow::Status Probe(const arrow::Array& keys, int64_t base_row, JoinType join_type,
+                        std::vector<int64_t>& left_rows,
+                        std::vector<int64_t>& right_rows) const;
+
+    bool dense() const { return dense_; }
+    int64_t num_keys() const { return num_keys_; }
+    int64_t min_key() const { return min_key_; }
+    int64_t max_key() const { return max_key_; }
+    std::string ToString() const;
+
+private:
+    // Key sets whose range is at most this many times the key count (plus
+    // kDenseSlack) are stored directly addressed.
+    static constexpr int64_t kDenseFactor = 2;
+    static constexpr int64_t kDenseSlack = 1024;
+
+    DimensionIndex() = default;
+
+    // Array slot for key, or -1. Dense: key - min_key, computed modulo 2^64
+    // so keys far outside the range wrap to a slot past the end. Sparse:
+    // probe position.
+    int64_t SlotOf(int64_t key) const {
+        if (dense_) {
+            const uint64_t slot = static_cast<uint64_t>(key) - static_cast<uint64_t>(min_key_);
+            return slot < slot_rows_.size() ? static_cast<int64_t>(slot) : -1;
+        }
+        return SparseSlotOf(key);
+    }
+
+    int64_t SparseSlotOf(int64_t key) const;
+
+    bool dense_ = true;
+    int64_t num_keys_ = 0;
+    int64_t min_key_ = 0;
+    int64_t max_key_ = -1;
+    int shift_ = 63;
+    std::vector<int64_t> slot_rows_;  // kNoMatch marks an empty slot
+    std::vector<int64_t> slot_keys_;  // sparse mode only
+};
+
+}  // namespace olap
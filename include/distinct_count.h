@@ -0,0 +1,132 @@
+#pragma once
+
+#include <arrow/api.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Distinct counting for integer keys.
+ *
+ * RoaringBitmap is an exact set of 32-bit values split by their upper 16
+ * bits into containers: a sorted array of the lower 16 bits while the
+ * container holds at most kMaxArraySize values, a 65536-bit bitmap once it
+ * is denser. Dense surrogate keys (customer_key and the like) therefore
+ * cost about two bytes each, or one bit each once they fill a bitmap,
+ * instead of a tree node per key.
+ *
+ * HyperLogLog is the fixed-size approximate sketch: 2^precision one-byte
+ * registers fed by a 64-bit hash, as in HyperLogLog++. The estimate uses
+ * Ertl's improved estimator ("New cardinality estimation algorithms for
+ * HyperLogLog sketches", 2017), which is unbiased over the whole range
+ * without HLL++'s empirical bias tables; the relative standard error is
+ * about 1.04/sqrt(2^precision), 0.8% at the default precision 14.
+ *
+ * DistinctCounter combines them: it counts exactly in a roaring bitmap,
+ * and in approximate mode switches to a HyperLogLog once the bitmap
+ * outgrows the sketch (or a key falls outside [0, 2^32)), which plays the
+ * role of HLL++'s sparse representation. All three merge, so per-thread
+ * or per-batch counters combine into the count of the union.
+ */
+namespace olap {
+
+class RoaringBitmap {
+public:
+    static constexpr int kMaxArraySize = 4096;
+
+    void Add(uint32_t value);
+    // Union with other.
+    void Merge(const RoaringBitmap& other);
+    bool Contains(uint32_t value) const;
+
+    int64_t cardinality() const { return cardinality_; }
+    // Approximate heap footprint of the containers.
+    int64_t memory_bytes() const;
+
+    // Calls fn(uint32_t) for every value in ascending order.
+    template <typename Fn>
+    void ForEach(Fn&& fn) const {
+        for (size_t c = 0; c < containers_.size(); ++c) {
+            const uint32_t high = static_cast<uint32_t>(keys_[c]) << 16;
+            const Container& container = containers_[c];
+            if (container.bits.empty()) {
+                for (uint16_t low : container.array) {
+                    fn(high | low);
+                }
+                continue;
+            }
+            for (size_t word = 0; word < container.bits.size(); ++word) {
+                for (uint64_t bits = container.bits[word]; bits != 0; bits &= bits - 1) {
+                    fn(high | static_cast<uint32_t>(word * 64 + __builtin_ctzll(bits)));
+                }
+            }
+        }
+    }
+
+private:
+    struct Container {
+        std::vector<uint16_t> array;   // sorted, while bits is empty
+        std::vector<uint64_t> bits;    // 1024 words once converted
+        int32_t cardinality = 0;
+    };
+
+    Container& FindOrAddContainer(uint16_t key);
+    // Adds low to container; returns whether it was new.
+    static bool AddToContainer(Container& container, uint16_t low);
+
+    std::vector<uint16_t> keys_;        // sorted upper 16 bits, one per container
+    std::vector<Container> containers_;
+    size_t last_ = 0;                   // container of the previous Add
+    int64_t cardinality_ = 0;
+};
+
+class HyperLogLog {
+public:
+    static constexpr int kDefaultPrecision = 14;
+
+    explicit HyperLogLog(int precision = kDefaultPrecision);
+
+    void AddHash(uint64_t hash);
+    void Add(int64_t value) { AddHash(Hash(value)); }
+    // Sketch of the union; precisions must match.
+    void Merge(const HyperLogLog& other);
+    double Estimate() const;
+
+    int precision() const { return precision_; }
+    int64_t memory_bytes() const { return static_cast<int64_t>(registers_.size()); }
+
+    static uint64_t Hash(int64_t value);
+
+private:
+    int precision_;
+    std::vector<uint8_t> registers_;
+};
+
+class DistinctCounter {
+public:
+    // Exact counters fail on keys outside [0, 2^32); approximate ones take
+    // any key and switch to a HyperLogLog past the sketch's size.
+    explicit DistinctCounter(bool approximate = false, int precision = HyperLogLog::kDefaultPrecision);
+
+    arrow::Status Add(int64_t value);
+    // Adds the valid values of an int32 or int64 array.
+    arrow::Status Add(const arrow::Array& values);
+    arrow::Status Merge(const DistinctCounter& other);
+
+    // Exact while exact() holds, otherwise the sketch's estimate.
+    int64_t Count() const;
+    bool exact() const { return sketch_ == nullptr; }
+    bool approximate() const { return approximate_; }
+    int64_t memory_bytes() const;
+
+private:
+    // Moves the bitmap's values into a new HyperLogLog.
+    void SwitchToSketch();
+
+    bool approximate_;
+    int precision_;
+    RoaringBitmap bitmap_;
+    std::unique_ptr<HyperLogLog> sketch_;
+};
+
+}  // namespace olap
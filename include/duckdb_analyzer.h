@@ -1,10 +1,12 @@
 #pragma once
 
 #include <duckdb.hpp>
+#include <cstdint>
 #include <iostream>
 #include <vector>
 #include <string>
 #include <memory>
+#include <unordered_map>
 
 /**
  * OLAP Analyzer using DuckDB C++ for SQL-based analytics.
@@ -15,14 +17,33 @@ class DuckDBOLAPAnalyzer {
 private:
     std::unique_ptr<duckdb::DuckDB> db_;
     std::unique_ptr<duckdb::Connection> conn_;
+    
+    // Set when sales_cube.parquet matches the registered fact and dimension
+    // files; it is then registered as the sales_cube view
+    bool use_cube_ = true;
+    bool cube_fresh_ = false;
+    
+    // Prepared analysis queries by name, with the SQL each was prepared from
+    struct PreparedQuery {
+        std::string query;
+        std::unique_ptr<duckdb::PreparedStatement> statement;
+    };
+    std::unordered_map<std::string, PreparedQuery> statements_;
 
     // Helper methods
     void ConfigureDatabase();
     void PrintQueryResult(std::unique_ptr<duckdb::MaterializedQueryResult> result,
                          const std::string& title);
     std::vector<std::vector<std::string>> GetQueryData(const std::string& query);
+    
+    // FROM item `s` with one row per cube cell or fact row: the given
+    // levels, gross_sales, profit, quantity and records (rows summarized).
+    // Cells of the covering grouping set when the cube is fresh, otherwise
+    // fact_sales joined to the levels' dimensions, one record per row.
+    std::string RollupSource(const std::vector<std::string>& levels) const;
 
 public:
+    // Reads OLAP_USE_CUBE (0 ignores a fresh sales cube)
     DuckDBOLAPAnalyzer();
     ~DuckDBOLAPAnalyzer() = default;
 
@@ -38,8 +59,16 @@ public:
     // Utility methods
     void PrintDataInfo();
     bool RunAllAnalyses();
+    // COUNT(*) of the registered fact_sales view, or -1 on error
+    int64_t CountFactRows();
     
     // Query execution
     std::unique_ptr<duckdb::MaterializedQueryResult> ExecuteQuery(const std::string& query);
+    // Runs query as the prepared statement cached under name, binding
+    // parameters to $1, $2, ...; parsed and planned only the first time a
+    // name is seen or when its SQL changes (e.g. the cube becomes fresh)
+    std::unique_ptr<duckdb::MaterializedQueryResult> ExecutePrepared(const std::string& name,
+                                                                     const std::string& query,
+                                                                     duckdb::vector<duckdb::Value> parameters = {});
     bool HasError(std::unique_ptr<duckdb::MaterializedQueryResult>& result);
 };
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <arrow/api.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Whole-table (ungrouped) aggregates over several columns in one pass.
+ * Each record batch is walked in tiles of kTileRows rows. Within a tile
+ * every distinct input column is folded once into its sum, count, minimum,
+ * maximum and (for variances) mean and sum of squared deviations, whichever
+ * aggregates asked for it, so the
+ * values of all input columns are read from memory once and stay in L1
+ * while the tile is processed. Derived per-row values (the mean of a ratio of two columns)
+ * are folded on the fly instead of being materialized.
+ */
+namespace olap {
+
+enum class AggregateKind {
+    kSum,
+    kCount,       // non-null values of column
+    kMin,
+    kMax,
+    kMean,
+    kVariance,    // population variance (ddof 0)
+    kStddev,      // population standard deviation
+    kRatioMean    // mean of column / denominator over rows where both are valid
+};
+
+struct AggregateSpec {
+    std::string name;         // output column name
+    AggregateKind kind;
+    std::string column;
+    std::string denominator = "";  // kRatioMean only
+};
+
+class FusedAggregator {
+public:
+    // Rows per tile: four 8-byte columns of a tile fit in L1.
+    static constexpr int64_t kTileRows = 1024;
+
+    static arrow::Result<std::unique_ptr<FusedAggregator>> Make(const arrow::Schema& schema,
+                                                                std::vector<AggregateSpec> specs);
+
+    // Folds one batch holding (at least) every referenced column.
+    arrow::Status Consume(const arrow::RecordBatch& batch);
+
+    // One row with a column per spec, in spec order. Sums, minima and maxima
+    // of integer columns and counts are int64, everything else double; an
+    // aggregate that saw no value is null.
+    arrow::Result<std::shared_ptr<arrow::RecordBatch>> Finish() const;
+
+    // Result of the named aggregate as a double (NaN when it saw no value).
+    double Value(const std::string& name) const;
+
+private:
+    // Running totals of one input column, shared by all its aggregates
+    struct ColumnState {
+        std::string name;
+        bool integral = false;
+        bool min_max = false;      // some aggregate needs the extremes
+        bool moments = false;      // some aggregate needs the variance
+        double sum = 0;            // floating-point columns
+        int64_t integer_sum = 0;   // integer columns, exact
+        double mean = 0;           // with moments: running mean and sum of
+        double m2 = 0;             // squared deviations, merged per tile
+        int64_t count = 0;
+        double min = 0;
+        double max = 0;
+    };
+
+    struct RatioState {
+        int numerator;             // indices into columns_
+        int denominator;
+        double sum = 0;
+        int64_t count = 0;
+    };
+
+    // An output: its spec and the column or ratio state it reads
+    struct Output {
+        AggregateSpec spec;
+        int state;
+    };
+
+    FusedAggregator() = default;
+
+    int AddColumn(const arrow::Schema& schema, const std::string& name, bool min_max, bool moments);
+    double OutputValue(const Output& output) const;
+
+    std::vector<ColumnState> columns_;
+    std::vector<RatioState> ratios_;
+    std::vector<Output> outputs_;
+};
+
+}  // namespace olap
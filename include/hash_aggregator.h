@@ -0,0 +1,169 @@
+#pragma once
+
+#include <arrow/api.h>
+#include "distinct_count.h"
+#include "tdigest.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Multi-key, multi-measure hash aggregation over Arrow record batches.
+ * Every group column is reduced to a small integer code: integer keys with
+ * a known range map to value - min + 1, string keys and integer keys of
+ * unknown range are dictionary encoded, and code 0 stands for null (nulls
+ * form their own group). Arrow dictionary columns of strings are encoded
+ * per dictionary entry, once per distinct dictionary, so their rows map
+ * index -> code without hashing a string. The
+ * per-column codes are packed into one 64-bit composite key that resolves
+ * to a dense group id through a direct-address table (small integer key
+ * domains) or an open-addressing hash table. Keys that cannot be packed
+ * into 64 bits fall back to hashing the full code tuple; so does a key
+ * whose dictionary outgrows its bits while consuming, once the groups
+ * cannot be repacked with wider dictionary fields.
+ */
+namespace olap {
+
+class HashAggregator {
+public:
+    // Prepares an aggregator for the given columns of table. Integer key
+    // ranges come from one pass over the group columns of table; batches
+    // passed to Consume must stay within those ranges.
+    static arrow::Result<std::unique_ptr<HashAggregator>> Make(
+        const arrow::Table& table,
+        const std::vector<std::string>& group_columns,
+        const std::vector<std::string>& measure_columns);
+
+    // Prepares an aggregator for batches of the given schema whose key
+    // ranges are not known up front (e.g. a stream of record batches);
+    // integer keys are dictionary encoded like strings.
+    static arrow::Result<std::unique_ptr<HashAggregator>> Make(
+        const arrow::Schema& schema,
+        const std::vector<std::string>& group_columns,
+        const std::vector<std::string>& measure_columns);
+
+    // Also estimates the given quantiles of measure per group, with one
+    // t-digest of the given compression per group. Call before Consume.
+    arrow::Status AddQuantiles(const std::string& measure, std::vector<double> quantiles,
+                               double compression = TDigest::kDefaultCompression);
+
+    // Also counts the distinct values of an integer column per group, in a
+    // roaring bitmap per group, or (approximate) switching to a HyperLogLog
+    // once a group's bitmap outgrows it. Call before Consume.
+    arrow::Status AddDistinctCount(const std::string& column, bool approximate = false);
+
+    // Aggregates one batch holding (at least) the group and measure columns.
+    arrow::Status Consume(const arrow::RecordBatch& batch);
+
+    // Folds in the groups of other, an aggregator over the same group and
+    // measure columns (e.g. the partial aggregate of another thread); its
+    // groups that are new here are appended in other's order.
+    arrow::Status Merge(const HashAggregator& other);
+
+    // One row per group in first-seen order: the group columns, then
+    // <measure>_sum, _count, _min, _max, _mean, _variance and _stddev
+    // (population, i.e. ddof 0) for every measure, and
+    // <measure>_p<percent> (e.g. gross_sales_p95) for each added quantile,
+    // then an int64 <column>_distinct for each distinct count.
+    // Sum, min and max are int64 for integer measures and double otherwise.
+    // Group columns read as dictionary arrays stay dictionary<int32, utf8>,
+    // so later sorts and joins run on codes; strings decode when printed.
+    arrow::Result<std::shared_ptr<arrow::Table>> Finish() const;
+
+    int64_t num_groups() const { return num_groups_; }
+
+private:
+    struct KeyColumn {
+        std::string name;
+        std::shared_ptr<arrow::DataType> type;
+        bool is_string = false;
+        bool dictionary_array = false;  // arrow dictionary<int, string> column
+        bool ranged = false;       // integer key with a known value range
+        int64_t min = 0;           // ranged keys: code = value - min + 1
+        uint64_t max_code = 0;     // largest code that fits the column's bits
+        int shift = 0;             // bit offset inside the packed key
+        std::deque<std::string> dictionary;                  // string keys: code - 1 -> value
+        std::unordered_map<std::string_view, uint64_t> codes;  // views into dictionary
+        std::vector<int64_t> int_dictionary;                 // unranged integer keys
+        std::unordered_map<int64_t, uint64_t> int_codes;
+        std::shared_ptr<arrow::ArrayData> entries;   // dictionary_array: last dictionary seen
+        std::vector<uint64_t> entry_codes;           // and the code of each of its entries
+
+        bool dictionary_encoded() const { return !ranged; }
+    };
+
+    struct MeasureColumn {
+        std::string name;
+        bool integral = false;     // integer measures report int64 sum/min/max
+        std::vector<double> sum;             // floating-point measures
+        std::vector<int64_t> integer_sum;    // integer measures, exact
+        std::vector<int64_t> count;
+        std::vector<double> min;
+        std::vector<double> max;
+        std::vector<double> mean;            // Welford running mean and
+        std::vector<double> m2;              // sum of squared deviations
+        std::vector<double> quantiles;      // AddQuantiles
+        double compression = TDigest::kDefaultCompression;
+        std::vector<TDigest> digests;       // per group, when quantiles is set
+    };
+
+    struct DistinctColumn {
+        std::string name;
+        bool approximate = false;
+        std::vector<DistinctCounter> counters;  // per group
+    };
+
+    // Key domains of at most this many bits use a direct-address group table.
+    static constexpr int kDirectAddressBits = 16;
+    // Each dictionary-encoded key needs at least this many bits to be packed.
+    static constexpr int kMinDictionaryBits = 16;
+
+    HashAggregator() = default;
+
+    // Shared tail of both Make overloads: adds the measures and assigns
+    // the packed-key layout once every key column is known.
+    arrow::Status Init(const arrow::Schema& schema, const std::vector<std::string>& measure_columns);
+
+    arrow::Status EncodeColumn(const arrow::Array& array, KeyColumn& key, int64_t stride,
+                               uint64_t* out);
+    // Code of a dictionary-encoded key value, added on first sight. Codes
+    // may outgrow key.max_code; FitKeys repacks before they are packed.
+    static uint64_t StringCode(KeyColumn& key, std::string_view value);
+    static uint64_t IntegerCode(KeyColumn& key, int64_t value);
+    // Keeps every code of the dictionary-encoded keys packable: repacks
+    // the groups with wider dictionary fields when one key outgrew its
+    // bits, or switches to wide keys when no layout fits in 64 bits.
+    void FitKeys();
+    void IndexPackedGroups();
+    // The code in key of the value that code stands for in from.
+    static arrow::Result<uint64_t> TranslateCode(const KeyColumn& from, uint64_t code, KeyColumn& key);
+    uint64_t PackKey(const uint64_t* key_codes) const;
+    int32_t FindOrAddGroup(uint64_t packed_key, const uint64_t* key_codes);
+    int32_t FindOrAddWideGroup(const uint64_t* key_codes);
+    int32_t AddGroup(const uint64_t* key_codes);
+    void GrowHashTable();
+
+    std::vector<KeyColumn> keys_;
+    std::vector<MeasureColumn> measures_;
+    std::vector<DistinctColumn> distincts_;
+    bool packed_ = true;
+    bool direct_ = false;
+
+    int64_t num_groups_ = 0;
+    std::vector<uint64_t> group_codes_;  // num_groups_ x keys_.size() per-column codes
+
+    std::vector<int32_t> direct_groups_;  // packed key -> group id
+    std::vector<uint64_t> slot_keys_;     // open addressing over packed keys
+    std::vector<int32_t> slot_groups_;
+    std::unordered_map<std::string, int32_t> wide_groups_;
+
+    // Per-batch scratch
+    std::vector<uint64_t> key_codes_;
+    std::vector<int32_t> group_ids_;
+};
+
+}  // namespace olap
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <arrow/api.h>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Build/probe hash table for equi-joins on native integer keys.
+ * The build side is hashed once into bucket heads plus a per-row chain;
+ * the probe side is resolved a batch of keys at a time and produces
+ * matching (left row, right row) index pairs that the caller gathers
+ * with arrow::compute::Take.
+ */
+namespace olap {
+
+enum class JoinType {
+    kInner,
+    kLeftOuter
+};
+
+// Marks a left row without a build-side match in a left outer join.
+constexpr int64_t kNoMatch = -1;
+
+class JoinHashTable {
+public:
+    JoinHashTable() = default;
+
+    // Hashes every non-null key of the build side; row ids are global
+    // across chunks. Accepts int32 and int64 key columns.
+    arrow::Status Build(const arrow::ChunkedArray& keys);
+
+    // Probes one array of keys whose first row has global id base_row and
+    // appends the matched pairs. For kLeftOuter every left row appears at
+    // least once, paired with kNoMatch when nothing matched.
+    arrow::Status Probe(const arrow::Array& keys, int64_t base_row, JoinType join_type,
+                        std::vector<int64_t>& left_rows,
+                        std::vector<int64_t>& right_rows) const;
+
+    int64_t num_rows() const { return static_cast<int64_t>(keys_.size()); }
+
+    // True when no build key occurs twice, i.e. each probe row matches at
+    // most one build row (the usual dimension-table case).
+    bool unique_keys() const { return unique_keys_; }
+
+private:
+    // Rows per probe mini-batch: bucket ids are computed for the whole
+    // mini-batch first, then chains are walked.
+    static constexpr int64_t kProbeBatch = 1024;
+
+    uint64_t Bucket(int64_t key) const {
+        return (static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL) >> shift_;
+    }
+
+    std::vector<int64_t> heads_;
+    std::vector<int64_t> next_;
+    std::vector<int64_t> keys_;
+    int shift_ = 63;
+    bool unique_keys_ = true;
+};
+
+}  // namespace olap
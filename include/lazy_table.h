@@ -0,0 +1,64 @@
+#pragma once
+
+#include "parquet_source.h"
+#include "partitioned_dataset.h"
+#include <arrow/api.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * A Parquet-backed table whose columns load on first use.
+ * Opening reads the footer only. Each column is decoded the first time an
+ * analysis asks for it and then cached, so load time and resident memory
+ * follow the columns actually touched rather than the file's width. The
+ * cached ChunkedArray is handed out by pointer, so every projection of a
+ * column shares it (and indexes built over it can be recognized again).
+ * The table reads either one Parquet file or a partitioned dataset of many.
+ */
+namespace olap {
+
+class LazyTable {
+public:
+    static arrow::Result<std::shared_ptr<LazyTable>> Open(const std::string& path,
+                                                          const LoadOptions& options = {});
+    static arrow::Result<std::shared_ptr<LazyTable>> Open(std::shared_ptr<PartitionedDataset> dataset);
+
+    const std::shared_ptr<arrow::Schema>& schema() const {
+        return source_ ? source_->schema() : dataset_->schema();
+    }
+    int64_t num_rows() const { return source_ ? source_->num_rows() : dataset_->num_rows(); }
+    // Exactly one of the two is set.
+    const std::shared_ptr<ParquetSource>& source() const { return source_; }
+    const std::shared_ptr<PartitionedDataset>& dataset() const { return dataset_; }
+
+    // The named columns read from disk without caching them (streaming).
+    arrow::Result<std::shared_ptr<arrow::Table>> ReadColumns(const std::vector<std::string>& columns) const;
+    // The named columns streamed as batches of at most batch_rows rows.
+    arrow::Result<std::shared_ptr<arrow::RecordBatchReader>> ReadBatches(const std::vector<std::string>& columns,
+                                                                         int64_t batch_rows) const;
+
+    // The named column, read on first use.
+    arrow::Result<std::shared_ptr<arrow::ChunkedArray>> Column(const std::string& name);
+
+    // The named columns, in that order; columns not cached yet are read
+    // together in one pass over the file.
+    arrow::Result<std::shared_ptr<arrow::Table>> Select(const std::vector<std::string>& columns);
+
+    // The cached column, or null if it has not been read.
+    std::shared_ptr<arrow::ChunkedArray> LoadedColumn(const std::string& name) const;
+
+    int num_loaded_columns() const { return static_cast<int>(columns_.size()); }
+    int64_t loaded_bytes() const;
+
+private:
+    LazyTable() = default;
+
+    std::shared_ptr<ParquetSource> source_;
+    std::shared_ptr<PartitionedDataset> dataset_;
+    std::unordered_map<std::string, std::shared_ptr<arrow::ChunkedArray>> columns_;
+};
+
+}  // namespace olap
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <arrow/api.h>
+#include <arrow/compute/exec.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * Allocation accounting for Arrow buffers.
+ * Arrow allocates every buffer from a MemoryPool, arrow::default_memory_pool()
+ * unless a call is given another. The olap code passes memory_pool() instead
+ * (to builders, compute calls through exec_context(), Parquet readers,
+ * dataset scans and Acero plans): a TrackingMemoryPool over the backend
+ * allocator chosen at startup, system malloc, jemalloc or mimalloc. Its
+ * counters are read around a piece of work with an AllocationScope.
+ *
+ * Only Arrow buffers are counted; the std containers of the hand-written
+ * operators (hash tables, indexes, digests) are not.
+ */
+namespace olap {
+
+// Forwards to a backend pool and counts what passes through it. All
+// counters are atomic, so worker threads may allocate concurrently.
+class TrackingMemoryPool : public arrow::MemoryPool {
+public:
+    explicit TrackingMemoryPool(arrow::MemoryPool* backend) : backend_(backend) {}
+
+    using arrow::MemoryPool::Allocate;
+    using arrow::MemoryPool::Free;
+    using arrow::MemoryPool::Reallocate;
+    arrow::Status Allocate(int64_t size, int64_t alignment, uint8_t** out) override;
+    arrow::Status Reallocate(int64_t old_size, int64_t new_size, int64_t alignment, uint8_t** ptr) override;
+    void Free(uint8_t* buffer, int64_t size, int64_t alignment) override;
+    void ReleaseUnused() override { backend_.load()->ReleaseUnused(); }
+
+    // Bytes currently held, and the most held at once since the last ResetPeak
+    int64_t bytes_allocated() const override { return bytes_allocated_.load(); }
+    int64_t max_memory() const override { return max_memory_.load(); }
+    // Bytes requested and allocation calls (a growing Reallocate counts as
+    // one call of the size difference) since the pool was created
+    int64_t total_bytes_allocated() const override { return total_bytes_allocated_.load(); }
+    int64_t num_allocations() const override { return num_allocations_.load(); }
+    std::string backend_name() const override { return backend_.load()->backend_name(); }
+
+    // Lowers the peak to the bytes currently held.
+    void ResetPeak() { max_memory_.store(bytes_allocated_.load()); }
+
+    // Switches the backend; only while nothing is allocated, since each
+    // buffer must be freed by the allocator that made it.
+    arrow::Status SetBackend(arrow::MemoryPool* backend);
+
+private:
+    void Grow(int64_t bytes);
+
+    std::atomic<arrow::MemoryPool*> backend_;
+    std::atomic<int64_t> bytes_allocated_{0};
+    std::atomic<int64_t> max_memory_{0};
+    std::atomic<int64_t> total_bytes_allocated_{0};
+    std::atomic<int64_t> num_allocations_{0};
+};
+
+// Arrow's allocator named system, jemalloc or mimalloc (or default, Arrow's
+// own choice); NotImplemented when this Arrow build lacks it.
+arrow::Result<arrow::MemoryPool*> MemoryPoolBackend(const std::string& name);
+
+// The pool all olap code allocates Arrow buffers from, created on first use
+// over arrow::default_memory_pool().
+TrackingMemoryPool* memory_pool();
+
+// Moves memory_pool() onto the named backend; call before the first allocation.
+arrow::Status SelectMemoryPool(const std::string& name);
+
+// Compute function context allocating from memory_pool().
+arrow::compute::ExecContext* exec_context();
+
+struct AllocationStats {
+    int64_t bytes_allocated = 0;  // bytes requested
+    int64_t peak_bytes = 0;       // most bytes held at once, above those held at the start
+    int64_t allocations = 0;      // allocation calls
+    std::string backend;
+
+    // e.g. "48.2 MB in 1532 allocations, peak 12.0 MB (jemalloc)"
+    std::string ToString() const;
+};
+
+// Peak resident set size of the whole process so far, e.g. "412.3 MB",
+// which also covers memory outside Arrow buffers (std containers, mapped
+// files). From getrusage; "unknown" where it fails.
+std::string PeakResidentSize();
+
+// Allocation figures of memory_pool() from construction until stats().
+// Resets the pool's peak, so scopes must not nest.
+class AllocationScope {
+public:
+    AllocationScope();
+    AllocationStats stats() const;
+
+private:
+    int64_t start_bytes_held_;
+    int64_t start_total_bytes_;
+    int64_t start_allocations_;
+};
+
+}  // namespace olap
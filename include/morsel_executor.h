@@ -0,0 +1,55 @@
+#pragma once
+
+#include <arrow/api.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+/**
+ * Morsel-driven parallel scan.
+ * The input is cut into morsels of at most morsel_rows rows (zero-copy
+ * slices that never straddle a chunk boundary). Worker threads pull the
+ * next unclaimed morsel from a shared cursor until the input is exhausted,
+ * so a worker that finishes early simply takes more morsels and no thread
+ * idles behind a static partition. Each call of the morsel function names
+ * the worker running it; callers keep per-worker (thread-local) state such
+ * as partial aggregates indexed by worker and merge it once Run returns.
+ */
+namespace olap {
+
+constexpr int64_t kDefaultMorselRows = 16 * 1024;
+
+class MorselExecutor {
+public:
+    // fn(worker, morsel) with worker in [0, num_threads()). Calls for the
+    // same worker never overlap; calls for different workers run concurrently.
+    using MorselFn = std::function<arrow::Status(int worker, const arrow::RecordBatch& morsel)>;
+
+    // num_threads 0 means one per hardware core.
+    explicit MorselExecutor(int num_threads = 0, int64_t morsel_rows = kDefaultMorselRows);
+
+    int num_threads() const { return num_threads_; }
+    int64_t morsel_rows() const { return morsel_rows_; }
+
+    // Morsels of an in-memory table, claimed through an atomic cursor.
+    arrow::Status Run(const arrow::Table& table, const MorselFn& fn) const;
+
+    // Morsels of a batch stream: the worker that runs out of morsels reads
+    // the next batch under a lock and slices it, so decoding stays with the
+    // reader while the morsel work runs in parallel.
+    arrow::Status Run(arrow::RecordBatchReader& reader, const MorselFn& fn) const;
+
+    // Defaults overridden by OLAP_EXEC_THREADS and OLAP_MORSEL_ROWS.
+    static MorselExecutor FromEnvironment();
+
+private:
+    // Runs fn over next_morsel() on every worker until it yields null or a
+    // worker fails; next_morsel must be safe to call concurrently.
+    arrow::Status RunWorkers(const std::function<arrow::Result<std::shared_ptr<arrow::RecordBatch>>()>& next_morsel,
+                             const MorselFn& fn) const;
+
+    int num_threads_;
+    int64_t morsel_rows_;
+};
+
+}  // namespace olap
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <arrow/api.h>
+#include <arrow/io/caching.h>
+#include <arrow/io/interfaces.h>
+#include <parquet/arrow/reader.h>
+#include "row_group_filter.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * One Parquet file opened for column-projected reads.
+ * Opening reads only the footer; column data is decoded on demand, either
+ * into a table holding just the requested columns or as a stream of
+ * record batches of bounded size, so a scan keeps at most one batch of
+ * the projected columns in memory. Column names refer to top-level fields
+ * of a flat schema.
+ */
+namespace olap {
+
+/**
+ * Reader settings for Parquet input. Defaults decode in parallel on every
+ * core with pre-buffered, coalesced column chunk reads.
+ */
+struct LoadOptions {
+    // Decoding threads; 0 means one per hardware core. With several row
+    // groups each thread decodes its own run of row groups, otherwise the
+    // columns of the single row group decode in parallel.
+    int threads = 0;
+    // Issue the column chunk reads of a row group up front, coalesced
+    // according to cache_options, instead of one read per page.
+    bool pre_buffer = true;
+    // I/O coalescing: ranges closer than hole_size_limit are merged into
+    // requests of at most range_size_limit bytes.
+    arrow::io::CacheOptions cache_options = arrow::io::CacheOptions::Defaults();
+    // Row groups to read, in file order; empty reads every row group.
+    std::vector<int> row_groups;
+    // Map the file (arrow::io::MemoryMappedFile) instead of reading it with
+    // read syscalls; uncompressed pages are then decoded straight from the
+    // page cache, which concurrent processes share.
+    bool memory_map = false;
+    // Read string columns as dictionary<int32, utf8> arrays straight from
+    // the Parquet dictionary pages. Tables get one dictionary per column,
+    // shared by all chunks, so codes compare across row groups; streamed
+    // batches keep the dictionary of their row group.
+    bool read_dictionary = true;
+
+    int num_threads() const;
+
+    // Defaults overridden by OLAP_READ_THREADS, OLAP_PRE_BUFFER (0/1),
+    // OLAP_HOLE_SIZE_LIMIT and OLAP_RANGE_SIZE_LIMIT (bytes),
+    // OLAP_MEMORY_MAP (0/1) and OLAP_READ_DICTIONARY (0 reads plain strings).
+    static LoadOptions FromEnvironment();
+};
+
+// reader, or while tracing is enabled a wrapper recording every ReadNext
+// as a decode span named name (see trace.h)
+std::shared_ptr<arrow::RecordBatchReader> TraceBatches(std::shared_ptr<arrow::RecordBatchReader> reader,
+                                                       const char* name);
+
+class ParquetSource {
+public:
+    static arrow::Result<std::shared_ptr<ParquetSource>> Open(const std::string& path,
+                                                              const LoadOptions& options = {});
+
+    const std::string& path() const { return path_; }
+    const LoadOptions& options() const { return options_; }
+    const std::shared_ptr<arrow::Schema>& schema() const { return schema_; }
+    // Rows in the selected row groups; num_row_groups() counts the whole file.
+    int64_t num_rows() const;
+    int num_row_groups() const;
+
+    // The selected row groups in file order, and the rows in one of them.
+    std::vector<int> SelectedRowGroups() const;
+    int64_t row_group_num_rows(int row_group) const;
+
+    // The selected row groups that may hold a row matching every predicate,
+    // from footer statistics and the page index; no column data is read.
+    arrow::Result<std::vector<int>> PruneRowGroups(const std::vector<ColumnPredicate>& predicates,
+                                                   PruneStats* stats = nullptr) const;
+
+    // Reads the named columns (all columns when empty) of the selected row
+    // groups into one table whose chunks follow the row groups.
+    arrow::Result<std::shared_ptr<arrow::Table>> ReadTable(const std::vector<std::string>& columns = {});
+    // Same for the given row groups, e.g. the survivors of PruneRowGroups.
+    arrow::Result<std::shared_ptr<arrow::Table>> ReadRowGroups(const std::vector<int>& row_groups,
+                                                               const std::vector<std::string>& columns);
+
+    // Streams the named columns as record batches of at most batch_rows rows.
+    // The reader borrows this source and must not outlive it.
+    arrow::Result<std::shared_ptr<arrow::RecordBatchReader>> ReadBatches(
+        const std::vector<std::string>& columns, int64_t batch_rows);
+    arrow::Result<std::shared_ptr<arrow::RecordBatchReader>> ReadRowGroupBatches(
+        const std::vector<int>& row_groups, const std::vector<std::string>& columns, int64_t batch_rows);
+
+    // Calls fn(const arrow::RecordBatch&) on every batch of ReadBatches.
+    template <typename Fn>
+    arrow::Status ScanBatches(const std::vector<std::string>& columns, int64_t batch_rows, Fn&& fn) {
+        return ScanRowGroups(SelectedRowGroups(), columns, batch_rows, std::forward<Fn>(fn));
+    }
+
+    // Calls fn(const arrow::RecordBatch&) on every batch of ReadRowGroupBatches.
+    template <typename Fn>
+    arrow::Status ScanRowGroups(const std::vector<int>& row_groups, const std::vector<std::string>& columns,
+                                int64_t batch_rows, Fn&& fn) {
+        ARROW_ASSIGN_OR_RAISE(auto reader, ReadRowGroupBatches(row_groups, columns, batch_rows));
+        std::shared_ptr<arrow::RecordBatch> batch;
+        while (true) {
+            ARROW_RETURN_NOT_OK(reader->ReadNext(&batch));
+            if (!batch) {
+                return arrow::Status::OK();
+            }
+            ARROW_RETURN_NOT_OK(fn(*batch));
+        }
+    }
+
+private:
+    ParquetSource() = default;
+
+    arrow::Result<std::vector<int>> ColumnIndices(const std::vector<std::string>& columns) const;
+    arrow::Result<std::shared_ptr<arrow::Table>> UnifyDictionaries(const std::shared_ptr<arrow::Table>& table) const;
+
+    std::string path_;
+    LoadOptions options_;
+    std::shared_ptr<arrow::io::RandomAccessFile> file_;  // shared by the decoding threads
+    std::unique_ptr<parquet::arrow::FileReader> reader_;
+    std::shared_ptr<arrow::Schema> schema_;
+};
+
+}  // namespace olap
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "parquet_source.h"
+#include <arrow/api.h>
+#include <arrow/compute/expression.h>
+#include <arrow/dataset/api.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * A fact table stored as many Parquet files under one directory, e.g.
+ * fact_sales/year=2024/month=3/part-0.parquet, read through
+ * arrow::dataset::FileSystemDataset. Directory names of the form key=value
+ * (hive partitioning) become int32 or string partition columns, appended
+ * to the file schema. A filter on partition columns discards whole
+ * directories from their paths alone, before any file is opened; the other
+ * conjuncts are checked against each file's row-group statistics and then
+ * row by row. Scans read several files concurrently on Arrow's thread pool.
+ *
+ * The dataset filter (SetFilter) restricts every read, so a time window
+ * such as OLAP_FACT_YEARS applies to all analyses at once.
+ */
+namespace olap {
+
+class PartitionedDataset {
+public:
+    // Discovers every Parquet file below directory, skipping names that
+    // start with '.' or '_'. pre_buffer, cache_options and memory_map of
+    // options apply to each file.
+    static arrow::Result<std::shared_ptr<PartitionedDataset>> Open(const std::string& directory,
+                                                                   const LoadOptions& options = {});
+
+    // `year >= first and year <= last` from OLAP_FACT_YEARS ("2024" or
+    // "2022-2024"); literal(true) when it is unset.
+    static arrow::Result<arrow::compute::Expression> FilterFromEnvironment();
+
+    const std::string& directory() const { return directory_; }
+    const std::shared_ptr<arrow::Schema>& schema() const { return schema_; }
+
+    // Restricts every later read to the rows matching filter and counts them.
+    arrow::Status SetFilter(arrow::compute::Expression filter);
+    const arrow::compute::Expression& filter() const { return filter_; }
+
+    // Rows matching the dataset filter.
+    int64_t num_rows() const { return num_rows_; }
+    // Every discovered file, and those whose partition values pass the filter.
+    int num_files() const { return num_files_; }
+    int num_selected_files() const { return num_selected_files_; }
+
+    // Files whose partition values may match both the dataset filter and
+    // predicate; predicates on non-partition columns never exclude a file.
+    arrow::Result<int> CountFiles(const arrow::compute::Expression& predicate) const;
+
+    // Row groups of those files, and those whose statistics may match the
+    // dataset filter and predicate (the ones a scan decodes).
+    struct RowGroupCounts {
+        int row_groups = 0;
+        int matching = 0;
+    };
+    arrow::Result<RowGroupCounts> CountRowGroups(const arrow::compute::Expression& predicate) const;
+
+    // The named columns (all when empty) of the rows matching the dataset
+    // filter and predicate, in file order.
+    arrow::Result<std::shared_ptr<arrow::Table>> ReadTable(
+        const std::vector<std::string>& columns,
+        const arrow::compute::Expression& predicate = arrow::compute::literal(true)) const;
+
+    // Same, streamed as record batches of at most batch_rows rows.
+    arrow::Result<std::shared_ptr<arrow::RecordBatchReader>> ReadBatches(
+        const std::vector<std::string>& columns, int64_t batch_rows,
+        const arrow::compute::Expression& predicate = arrow::compute::literal(true)) const;
+
+private:
+    PartitionedDataset() = default;
+
+    arrow::Result<std::shared_ptr<arrow::dataset::Scanner>> MakeScanner(
+        const std::vector<std::string>& columns, int64_t batch_rows,
+        const arrow::compute::Expression& predicate) const;
+
+    std::string directory_;
+    LoadOptions options_;
+    std::shared_ptr<arrow::dataset::Dataset> dataset_;
+    std::shared_ptr<arrow::Schema> schema_;
+    arrow::compute::Expression filter_ = arrow::compute::literal(true);
+    int64_t num_rows_ = 0;
+    int num_files_ = 0;
+    int num_selected_files_ = 0;
+};
+
+}  // namespace olap
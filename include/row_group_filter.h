@@ -0,0 +1,54 @@
+#pragma once
+
+#include <arrow/api.h>
+#include <arrow/compute/expression.h>
+#include <parquet/file_reader.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Predicate pushdown for Parquet scans.
+ * A conjunction of column-vs-constant comparisons is checked against the
+ * min/max statistics of every column chunk in the footer, and, where the
+ * file has a page index, against the min/max of every page, before any
+ * column data is read. Row groups that cannot hold a matching row are
+ * skipped; the rows of the remaining groups still need the exact filter,
+ * which ToExpression() provides. Columns are top-level numeric (int32,
+ * int64, float, double) columns of a flat schema.
+ */
+namespace olap {
+
+enum class CompareOp { kEqual, kLess, kLessEqual, kGreater, kGreaterEqual };
+
+// column <op> value
+struct ColumnPredicate {
+    std::string column;
+    CompareOp op;
+    double value;
+
+    // False when no value in [min, max] satisfies the predicate.
+    bool MayMatch(double min, double max) const;
+
+    // The predicate as an expression, for filtering rows.
+    arrow::compute::Expression ToExpression() const;
+};
+
+struct PruneStats {
+    int row_groups = 0;              // row groups examined
+    int skipped_by_statistics = 0;   // excluded by column chunk min/max
+    int skipped_by_page_index = 0;   // excluded by the min/max of every page
+    int files = 0;                   // partitioned datasets: files examined
+    int skipped_by_partition = 0;    // excluded by their partition directory
+
+    int skipped() const { return skipped_by_statistics + skipped_by_page_index; }
+};
+
+// The row groups among candidates, in order, that may hold a row matching
+// every predicate. Columns without usable statistics never exclude a group.
+arrow::Result<std::vector<int>> PruneRowGroups(parquet::ParquetFileReader& reader,
+                                               const std::vector<int>& candidates,
+                                               const std::vector<ColumnPredicate>& predicates,
+                                               PruneStats* stats = nullptr);
+
+}  // namespace olap
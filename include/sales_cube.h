@@ -0,0 +1,56 @@
+#pragma once
+
+#include "cube_layout.h"
+#include "parquet_source.h"
+#include <arrow/api.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * The sales cube of cube_layout.h as an Arrow table, stored as a Parquet
+ * file next to the data it summarizes. Build streams fact_sales once,
+ * left-joins every batch to the level columns of each hierarchy through
+ * the dimension key indexes, and feeds one HashAggregator per grouping
+ * set. The cube is then a few thousand rows (grouping_set, every level
+ * column, gross_sales, profit, quantity, records) with the source
+ * fingerprint in its schema metadata; Rollup answers queries from it
+ * without touching the fact table.
+ */
+namespace olap {
+
+class SalesCube {
+public:
+    // Aggregates fact_sales under data_path (fact_sales.parquet, or a
+    // partitioned fact_sales directory read with the OLAP_FACT_YEARS
+    // filter) over CubeGroupingSets(). Facts without a matching dimension
+    // row keep null levels of that hierarchy, so every grouping set counts
+    // every fact; Rollup drops them only for the levels asked for.
+    static arrow::Result<std::shared_ptr<SalesCube>> Build(const std::string& data_path,
+                                                           const LoadOptions& options = {});
+
+    static arrow::Result<std::shared_ptr<SalesCube>> Read(const std::string& path);
+    arrow::Status Write(const std::string& path) const;
+
+    const std::shared_ptr<arrow::Table>& table() const { return table_; }
+    // CubeSourceFingerprint of the data the cube was built from
+    const std::string& fingerprint() const { return fingerprint_; }
+    int64_t num_cells() const { return table_->num_rows(); }
+
+    // One row per combination of levels: the level columns, then
+    // <measure>_sum for every measure and records_sum (the fact row count),
+    // re-summed from the cells of the smallest grouping set covering the
+    // levels that have all of those levels, as an inner join of fact_sales
+    // with just their dimensions counts. Invalid when no grouping set
+    // covers the levels.
+    arrow::Result<std::shared_ptr<arrow::Table>> Rollup(const std::vector<std::string>& levels) const;
+
+private:
+    SalesCube() = default;
+
+    std::shared_ptr<arrow::Table> table_;
+    std::string fingerprint_;
+};
+
+}  // namespace olap
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <arrow/api.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Mergeable streaming quantile sketch (merging t-digest, k1 scale).
+ * Values are buffered and periodically merged into a sorted list of
+ * centroids (mean, weight). The scale function keeps centroids small near
+ * both tails and large around the median, so p95/p99 stay accurate while
+ * the digest holds at most about compression/2 centroids no matter how
+ * many values it has seen. Digests built per batch or per thread combine
+ * with Merge; the result does not depend on how the input was split
+ * beyond the sketch's own error.
+ *
+ * Accuracy: a centroid at quantile q covers at most
+ * 2*pi*sqrt(q*(1-q))/compression of the ranks, so the rank error of
+ * Quantile(q) is bounded by MaxRankError(q), half of that: about 1.6% at
+ * the median and 0.3% at p99 for compression 100, and usually far less
+ * in practice thanks to interpolation between centroids.
+ *
+ * Not thread-safe: Quantile merges pending values in place.
+ */
+namespace olap {
+
+class TDigest {
+public:
+    static constexpr double kDefaultCompression = 100;
+
+    explicit TDigest(double compression = kDefaultCompression);
+
+    // NaN is ignored.
+    void Add(double value);
+    // Adds the valid values of a double, int32 or int64 array.
+    arrow::Status Add(const arrow::Array& values);
+    void Merge(const TDigest& other);
+
+    // Estimated q-quantile (0 <= q <= 1), interpolated between neighbouring
+    // values like arrow::compute::Quantile's default; NaN when empty. The
+    // extremes are exact.
+    double Quantile(double q) const;
+
+    // Upper bound on the rank error of Quantile(q), as a fraction of count().
+    double MaxRankError(double q) const;
+
+    double compression() const { return compression_; }
+    double count() const { return merged_weight_ + buffered_weight_; }
+    double min() const;
+    double max() const;
+    size_t num_centroids() const;
+
+private:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+    // Merges the buffered values and centroids into centroids_.
+    void Compress() const;
+
+    double compression_;
+    size_t buffer_limit_;
+    mutable std::vector<Centroid> centroids_;   // sorted by mean
+    mutable std::vector<double> buffer_;        // unit-weight values, unsorted
+    mutable std::vector<Centroid> incoming_;    // centroids of merged digests, unsorted
+    mutable std::vector<Centroid> scratch_;
+    mutable std::vector<uint64_t> keys_;        // radix sort of buffer_
+    mutable std::vector<uint64_t> key_scratch_;
+    mutable double merged_weight_ = 0;
+    mutable double buffered_weight_ = 0;
+    mutable double min_;
+    mutable double max_;
+};
+
+// Column-name form of a quantile: 0.95 -> "p95", 0.999 -> "p99.9".
+std::string PercentileName(double q);
+
+}  // namespace olap
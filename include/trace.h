@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+
+/**
+ * Lightweight span tracing of the analyzers' stages.
+ *
+ * A TraceSpan records the wall time of its scope under a stage (load,
+ * decode, join, aggregate, format, ...) on the calling thread. Tracing is
+ * off unless OLAP_TRACE names an output file; a disabled span costs one
+ * relaxed atomic load and records nothing. Spans are appended to a
+ * per-thread buffer without locking, so worker threads trace their morsels
+ * as cheaply as the main thread.
+ *
+ * FinishTrace writes the spans as Chrome trace-event JSON (open it in
+ * chrome://tracing or https://ui.perfetto.dev) and prints a per-stage
+ * summary: span count, inclusive and self time (time not spent in nested
+ * spans of the same thread) and the longest span.
+ */
+namespace olap {
+
+// Stages; spans take the pointer, so pass these (or other literals)
+constexpr const char* kStageLoad = "load";
+constexpr const char* kStageDecode = "decode";
+constexpr const char* kStageJoin = "join";
+// Row filtering by predicates, before the rows are aggregated
+constexpr const char* kStageFilter = "filter";
+constexpr const char* kStageAggregate = "aggregate";
+constexpr const char* kStageFormat = "format";
+// A query or execution plan run as a whole by an engine (DuckDB, Acero)
+constexpr const char* kStageQuery = "query";
+// One analysis, enclosing the stages above
+constexpr const char* kStageAnalysis = "analysis";
+
+namespace detail {
+extern std::atomic<bool> tracing_enabled;
+}  // namespace detail
+
+inline bool TracingEnabled() { return detail::tracing_enabled.load(std::memory_order_relaxed); }
+
+// Turns tracing on or off (initially on iff OLAP_TRACE is set)
+void SetTracingEnabled(bool enabled);
+
+class TraceSpan {
+public:
+    // name must outlive the trace (a literal)
+    TraceSpan(const char* stage, const char* name) {
+        if (TracingEnabled()) {
+            Begin(stage, name);
+        }
+    }
+    ~TraceSpan() {
+        if (start_ns_ >= 0) {
+            End();
+        }
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    // Whether the span records; guard the construction of details with it
+    bool active() const { return start_ns_ >= 0; }
+    // Free-form detail (e.g. column names), shown in the trace viewer
+    void SetDetail(std::string detail) { detail_ = std::move(detail); }
+
+private:
+    void Begin(const char* stage, const char* name);
+    void End();
+
+    const char* stage_ = nullptr;
+    const char* name_ = nullptr;
+    int64_t start_ns_ = -1;
+    std::string detail_;
+};
+
+// Chrome trace-event JSON of every span recorded so far. No span may be
+// open on another thread while it runs.
+std::string ChromeTraceJson();
+
+// Per-stage summary table of every span recorded so far.
+void PrintTraceSummary(std::ostream& out);
+
+// Drops every recorded span.
+void ClearTrace();
+
+// When tracing, writes ChromeTraceJson() to $OLAP_TRACE and prints the
+// summary to out; otherwise does nothing. Returns false if the file could
+// not be written.
+bool FinishTrace(std::ostream& out);
+
+}  // namespace olap
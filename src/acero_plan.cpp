@@ -0,0 +1,46 @@
+#include "acero_plan.h"
+#include "memory_pool.h"
+#include "trace.h"
+#include <utility>
+
+namespace olap {
+
+namespace acero = arrow::acero;
+
+acero::Declaration TableSource(std::shared_ptr<arrow::Table> table, int64_t batch_rows) {
+    return acero::Declaration("table_source", acero::TableSourceNodeOptions(std::move(table), batch_rows));
+}
+
+acero::Declaration ReaderSource(std::shared_ptr<arrow::RecordBatchReader> reader) {
+    return acero::Declaration("record_batch_reader_source",
+                              acero::RecordBatchReaderSourceNodeOptions(std::move(reader)));
+}
+
+acero::Declaration JoinDimension(acero::Declaration input, std::shared_ptr<arrow::Table> dimension,
+                                 const std::string& key) {
+    acero::HashJoinNodeOptions options(acero::JoinType::INNER, {arrow::FieldRef(key)}, {arrow::FieldRef(key)},
+                                       arrow::compute::literal(true), /*output_suffix_for_left=*/"",
+                                       /*output_suffix_for_right=*/"_dim");
+    return acero::Declaration("hashjoin", {std::move(input), TableSource(std::move(dimension))},
+                              std::move(options));
+}
+
+acero::Declaration Aggregate(acero::Declaration input, std::vector<arrow::compute::Aggregate> aggregates,
+                             std::vector<arrow::FieldRef> keys) {
+    return acero::Declaration::Sequence(
+        {std::move(input),
+         {"aggregate", acero::AggregateNodeOptions(std::move(aggregates), std::move(keys))}});
+}
+
+acero::Declaration OrderBy(acero::Declaration input, std::vector<arrow::compute::SortKey> sort_keys) {
+    return acero::Declaration::Sequence(
+        {std::move(input),
+         {"order_by", acero::OrderByNodeOptions(arrow::compute::Ordering(std::move(sort_keys)))}});
+}
+
+arrow::Result<std::shared_ptr<arrow::Table>> RunPlan(const acero::Declaration& plan) {
+    TraceSpan span(kStageQuery, "Acero RunPlan");
+    return acero::DeclarationToTable(plan, /*use_threads=*/true, memory_pool());
+}
+
+}  // namespace olap
@@ -1,75 +1,186 @@
 #include "arrow_analyzer.h"
+#include "arrow_kernels.h"
+#include "fused_aggregate.h"
+#include "hash_aggregator.h"
+#include "perf_counters.h"
+#include "trace.h"
 #include <arrow/compute/expression.h>
 #include <arrow/compute/exec.h>
 #include <arrow/compute/api.h>
 #include <arrow/array.h>
 #include <arrow/scalar.h>
-#include <arrow/array/concatenate.h>
 #include <iostream>
 #include <iomanip>
 #include <chrono>
+#include <cstdlib>
 #include <unordered_map>
 #include <algorithm>
-#include <set>
+#include <filesystem>
 
-arrow::Status ArrowOLAPAnalyzer::LoadParquetFile(const std::string& filename, 
-                                                std::shared_ptr<arrow::Table>& table) {
-    // Open the Parquet file
-    std::shared_ptr<arrow::io::ReadableFile> infile;
-    ARROW_ASSIGN_OR_RAISE(infile, arrow::io::ReadableFile::Open(filename));
-    
-    // Create Parquet reader
-    std::unique_ptr<parquet::arrow::FileReader> reader;
-    ARROW_RETURN_NOT_OK(parquet::arrow::OpenFile(infile, arrow::default_memory_pool(), &reader));
-    
-    // Read the entire table
-    ARROW_RETURN_NOT_OK(reader->ReadTable(&table));
+namespace {
+
+namespace cp = arrow::compute;
+
+// Dimension attributes are read as dictionaries; Acero sorts only plain
+// strings, so grouped attributes are decoded before an order_by.
+cp::Expression AsString(const std::string& name) {
+    return cp::call("cast", {cp::field_ref(name)}, cp::CastOptions::Safe(arrow::utf8()));
+}
+
+// $OLAP_DATA_PATH (default "olap_data"), and the path of a data file under it.
+std::string DataPath() {
+    return std::getenv("OLAP_DATA_PATH") ? std::getenv("OLAP_DATA_PATH") : "olap_data";
+}
+
+std::string DataFile(const std::string& name) {
+    return DataPath() + "/" + name;
+}
+
+}  // namespace
+
+ArrowOLAPAnalyzer::ArrowOLAPAnalyzer() : executor_(olap::MorselExecutor::FromEnvironment()) {
+    int64_t batch_rows = olap::kDefaultBatchRows;
+    if (std::getenv("OLAP_BATCH_ROWS")) {
+        batch_rows = std::max<int64_t>(1, std::atoll(std::getenv("OLAP_BATCH_ROWS")));
+    }
+    const char* streaming = std::getenv("OLAP_ARROW_STREAMING");
+    SetStreaming(streaming && std::string(streaming) == "1", batch_rows);
+    load_options_ = olap::LoadOptions::FromEnvironment();
+    if (std::getenv("OLAP_QUANTILE_COMPRESSION")) {
+        quantile_compression_ = std::max(10.0, std::atof(std::getenv("OLAP_QUANTILE_COMPRESSION")));
+    }
+    const char* approximate_distinct = std::getenv("OLAP_APPROX_DISTINCT");
+    approximate_distinct_ = approximate_distinct && std::string(approximate_distinct) == "1";
+    if (std::getenv("OLAP_ARROW_BACKEND")) {
+        const std::string backend = std::getenv("OLAP_ARROW_BACKEND");
+        run_native_ = backend != "acero";
+        run_acero_ = backend == "acero" || backend == "both";
+    }
+    const char* use_cube = std::getenv("OLAP_USE_CUBE");
+    use_cube_ = !use_cube || std::string(use_cube) != "0";
+}
+
+void ArrowOLAPAnalyzer::SetStreaming(bool enabled, int64_t batch_rows) {
+    streaming_ = enabled;
+    batch_rows_ = batch_rows;
+}
+
+arrow::Status ArrowOLAPAnalyzer::OpenParquetFile(const std::string& filename, 
+                                                std::shared_ptr<olap::LazyTable>& table,
+                                                const olap::LoadOptions& options) {
+    // Read the footer only; columns are decoded on first use
+    ARROW_ASSIGN_OR_RAISE(table, olap::LazyTable::Open(filename, options));
     
     return arrow::Status::OK();
 }
 
 arrow::Status ArrowOLAPAnalyzer::LoadAllTables() {
     std::cout << "Loading OLAP data using Apache Arrow C++...\n";
+    olap::TraceSpan trace(olap::kStageLoad, "LoadAllTables");
+    const char* memory_pool = std::getenv("OLAP_MEMORY_POOL");
+    if (memory_pool && *memory_pool) {
+        ARROW_RETURN_NOT_OK(olap::SelectMemoryPool(memory_pool));
+    }
+    std::cout << "Arrow memory pool: " << olap::memory_pool()->backend_name() << "\n";
+    
+    // A fact_sales directory is a partitioned dataset (e.g. year=/month=
+    // subdirectories of Parquet files), scanned file-parallel
+    const std::string fact_directory = DataFile("fact_sales");
+    if (std::filesystem::is_directory(fact_directory)) {
+        ARROW_ASSIGN_OR_RAISE(auto dataset, olap::PartitionedDataset::Open(fact_directory, load_options_));
+        ARROW_ASSIGN_OR_RAISE(auto filter, olap::PartitionedDataset::FilterFromEnvironment());
+        ARROW_RETURN_NOT_OK(dataset->SetFilter(filter));
+        ARROW_ASSIGN_OR_RAISE(sales_table_, olap::LazyTable::Open(dataset));
+        std::cout << "Partitioned fact_sales dataset: " << dataset->num_selected_files() << " of "
+                  << dataset->num_files() << " files selected (filter " << filter.ToString() << ")\n";
+    } else {
+        ARROW_RETURN_NOT_OK(OpenParquetFile(DataFile("fact_sales.parquet"), sales_table_, load_options_));
+    }
+    if (streaming_) {
+        std::cout << "Streaming " << (sales_table_->dataset() ? "fact_sales" : "fact_sales.parquet")
+                  << " in batches of " << batch_rows_ << " rows\n";
+    }
+    
+    // Dimension attributes are read dictionary-encoded, so joins gather
+    // int32 codes and grouping runs on them (unless OLAP_READ_DICTIONARY=0)
+    olap::LoadOptions dimension_options = load_options_;
+    dimension_options.row_groups.clear();
+    ARROW_RETURN_NOT_OK(OpenParquetFile(DataFile("dim_time.parquet"), time_table_, dimension_options));
+    ARROW_RETURN_NOT_OK(OpenParquetFile(DataFile("dim_geography.parquet"), geography_table_, dimension_options));
+    ARROW_RETURN_NOT_OK(OpenParquetFile(DataFile("dim_product.parquet"), product_table_, dimension_options));
+    ARROW_RETURN_NOT_OK(OpenParquetFile(DataFile("dim_customer.parquet"), customer_table_, dimension_options));
     
-    ARROW_RETURN_NOT_OK(LoadParquetFile("olap_data/fact_sales.parquet", sales_table_));
-    ARROW_RETURN_NOT_OK(LoadParquetFile("olap_data/dim_time.parquet", time_table_));
-    ARROW_RETURN_NOT_OK(LoadParquetFile("olap_data/dim_geography.parquet", geography_table_));
-    ARROW_RETURN_NOT_OK(LoadParquetFile("olap_data/dim_product.parquet", product_table_));
-    ARROW_RETURN_NOT_OK(LoadParquetFile("olap_data/dim_customer.parquet", customer_table_));
+    // Only the dimension key columns are read up front, to index them
+    ARROW_ASSIGN_OR_RAISE(auto date_keys, time_table_->Column("date_key"));
+    ARROW_ASSIGN_OR_RAISE(auto geography_keys, geography_table_->Column("geography_key"));
+    ARROW_ASSIGN_OR_RAISE(auto product_keys, product_table_->Column("product_key"));
+    ARROW_ASSIGN_OR_RAISE(auto customer_keys, customer_table_->Column("customer_key"));
+    ARROW_ASSIGN_OR_RAISE(time_index_, olap::DimensionIndex::Make(*date_keys));
+    ARROW_ASSIGN_OR_RAISE(geography_index_, olap::DimensionIndex::Make(*geography_keys));
+    ARROW_ASSIGN_OR_RAISE(product_index_, olap::DimensionIndex::Make(*product_keys));
+    ARROW_ASSIGN_OR_RAISE(customer_index_, olap::DimensionIndex::Make(*customer_keys));
     
-    std::cout << "All tables loaded successfully!\n";
+    // The cube serves rollups only while its source fingerprint matches
+    // the files (and year window) the fact table is read from now; one
+    // that cannot be read is passed over like a stale one
+    const std::string cube_path = DataFile(olap::kCubeFileName);
+    if (use_cube_ && std::filesystem::exists(cube_path)) {
+        auto cube = olap::SalesCube::Read(cube_path);
+        if (!cube.ok()) {
+            std::cout << olap::kCubeFileName << " cannot be read (" << cube.status().ToString()
+                      << "); rollups scan fact_sales\n";
+        } else if ((*cube)->fingerprint() == olap::CubeSourceFingerprint(DataPath())) {
+            cube_ = *cube;
+            std::cout << "Rollups served from " << olap::kCubeFileName << " (" << cube_->num_cells() << " cells)\n";
+        } else {
+            std::cout << olap::kCubeFileName << " is stale (rebuild with olap_cube); rollups scan fact_sales\n";
+        }
+    }
+    
+    std::cout << "All tables opened; columns load on first use\n";
     return arrow::Status::OK();
 }
 
 void ArrowOLAPAnalyzer::PrintDataInfo() {
     std::cout << "\nData loaded successfully!\n";
-    std::cout << "Sales records: " << sales_table_->num_rows() << "\n";
+    std::cout << "Sales records: " << sales_table_->num_rows() << (streaming_ ? " (streamed)" : "") << "\n";
     std::cout << "Time periods: " << time_table_->num_rows() << "\n";
     std::cout << "Geographies: " << geography_table_->num_rows() << "\n";
     std::cout << "Products: " << product_table_->num_rows() << "\n";
     std::cout << "Customers: " << customer_table_->num_rows() << "\n";
+    
+    std::cout << "\nDimension key indexes:\n";
+    std::cout << "  date_key: " << time_index_->ToString() << "\n";
+    std::cout << "  geography_key: " << geography_index_->ToString() << "\n";
+    std::cout << "  product_key: " << product_index_->ToString() << "\n";
+    std::cout << "  customer_key: " << customer_index_->ToString() << "\n";
 }
 
-arrow::Result<std::shared_ptr<arrow::Array>> ArrowOLAPAnalyzer::GetColumnAsArray(
-    std::shared_ptr<arrow::Table> table,
-    const std::string& column_name) {
-    
-    auto column = table->GetColumnByName(column_name);
-    if (!column) {
-        return arrow::Status::Invalid("Column '" + column_name + "' not found");
+void ArrowOLAPAnalyzer::PrintLoadedColumns() {
+    std::cout << "\nColumns loaded on demand:\n";
+    const std::vector<std::pair<std::string, std::shared_ptr<olap::LazyTable>>> tables = {
+        {"fact_sales", sales_table_}, {"dim_time", time_table_}, {"dim_geography", geography_table_},
+        {"dim_product", product_table_}, {"dim_customer", customer_table_}};
+    for (const auto& [name, table] : tables) {
+        std::cout << "  " << std::setw(14) << std::left << name << std::right
+                  << table->num_loaded_columns() << "/" << table->schema()->num_fields() << " columns, "
+                  << std::fixed << std::setprecision(1) << table->loaded_bytes() / 1048576.0 << " MiB\n";
     }
-    
-    // Combine all chunks into a single array
-    ARROW_ASSIGN_OR_RAISE(auto combined, arrow::Concatenate(column->chunks()));
-    return combined;
 }
 
 // Helper function to extract scalar value as string
 std::string ScalarToString(const arrow::Scalar& scalar) {
-    if (scalar.is_valid) {
-        return scalar.ToString();
+    if (!scalar.is_valid) {
+        return "NULL";
+    }
+    if (scalar.type->id() == arrow::Type::DICTIONARY) {
+        // Dictionary-encoded attributes are decoded only here, for display
+        auto decoded = static_cast<const arrow::DictionaryScalar&>(scalar).GetEncodedValue();
+        if (decoded.ok()) {
+            return ScalarToString(**decoded);
+        }
     }
-    return "NULL";
+    return scalar.ToString();
 }
 
 // Helper function to format numbers
@@ -79,36 +190,417 @@ std::string FormatNumber(double value, int decimals = 2) {
     return oss.str();
 }
 
+namespace {
+
+// Zero-copy projection of a table onto the named columns, in that order.
+arrow::Result<std::shared_ptr<arrow::Table>> ProjectColumns(
+    const std::shared_ptr<arrow::Table>& table,
+    const std::vector<std::string>& column_names) {
+
+    std::vector<int> indices;
+    for (const auto& name : column_names) {
+        int index = table->schema()->GetFieldIndex(name);
+        if (index < 0) {
+            return arrow::Status::Invalid("Column '" + name + "' not found");
+        }
+        indices.push_back(index);
+    }
+    return table->SelectColumns(indices);
+}
+
+// Take() indices for join output rows; olap::kNoMatch becomes a null index,
+// which Take turns into a null output value.
+arrow::Result<std::shared_ptr<arrow::Array>> MakeTakeIndices(const std::vector<int64_t>& rows) {
+    std::vector<uint8_t> valid(rows.size());
+    bool has_nulls = false;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        valid[i] = rows[i] != olap::kNoMatch;
+        has_nulls |= !valid[i];
+    }
+    
+    arrow::Int64Builder builder(olap::memory_pool());
+    ARROW_RETURN_NOT_OK(builder.AppendValues(rows.data(), static_cast<int64_t>(rows.size()),
+                                             has_nulls ? valid.data() : nullptr));
+    return builder.Finish();
+}
+
+// Per-row rank of a dictionary column's values: the entries are sorted once
+// and every code maps to its entry's rank, so rows sort as int32 codes.
+// Chunks with different dictionaries are unified first, so the ranks of
+// all chunks come from one sorted dictionary.
+arrow::Result<std::shared_ptr<arrow::ChunkedArray>> DictionaryRanks(
+    const std::shared_ptr<arrow::ChunkedArray>& column) {
+    ARROW_ASSIGN_OR_RAISE(auto unified, arrow::DictionaryUnifier::UnifyChunkedArray(column, olap::memory_pool()));
+    std::vector<std::shared_ptr<arrow::Array>> chunks;
+    if (unified->num_chunks() == 0) {
+        return std::make_shared<arrow::ChunkedArray>(std::move(chunks), arrow::int32());
+    }
+    const auto& dictionary = *static_cast<const arrow::DictionaryArray&>(*unified->chunk(0)).dictionary();
+    ARROW_ASSIGN_OR_RAISE(auto order, arrow::compute::SortIndices(dictionary, arrow::compute::SortOrder::Ascending, olap::exec_context()));
+    const auto& positions = static_cast<const arrow::UInt64Array&>(*order);
+    std::vector<int32_t> ranks(positions.length());
+    for (int64_t rank = 0; rank < positions.length(); ++rank) {
+        ranks[positions.Value(rank)] = static_cast<int32_t>(rank);
+    }
+    arrow::Int32Builder builder(olap::memory_pool());
+    ARROW_RETURN_NOT_OK(builder.AppendValues(ranks));
+    ARROW_ASSIGN_OR_RAISE(auto rank_array, builder.Finish());
+    for (const auto& chunk : unified->chunks()) {
+        const auto& encoded = static_cast<const arrow::DictionaryArray&>(*chunk);
+        ARROW_ASSIGN_OR_RAISE(auto row_ranks, arrow::compute::Take(rank_array, encoded.indices(),
+                                                                      arrow::compute::TakeOptions::Defaults(),
+                                                                      olap::exec_context()));
+        chunks.push_back(row_ranks.make_array());
+    }
+    return std::make_shared<arrow::ChunkedArray>(std::move(chunks), arrow::int32());
+}
+
+// Reorders the rows of table by the given sort keys.
+arrow::Result<std::shared_ptr<arrow::Table>> SortTable(const std::shared_ptr<arrow::Table>& table,
+                                                       std::vector<arrow::compute::SortKey> sort_keys) {
+    // Dictionary keys sort by the rank of their codes, in a scratch column
+    std::shared_ptr<arrow::Table> keyed = table;
+    for (auto& key : sort_keys) {
+        auto column = key.target.name() ? table->GetColumnByName(*key.target.name()) : nullptr;
+        if (column && column->type()->id() == arrow::Type::DICTIONARY) {
+            ARROW_ASSIGN_OR_RAISE(auto ranks, DictionaryRanks(column));
+            const std::string rank_name = "__rank_" + *key.target.name();
+            ARROW_ASSIGN_OR_RAISE(keyed, keyed->AddColumn(keyed->num_columns(),
+                                                          arrow::field(rank_name, arrow::int32()), ranks));
+            key.target = arrow::FieldRef(rank_name);
+        }
+    }
+    arrow::compute::SortOptions options(std::move(sort_keys));
+    ARROW_ASSIGN_OR_RAISE(auto indices, arrow::compute::SortIndices(arrow::Datum(keyed), options, olap::exec_context()));
+    ARROW_ASSIGN_OR_RAISE(auto sorted, arrow::compute::Take(table, indices, arrow::compute::TakeOptions::Defaults(),
+                                                            olap::exec_context()));
+    return sorted.table();
+}
+
+// Projects table onto the (column, output name) pairs, in that order.
+arrow::Result<std::shared_ptr<arrow::Table>> SelectAs(
+    const std::shared_ptr<arrow::Table>& table,
+    const std::vector<std::pair<std::string, std::string>>& columns) {
+
+    std::vector<std::string> names, output_names;
+    for (const auto& [name, output_name] : columns) {
+        names.push_back(name);
+        output_names.push_back(output_name);
+    }
+    ARROW_ASSIGN_OR_RAISE(auto projected, ProjectColumns(table, names));
+    return projected->RenameColumns(output_names);
+}
+
+}  // namespace
+
+arrow::Result<olap::ChunkedColumn> ArrowOLAPAnalyzer::GetFactColumn(const std::string& column_name) {
+    if (streaming_) {
+        return arrow::Status::Invalid("Fact column '", column_name,
+                                      "' is not materialized in streaming mode; scan it with ScanFacts");
+    }
+    // Zero-copy view over the cached column's chunks
+    ARROW_ASSIGN_OR_RAISE(auto column, sales_table_->Column(column_name));
+    return olap::ChunkedColumn(column);
+}
+
+arrow::Status ArrowOLAPAnalyzer::ScanFacts(const std::vector<std::string>& columns,
+                                           const std::function<arrow::Status(const arrow::RecordBatch&)>& fn) {
+    // Every scan callback folds the batch into an aggregate
+    auto aggregate = [&](const arrow::RecordBatch& batch) {
+        olap::TraceSpan span(olap::kStageAggregate, "scan batch");
+        return fn(batch);
+    };
+    if (streaming_) {
+        ARROW_ASSIGN_OR_RAISE(auto reader, sales_table_->ReadBatches(columns, batch_rows_));
+        std::shared_ptr<arrow::RecordBatch> batch;
+        while (true) {
+            ARROW_RETURN_NOT_OK(reader->ReadNext(&batch));
+            if (!batch) {
+                return arrow::Status::OK();
+            }
+            ARROW_RETURN_NOT_OK(aggregate(*batch));
+        }
+    }
+    ARROW_ASSIGN_OR_RAISE(auto projected, sales_table_->Select(columns));
+    return olap::ForEachBatch(*projected, batch_rows_, aggregate);
+}
+
+arrow::Status ArrowOLAPAnalyzer::ScanFactsWhere(const std::vector<std::string>& columns,
+                                                const std::vector<olap::ColumnPredicate>& predicates,
+                                                const std::function<arrow::Status(const arrow::RecordBatch&)>& fn,
+                                                olap::PruneStats* stats) {
+    std::vector<std::string> scan_columns = columns;
+    std::vector<arrow::compute::Expression> conditions;
+    for (const auto& predicate : predicates) {
+        if (std::find(scan_columns.begin(), scan_columns.end(), predicate.column) == scan_columns.end()) {
+            scan_columns.push_back(predicate.column);
+        }
+        conditions.push_back(predicate.ToExpression());
+    }
+    const auto condition = arrow::compute::and_(conditions);
+    auto aggregate = [&](const arrow::RecordBatch& batch) {
+        olap::TraceSpan span(olap::kStageAggregate, "scan batch");
+        return fn(batch);
+    };
+    
+    // A dataset prunes directories by partition values and files by their
+    // row-group statistics, and filters the rows it returns
+    if (auto dataset = sales_table_->dataset()) {
+        if (stats) {
+            stats->files = dataset->num_selected_files();
+            ARROW_ASSIGN_OR_RAISE(int files, dataset->CountFiles(condition));
+            stats->skipped_by_partition = stats->files - files;
+            ARROW_ASSIGN_OR_RAISE(auto row_groups, dataset->CountRowGroups(condition));
+            stats->row_groups = row_groups.row_groups;
+            stats->skipped_by_statistics = row_groups.row_groups - row_groups.matching;
+        }
+        ARROW_ASSIGN_OR_RAISE(auto reader, dataset->ReadBatches(scan_columns, batch_rows_, condition));
+        std::shared_ptr<arrow::RecordBatch> batch;
+        while (true) {
+            ARROW_RETURN_NOT_OK(reader->ReadNext(&batch));
+            if (!batch) {
+                return arrow::Status::OK();
+            }
+            ARROW_RETURN_NOT_OK(aggregate(*batch));
+        }
+    }
+    
+    auto source = sales_table_->source();
+    ARROW_ASSIGN_OR_RAISE(auto row_groups, source->PruneRowGroups(predicates, stats));
+    
+    // Exact filter over the rows of the surviving row groups
+    auto filter_batch = [&](const arrow::RecordBatch& batch) -> arrow::Status {
+        std::shared_ptr<arrow::RecordBatch> filtered;
+        {
+            olap::TraceSpan span(olap::kStageFilter, "filter batch");
+            ARROW_ASSIGN_OR_RAISE(auto bound, condition.Bind(*batch.schema()));
+            ARROW_ASSIGN_OR_RAISE(auto mask, arrow::compute::ExecuteScalarExpression(
+                                                 bound, arrow::compute::ExecBatch(batch), olap::exec_context()));
+            auto rows = arrow::RecordBatch::Make(batch.schema(), batch.num_rows(), batch.columns());
+            ARROW_ASSIGN_OR_RAISE(auto selected, arrow::compute::Filter(rows, mask, arrow::compute::FilterOptions::Defaults(),
+                                                                          olap::exec_context()));
+            filtered = selected.record_batch();
+        }
+        return aggregate(*filtered);
+    };
+    
+    if (streaming_) {
+        return source->ScanRowGroups(row_groups, scan_columns, batch_rows_, filter_batch);
+    }
+    
+    // Until every column is cached, decode only the surviving row groups
+    // (without caching them); a cached column spans every selected row
+    // group, so then the surviving groups' row ranges are scanned zero-copy
+    const bool cached = std::all_of(scan_columns.begin(), scan_columns.end(), [&](const std::string& name) {
+        return sales_table_->LoadedColumn(name) != nullptr;
+    });
+    if (!cached) {
+        ARROW_ASSIGN_OR_RAISE(auto surviving, source->ReadRowGroups(row_groups, scan_columns));
+        return olap::ForEachBatch(*surviving, batch_rows_, filter_batch);
+    }
+    ARROW_ASSIGN_OR_RAISE(auto projected, sales_table_->Select(scan_columns));
+    int64_t offset = 0;
+    size_t next = 0;
+    for (int row_group : source->SelectedRowGroups()) {
+        const int64_t rows = source->row_group_num_rows(row_group);
+        if (next < row_groups.size() && row_groups[next] == row_group) {
+            ARROW_RETURN_NOT_OK(olap::ForEachBatch(*projected->Slice(offset, rows), batch_rows_, filter_batch));
+            ++next;
+        }
+        offset += rows;
+    }
+    return arrow::Status::OK();
+}
+
+arrow::Result<std::shared_ptr<arrow::Table>> ArrowOLAPAnalyzer::AggregateFacts(
+    const std::vector<std::string>& fact_columns,
+    const std::function<arrow::Result<std::shared_ptr<arrow::Table>>(
+        std::shared_ptr<arrow::Table>)>& star_join,
+    const std::vector<std::string>& group_columns,
+    const std::vector<std::string>& sum_columns,
+    const std::unordered_map<std::string, std::vector<double>>& quantiles,
+    const std::vector<std::string>& distinct_columns) {
+    
+    // Joining an empty fact table yields the schema of every joined batch
+    std::vector<std::shared_ptr<arrow::Field>> fact_fields;
+    auto fact_schema = sales_table_->schema();
+    for (const auto& name : fact_columns) {
+        auto field = fact_schema->GetFieldByName(name);
+        if (!field) {
+            return arrow::Status::Invalid("Column '" + name + "' not found");
+        }
+        fact_fields.push_back(field);
+    }
+    ARROW_ASSIGN_OR_RAISE(auto empty_facts, arrow::Table::MakeEmpty(arrow::schema(fact_fields)));
+    ARROW_ASSIGN_OR_RAISE(auto empty_joined, star_join(empty_facts));
+    
+    // One aggregator per worker; workers only read the shared dimension
+    // tables and indexes, which are fully loaded before the scan starts
+    std::vector<std::unique_ptr<olap::HashAggregator>> aggregators;
+    for (int worker = 0; worker < executor_.num_threads(); ++worker) {
+        ARROW_ASSIGN_OR_RAISE(auto aggregator, olap::HashAggregator::Make(*empty_joined->schema(),
+                                                                          group_columns, sum_columns));
+        for (const auto& [measure, qs] : quantiles) {
+            ARROW_RETURN_NOT_OK(aggregator->AddQuantiles(measure, qs, quantile_compression_));
+        }
+        for (const auto& column : distinct_columns) {
+            ARROW_RETURN_NOT_OK(aggregator->AddDistinctCount(column, approximate_distinct_));
+        }
+        aggregators.push_back(std::move(aggregator));
+    }
+    
+    auto aggregate_morsel = [&](int worker, const arrow::RecordBatch& morsel) -> arrow::Status {
+        auto facts = arrow::Table::Make(morsel.schema(), morsel.columns(), morsel.num_rows());
+        ARROW_ASSIGN_OR_RAISE(auto joined, star_join(facts));
+        olap::TraceSpan span(olap::kStageAggregate, "aggregate morsel");
+        return olap::ForEachBatch(*joined, batch_rows_, [&](const arrow::RecordBatch& rows) {
+            return aggregators[worker]->Consume(rows);
+        });
+    };
+    if (streaming_) {
+        ARROW_ASSIGN_OR_RAISE(auto reader, sales_table_->ReadBatches(fact_columns, batch_rows_));
+        ARROW_RETURN_NOT_OK(executor_.Run(*reader, aggregate_morsel));
+    } else {
+        ARROW_ASSIGN_OR_RAISE(auto projected, sales_table_->Select(fact_columns));
+        ARROW_RETURN_NOT_OK(executor_.Run(*projected, aggregate_morsel));
+    }
+    
+    {
+        olap::TraceSpan span(olap::kStageAggregate, "merge partial aggregates");
+        for (size_t worker = 1; worker < aggregators.size(); ++worker) {
+            ARROW_RETURN_NOT_OK(aggregators[0]->Merge(*aggregators[worker]));
+        }
+    }
+    return aggregators[0]->Finish();
+}
+
+arrow::Result<arrow::acero::Declaration> ArrowOLAPAnalyzer::AceroFactSource(
+    const std::vector<std::string>& columns) {
+    if (streaming_) {
+        ARROW_ASSIGN_OR_RAISE(auto reader, sales_table_->ReadBatches(columns, batch_rows_));
+        return olap::ReaderSource(std::move(reader));
+    }
+    ARROW_ASSIGN_OR_RAISE(auto projected, sales_table_->Select(columns));
+    return olap::TableSource(std::move(projected), batch_rows_);
+}
+
+std::shared_ptr<olap::DimensionIndex> ArrowOLAPAnalyzer::FindDimensionIndex(
+    const arrow::ChunkedArray& keys) const {
+    
+    struct Dimension {
+        const std::shared_ptr<olap::LazyTable>& table;
+        const char* key_column;
+        const std::shared_ptr<olap::DimensionIndex>& index;
+    };
+    for (const auto& dimension : {Dimension{time_table_, "date_key", time_index_},
+                                  Dimension{geography_table_, "geography_key", geography_index_},
+                                  Dimension{product_table_, "product_key", product_index_},
+                                  Dimension{customer_table_, "customer_key", customer_index_}}) {
+        // Projections share the column, so identity means the same keys
+        if (dimension.table && dimension.index &&
+            dimension.table->LoadedColumn(dimension.key_column).get() == &keys) {
+            return dimension.index;
+        }
+    }
+    return nullptr;
+}
+
 arrow::Result<std::shared_ptr<arrow::Table>> ArrowOLAPAnalyzer::JoinTables(
     std::shared_ptr<arrow::Table> left,
     std::shared_ptr<arrow::Table> right,
     const std::string& left_key,
-    const std::string& right_key) {
-    
-    // Simple hash join implementation
-    // In production, you'd use Arrow's optimized join operations
-    
-    // Get key columns
-    ARROW_ASSIGN_OR_RAISE(auto left_key_array, GetColumnAsArray(left, left_key));
-    ARROW_ASSIGN_OR_RAISE(auto right_key_array, GetColumnAsArray(right, right_key));
-    
-    // Build hash table for right table
-    std::unordered_map<std::string, std::vector<int64_t>> right_hash;
-    for (int64_t i = 0; i < right_key_array->length(); ++i) {
-        auto scalar_result = right_key_array->GetScalar(i);
-        if (scalar_result.ok()) {
-            auto key_str = ScalarToString(*scalar_result.ValueOrDie());
-            right_hash[key_str].push_back(i);
+    const std::string& right_key,
+    olap::JoinType join_type) {
+    
+    olap::TraceSpan span(olap::kStageJoin, "JoinTables");
+    if (span.active()) {
+        span.SetDetail(left_key + " (" + std::to_string(left->num_rows()) + " rows)");
+    }
+    auto left_keys = left->GetColumnByName(left_key);
+    auto right_keys = right->GetColumnByName(right_key);
+    if (!left_keys || !right_keys) {
+        return arrow::Status::Invalid("Join key '" + (left_keys ? right_key : left_key) + "' not found");
+    }
+    
+    // Build on the right side. A unique (dimension) key gets a DimensionIndex,
+    // so each probe is a direct array load when the keys are dense; keys that
+    // repeat fall back to the chained hash table. Loaded dimensions reuse the
+    // index built at load time.
+    std::shared_ptr<olap::DimensionIndex> dimension_index = FindDimensionIndex(*right_keys);
+    olap::JoinHashTable hash_table;
+    if (!dimension_index) {
+        auto index_result = olap::DimensionIndex::Make(*right_keys);
+        if (index_result.ok()) {
+            dimension_index = *index_result;
+        } else if (index_result.status().IsKeyError()) {
+            ARROW_RETURN_NOT_OK(hash_table.Build(*right_keys));
+        } else {
+            return index_result.status();
+        }
+    }
+    
+    // Probe with the left side chunk by chunk
+    std::vector<int64_t> left_rows, right_rows;
+    int64_t base_row = 0;
+    for (const auto& chunk : left_keys->chunks()) {
+        if (dimension_index) {
+            ARROW_RETURN_NOT_OK(dimension_index->Probe(*chunk, base_row, join_type, left_rows, right_rows));
+        } else {
+            ARROW_RETURN_NOT_OK(hash_table.Probe(*chunk, base_row, join_type, left_rows, right_rows));
+        }
+        base_row += chunk->length();
+    }
+    
+    const int64_t num_rows = static_cast<int64_t>(left_rows.size());
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+    
+    // Every left row matched exactly once and in order: keep the left columns as-is
+    bool left_identity = num_rows == left->num_rows();
+    for (int64_t i = 0; left_identity && i < num_rows; ++i) {
+        left_identity = left_rows[i] == i;
+    }
+    
+    if (left_identity) {
+        fields = left->schema()->fields();
+        columns = left->columns();
+    } else {
+        ARROW_ASSIGN_OR_RAISE(auto left_indices, MakeTakeIndices(left_rows));
+        ARROW_ASSIGN_OR_RAISE(auto gathered, arrow::compute::Take(left, left_indices, arrow::compute::TakeOptions::Defaults(),
+                                                                  olap::exec_context()));
+        fields = gathered.table()->schema()->fields();
+        columns = gathered.table()->columns();
+    }
+    
+    // Gather the right columns; the right key duplicates the left key and is dropped
+    ARROW_ASSIGN_OR_RAISE(auto right_indices, MakeTakeIndices(right_rows));
+    for (int i = 0; i < right->num_columns(); ++i) {
+        auto field = right->field(i);
+        if (field->name() == right_key) {
+            continue;
         }
+        if (!left->schema()->GetAllFieldIndices(field->name()).empty()) {
+            field = field->WithName(field->name() + "_right");
+        }
+        if (join_type == olap::JoinType::kLeftOuter) {
+            field = field->WithNullable(true);
+        }
+        ARROW_ASSIGN_OR_RAISE(auto gathered, arrow::compute::Take(right->column(i), right_indices,
+                                                              arrow::compute::TakeOptions::Defaults(), olap::exec_context()));
+        fields.push_back(field);
+        columns.push_back(gathered.chunked_array());
     }
     
-    // For simplicity, return left table (in practice would build joined result)
-    return left;
+    return arrow::Table::Make(arrow::schema(fields), columns, num_rows);
 }
 
 void ArrowOLAPAnalyzer::PrintTable(std::shared_ptr<arrow::Table> table, 
                                   const std::string& title,
                                   int max_rows) {
+    olap::TraceSpan span(olap::kStageFormat, "PrintTable");
+    if (span.active()) {
+        span.SetDetail(title);
+    }
     std::cout << "\n" << title << "\n";
     std::cout << std::string(title.length(), '=') << "\n";
     
@@ -117,29 +609,42 @@ void ArrowOLAPAnalyzer::PrintTable(std::shared_ptr<arrow::Table> table,
         return;
     }
     
+    // Columns are at least 15 characters wide and never narrower than their header
+    std::vector<int> widths;
+    for (int i = 0; i < table->num_columns(); ++i) {
+        widths.push_back(std::max<int>(15, table->field(i)->name().length() + 2));
+    }
+    
     // Print column headers
     for (int i = 0; i < table->num_columns(); ++i) {
-        std::cout << std::setw(15) << table->field(i)->name();
+        std::cout << std::setw(widths[i]) << table->field(i)->name();
     }
     std::cout << "\n";
-    std::cout << std::string(table->num_columns() * 15, '-') << "\n";
+    int total_width = 0;
+    for (int width : widths) {
+        total_width += width;
+    }
+    std::cout << std::string(total_width, '-') << "\n";
     
     // Print data rows
     int rows_to_print = std::min(static_cast<int>(table->num_rows()), max_rows);
+    std::vector<olap::ChunkedColumn> columns;
+    for (const auto& column : table->columns()) {
+        columns.emplace_back(column);
+    }
     
     for (int row = 0; row < rows_to_print; ++row) {
         for (int col = 0; col < table->num_columns(); ++col) {
-            auto column = table->column(col);
-            auto chunk = column->chunk(0); // Assuming single chunk for simplicity
-            
-            // Get scalar value and print
-            auto scalar_result = chunk->GetScalar(row);
-            if (scalar_result.ok()) {
-                std::string value = ScalarToString(*scalar_result.ValueOrDie());
-                std::cout << std::setw(15) << value;
-            } else {
-                std::cout << std::setw(15) << "ERROR";
+            auto scalar_result = columns[col].GetScalar(row);
+            if (!scalar_result.ok()) {
+                std::cout << std::setw(widths[col]) << "ERROR";
+                continue;
             }
+            const auto& scalar = *scalar_result.ValueOrDie();
+            std::string value = scalar.is_valid && scalar.type->id() == arrow::Type::DOUBLE
+                                    ? FormatNumber(static_cast<const arrow::DoubleScalar&>(scalar).value)
+                                    : ScalarToString(scalar);
+            std::cout << std::setw(widths[col]) << value;
         }
         std::cout << "\n";
     }
@@ -151,71 +656,75 @@ arrow::Status ArrowOLAPAnalyzer::AnalyzeSalesByTime() {
     std::cout << "==========================================\n";
     
     auto start_time = std::chrono::high_resolution_clock::now();
+    olap::TraceSpan trace(olap::kStageAnalysis, "Time Analysis");
+    olap::AllocationScope allocations;
     
     try {
-        // Get arrays for computation from sales table
-        ARROW_ASSIGN_OR_RAISE(auto gross_sales, GetColumnAsArray(sales_table_, "gross_sales"));
-        ARROW_ASSIGN_OR_RAISE(auto profit, GetColumnAsArray(sales_table_, "profit"));
-        ARROW_ASSIGN_OR_RAISE(auto quantity, GetColumnAsArray(sales_table_, "quantity"));
-        
-        // Calculate basic aggregations using Arrow compute functions
-        arrow::compute::ScalarAggregateOptions sum_options;
-        
-        // Sum gross sales
-        ARROW_ASSIGN_OR_RAISE(auto sum_sales_result, 
-                              arrow::compute::Sum(gross_sales, sum_options));
-        auto sum_sales = std::static_pointer_cast<arrow::DoubleScalar>(sum_sales_result.scalar());
-        
-        // Sum profit
-        ARROW_ASSIGN_OR_RAISE(auto sum_profit_result, 
-                              arrow::compute::Sum(profit, sum_options));
-        auto sum_profit = std::static_pointer_cast<arrow::DoubleScalar>(sum_profit_result.scalar());
-        
-        // Sum quantity
-        ARROW_ASSIGN_OR_RAISE(auto sum_quantity_result, 
-                              arrow::compute::Sum(quantity, sum_options));
-        auto sum_quantity = std::static_pointer_cast<arrow::Int64Scalar>(sum_quantity_result.scalar());
-        
-        // Count records
-        arrow::compute::CountOptions count_options;
-        ARROW_ASSIGN_OR_RAISE(auto count_result, 
-                              arrow::compute::Count(gross_sales, count_options));
-        auto record_count = std::static_pointer_cast<arrow::Int64Scalar>(count_result.scalar());
+        // Every summary aggregate, including the per-transaction margin mean,
+        // in one pass over the three measure columns
+        using olap::AggregateKind;
+        ARROW_ASSIGN_OR_RAISE(auto summary, olap::FusedAggregator::Make(*sales_table_->schema(), {
+            {"records", AggregateKind::kCount, "gross_sales"},
+            {"gross_sales", AggregateKind::kSum, "gross_sales"},
+            {"profit", AggregateKind::kSum, "profit"},
+            {"quantity", AggregateKind::kSum, "quantity"},
+            {"min_sale", AggregateKind::kMin, "gross_sales"},
+            {"max_sale", AggregateKind::kMax, "gross_sales"},
+            {"margin", AggregateKind::kRatioMean, "profit", "gross_sales"}}));
+        ARROW_RETURN_NOT_OK(ScanFacts({"gross_sales", "profit", "quantity"},
+                                      [&](const arrow::RecordBatch& batch) {
+                                          return summary->Consume(batch);
+                                      }));
+        const int64_t record_count = static_cast<int64_t>(summary->Value("records"));
+        const double sum_sales = summary->Value("gross_sales");
+        const double sum_profit = summary->Value("profit");
         
         // Print results
         std::cout << "\nOverall Sales Summary (Arrow Compute)\n";
         std::cout << "=====================================\n";
-        std::cout << "Total Sales Records: " << record_count->value << "\n";
-        std::cout << "Total Gross Sales: $" << FormatNumber(sum_sales->value) << "\n";
-        std::cout << "Total Profit: $" << FormatNumber(sum_profit->value) << "\n";
-        std::cout << "Total Quantity: " << sum_quantity->value << "\n";
-        std::cout << "Average Sale: $" << FormatNumber(sum_sales->value / record_count->value) << "\n";
-        std::cout << "Profit Margin: " << FormatNumber((sum_profit->value / sum_sales->value) * 100, 1) << "%\n";
+        std::cout << "Total Sales Records: " << record_count << "\n";
+        std::cout << "Total Gross Sales: $" << FormatNumber(sum_sales) << "\n";
+        std::cout << "Total Profit: $" << FormatNumber(sum_profit) << "\n";
+        std::cout << "Total Quantity: " << static_cast<int64_t>(summary->Value("quantity")) << "\n";
+        std::cout << "Average Sale: $" << FormatNumber(sum_sales / record_count) << "\n";
+        std::cout << "Profit Margin: " << FormatNumber((sum_profit / sum_sales) * 100, 1) << "%\n";
+        
+        // Star join with the time dimension, then aggregate by year (or
+        // roll the cube's cells up to years)
+        std::shared_ptr<arrow::Table> yearly_sales;
+        if (cube_) {
+            ARROW_ASSIGN_OR_RAISE(yearly_sales, cube_->Rollup({"year"}));
+        } else {
+            ARROW_ASSIGN_OR_RAISE(auto years, time_table_->Select({"date_key", "year"}));
+            ARROW_ASSIGN_OR_RAISE(yearly_sales, AggregateFacts(
+                {"date_key", "gross_sales", "profit", "quantity"},
+                [&](std::shared_ptr<arrow::Table> facts) {
+                    return JoinTables(facts, years, "date_key", "date_key");
+                },
+                {"year"}, {"gross_sales", "profit", "quantity"}));
+        }
+        ARROW_ASSIGN_OR_RAISE(yearly_sales, SortTable(yearly_sales, {arrow::compute::SortKey("year")}));
+        ARROW_ASSIGN_OR_RAISE(yearly_sales, SelectAs(yearly_sales, {{"year", "year"},
+                                                                    {"gross_sales_sum", "gross_sales"},
+                                                                    {"profit_sum", "profit"},
+                                                                    {"quantity_sum", "quantity"}}));
+        PrintTable(yearly_sales, "Sales by Year");
         
         // Demonstrate vectorized operations
         std::cout << "\nArrow Vectorized Operations Demo\n";
         std::cout << "================================\n";
         
-        // Calculate profit margin per transaction
-        ARROW_ASSIGN_OR_RAISE(auto profit_margin, arrow::compute::Divide(profit, gross_sales));
-        ARROW_ASSIGN_OR_RAISE(auto avg_margin_result, arrow::compute::Mean(profit_margin, sum_options));
-        auto avg_margin = std::static_pointer_cast<arrow::DoubleScalar>(avg_margin_result.scalar());
-        
-        std::cout << "Average Profit Margin (vectorized): " << FormatNumber(avg_margin->value * 100, 2) << "%\n";
-        
-        // Min/Max operations using MinMax
-        ARROW_ASSIGN_OR_RAISE(auto minmax_result, arrow::compute::MinMax(gross_sales, sum_options));
-        auto minmax_struct = std::static_pointer_cast<arrow::StructScalar>(minmax_result.scalar());
-        auto min_sales = std::static_pointer_cast<arrow::DoubleScalar>(minmax_struct->value[0]);
-        auto max_sales = std::static_pointer_cast<arrow::DoubleScalar>(minmax_struct->value[1]);
-        
-        std::cout << "Min Sale: $" << FormatNumber(min_sales->value) << "\n";
-        std::cout << "Max Sale: $" << FormatNumber(max_sales->value) << "\n";
+        // Mean of profit / gross_sales per transaction, folded during the
+        // summary pass without materializing a margin array
+        std::cout << "Average Profit Margin (vectorized): " << FormatNumber(summary->Value("margin") * 100, 2) << "%\n";
+        std::cout << "Min Sale: $" << FormatNumber(summary->Value("min_sale")) << "\n";
+        std::cout << "Max Sale: $" << FormatNumber(summary->Value("max_sale")) << "\n";
         
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
         
         std::cout << "\nArrow C++ Time Analysis completed in " << duration.count() << " milliseconds\n";
+        std::cout << "Arrow memory: " << allocations.stats().ToString() << "\n";
         std::cout << "✓ Native Arrow compute functions used\n";
         std::cout << "✓ Vectorized columnar processing\n";
         std::cout << "✓ Zero-copy data access\n";
@@ -233,61 +742,81 @@ arrow::Status ArrowOLAPAnalyzer::AnalyzeSalesByGeography() {
     std::cout << "===============================================\n";
     
     auto start_time = std::chrono::high_resolution_clock::now();
+    olap::TraceSpan trace(olap::kStageAnalysis, "Geography Analysis");
+    olap::AllocationScope allocations;
     
     try {
-        // Demonstrate Arrow's filtering capabilities
-        ARROW_ASSIGN_OR_RAISE(auto gross_sales, GetColumnAsArray(sales_table_, "gross_sales"));
-        ARROW_ASSIGN_OR_RAISE(auto profit, GetColumnAsArray(sales_table_, "profit"));
-        
-        // Create filter for high-value sales (> $100)
-        auto threshold = arrow::MakeScalar(100.0);
-        ARROW_ASSIGN_OR_RAISE(auto high_value_filter, 
-                              arrow::compute::CallFunction("greater", {gross_sales, threshold}));
-        
-        // Apply filter to get high-value sales
-        ARROW_ASSIGN_OR_RAISE(auto filtered_sales, 
-                              arrow::compute::CallFunction("filter", {gross_sales, high_value_filter}));
-        ARROW_ASSIGN_OR_RAISE(auto filtered_profit, 
-                              arrow::compute::CallFunction("filter", {profit, high_value_filter}));
-        
-        // Calculate statistics on filtered data
-        arrow::compute::ScalarAggregateOptions sum_options;
-        arrow::compute::CountOptions count_options;
-        
-        ARROW_ASSIGN_OR_RAISE(auto total_sales_result, 
-                              arrow::compute::Sum(filtered_sales.make_array(), sum_options));
-        auto total_sales = std::static_pointer_cast<arrow::DoubleScalar>(total_sales_result.scalar());
-        
-        ARROW_ASSIGN_OR_RAISE(auto total_profit_result, 
-                              arrow::compute::Sum(filtered_profit.make_array(), sum_options));
-        auto total_profit = std::static_pointer_cast<arrow::DoubleScalar>(total_profit_result.scalar());
-        
-        ARROW_ASSIGN_OR_RAISE(auto count_result, 
-                              arrow::compute::Count(filtered_sales.make_array(), count_options));
-        auto high_value_count = std::static_pointer_cast<arrow::Int64Scalar>(count_result.scalar());
+        // High-value sales (> $100): row groups whose gross_sales statistics
+        // rule out a match are skipped before any decoding
+        using olap::AggregateKind;
+        ARROW_ASSIGN_OR_RAISE(auto high_value, olap::FusedAggregator::Make(*sales_table_->schema(), {
+            {"records", AggregateKind::kCount, "gross_sales"},
+            {"gross_sales", AggregateKind::kSum, "gross_sales"},
+            {"profit", AggregateKind::kSum, "profit"}}));
+        olap::PruneStats pruning;
+        ARROW_RETURN_NOT_OK(ScanFactsWhere({"gross_sales", "profit"},
+                                           {{"gross_sales", olap::CompareOp::kGreater, 100.0}},
+                                           [&](const arrow::RecordBatch& batch) {
+                                               return high_value->Consume(batch);
+                                           },
+                                           &pruning));
+        const int64_t high_value_count = static_cast<int64_t>(high_value->Value("records"));
+        const double total_sales = high_value->Value("gross_sales");
+        const double total_profit = high_value->Value("profit");
         
         // Original totals for comparison
-        ARROW_ASSIGN_OR_RAISE(auto orig_total_result, 
-                              arrow::compute::Sum(gross_sales, sum_options));
-        auto orig_total = std::static_pointer_cast<arrow::DoubleScalar>(orig_total_result.scalar());
-        
-        ARROW_ASSIGN_OR_RAISE(auto orig_count_result, 
-                              arrow::compute::Count(gross_sales, count_options));
-        auto orig_count = std::static_pointer_cast<arrow::Int64Scalar>(orig_count_result.scalar());
+        ARROW_ASSIGN_OR_RAISE(auto overall, olap::FusedAggregator::Make(*sales_table_->schema(), {
+            {"records", AggregateKind::kCount, "gross_sales"},
+            {"gross_sales", AggregateKind::kSum, "gross_sales"}}));
+        ARROW_RETURN_NOT_OK(ScanFacts({"gross_sales"}, [&](const arrow::RecordBatch& batch) {
+            return overall->Consume(batch);
+        }));
+        const int64_t orig_count = static_cast<int64_t>(overall->Value("records"));
+        const double orig_total = overall->Value("gross_sales");
         
         std::cout << "\nHigh-Value Sales Analysis (> $100)\n";
         std::cout << "==================================\n";
-        std::cout << "Total Records: " << orig_count->value << "\n";
-        std::cout << "High-Value Records: " << high_value_count->value << "\n";
-        std::cout << "High-Value Percentage: " << FormatNumber((double)high_value_count->value / orig_count->value * 100, 1) << "%\n";
-        std::cout << "High-Value Sales: $" << FormatNumber(total_sales->value) << "\n";
-        std::cout << "High-Value Profit: $" << FormatNumber(total_profit->value) << "\n";
-        std::cout << "% of Total Sales: " << FormatNumber(total_sales->value / orig_total->value * 100, 1) << "%\n";
+        if (pruning.files > 0) {
+            std::cout << "Files Skipped: " << pruning.skipped_by_partition << " of " << pruning.files
+                      << " (by partition values)\n";
+        }
+        std::cout << "Row Groups Skipped: " << pruning.skipped() << " of " << pruning.row_groups
+                  << " (" << pruning.skipped_by_statistics << " by statistics, "
+                  << pruning.skipped_by_page_index << " by page index)\n";
+        std::cout << "Total Records: " << orig_count << "\n";
+        std::cout << "High-Value Records: " << high_value_count << "\n";
+        std::cout << "High-Value Percentage: " << FormatNumber((double)high_value_count / orig_count * 100, 1) << "%\n";
+        std::cout << "High-Value Sales: $" << FormatNumber(total_sales) << "\n";
+        std::cout << "High-Value Profit: $" << FormatNumber(total_profit) << "\n";
+        std::cout << "% of Total Sales: " << FormatNumber(total_sales / orig_total * 100, 1) << "%\n";
+        
+        // Star join with the geography dimension, then aggregate by region
+        // (or roll the cube's cells up to regions)
+        std::shared_ptr<arrow::Table> regional_sales;
+        if (cube_) {
+            ARROW_ASSIGN_OR_RAISE(regional_sales, cube_->Rollup({"region"}));
+        } else {
+            ARROW_ASSIGN_OR_RAISE(auto regions, geography_table_->Select({"geography_key", "region"}));
+            ARROW_ASSIGN_OR_RAISE(regional_sales, AggregateFacts(
+                {"geography_key", "gross_sales", "profit", "quantity"},
+                [&](std::shared_ptr<arrow::Table> facts) {
+                    return JoinTables(facts, regions, "geography_key", "geography_key");
+                },
+                {"region"}, {"gross_sales", "profit", "quantity"}));
+        }
+        ARROW_ASSIGN_OR_RAISE(regional_sales, SortTable(regional_sales,
+            {arrow::compute::SortKey("gross_sales_sum", arrow::compute::SortOrder::Descending)}));
+        ARROW_ASSIGN_OR_RAISE(regional_sales, SelectAs(regional_sales, {{"region", "region"},
+                                                                        {"gross_sales_sum", "gross_sales"},
+                                                                        {"profit_sum", "profit"},
+                                                                        {"quantity_sum", "quantity"}}));
+        PrintTable(regional_sales, "Sales by Region");
         
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
         
         std::cout << "\nArrow C++ Geography Analysis completed in " << duration.count() << " milliseconds\n";
+        std::cout << "Arrow memory: " << allocations.stats().ToString() << "\n";
         std::cout << "✓ Efficient vectorized filtering\n";
         std::cout << "✓ Predicate pushdown optimization\n";
         std::cout << "✓ Memory-efficient processing\n";
@@ -304,56 +833,89 @@ arrow::Status ArrowOLAPAnalyzer::AnalyzeSalesByProduct() {
     std::cout << "=============================================\n";
     
     auto start_time = std::chrono::high_resolution_clock::now();
+    olap::TraceSpan trace(olap::kStageAnalysis, "Product Analysis");
+    olap::AllocationScope allocations;
     
     try {
-        // Demonstrate Arrow's mathematical operations
-        ARROW_ASSIGN_OR_RAISE(auto gross_sales, GetColumnAsArray(sales_table_, "gross_sales"));
-        ARROW_ASSIGN_OR_RAISE(auto profit, GetColumnAsArray(sales_table_, "profit"));
-        ARROW_ASSIGN_OR_RAISE(auto quantity, GetColumnAsArray(sales_table_, "quantity"));
-        
-        // Calculate percentiles using Arrow compute
-        arrow::compute::QuantileOptions quantile_options;
-        quantile_options.q = {0.25, 0.5, 0.75, 0.95, 0.99};
-        
-        ARROW_ASSIGN_OR_RAISE(auto sales_quantiles, 
-                              arrow::compute::Quantile(gross_sales, quantile_options));
-        auto quantile_array = std::static_pointer_cast<arrow::DoubleArray>(sales_quantiles.make_array());
+        // Percentiles: exact selection over the cached column, or in
+        // streaming mode a t-digest built batch by batch
+        const std::vector<double> percentiles = {0.25, 0.5, 0.75, 0.95, 0.99};
+        std::vector<double> sales_quantiles;
+        if (streaming_) {
+            olap::TDigest digest(quantile_compression_);
+            ARROW_RETURN_NOT_OK(ScanFacts({"gross_sales"}, [&](const arrow::RecordBatch& batch) {
+                return digest.Add(*batch.column(0));
+            }));
+            for (double q : percentiles) {
+                sales_quantiles.push_back(digest.Quantile(q));
+            }
+        } else {
+            ARROW_ASSIGN_OR_RAISE(auto gross_sales, GetFactColumn("gross_sales"));
+            arrow::compute::QuantileOptions quantile_options;
+            quantile_options.q = percentiles;
+            ARROW_ASSIGN_OR_RAISE(auto exact, arrow::compute::Quantile(gross_sales.datum(), quantile_options,
+                                                                              olap::exec_context()));
+            auto quantile_array = std::static_pointer_cast<arrow::DoubleArray>(exact.make_array());
+            for (int64_t i = 0; i < quantile_array->length(); ++i) {
+                sales_quantiles.push_back(quantile_array->Value(i));
+            }
+        }
         
-        std::cout << "\nSales Distribution (Percentiles)\n";
+        std::cout << "\nSales Distribution (Percentiles" << (streaming_ ? ", t-digest" : "") << ")\n";
         std::cout << "================================\n";
-        std::cout << "25th Percentile: $" << FormatNumber(quantile_array->Value(0)) << "\n";
-        std::cout << "50th Percentile (Median): $" << FormatNumber(quantile_array->Value(1)) << "\n";
-        std::cout << "75th Percentile: $" << FormatNumber(quantile_array->Value(2)) << "\n";
-        std::cout << "95th Percentile: $" << FormatNumber(quantile_array->Value(3)) << "\n";
-        std::cout << "99th Percentile: $" << FormatNumber(quantile_array->Value(4)) << "\n";
-        
-        // Standard deviation and variance
-        arrow::compute::VarianceOptions var_options;
-        ARROW_ASSIGN_OR_RAISE(auto stddev_result, 
-                              arrow::compute::Stddev(gross_sales, var_options));
-        auto stddev = std::static_pointer_cast<arrow::DoubleScalar>(stddev_result.scalar());
-        
-        ARROW_ASSIGN_OR_RAISE(auto variance_result, 
-                              arrow::compute::Variance(gross_sales, var_options));
-        auto variance = std::static_pointer_cast<arrow::DoubleScalar>(variance_result.scalar());
+        std::cout << "25th Percentile: $" << FormatNumber(sales_quantiles[0]) << "\n";
+        std::cout << "50th Percentile (Median): $" << FormatNumber(sales_quantiles[1]) << "\n";
+        std::cout << "75th Percentile: $" << FormatNumber(sales_quantiles[2]) << "\n";
+        std::cout << "95th Percentile: $" << FormatNumber(sales_quantiles[3]) << "\n";
+        std::cout << "99th Percentile: $" << FormatNumber(sales_quantiles[4]) << "\n";
+        
+        // Star join with the product dimension, then aggregate by category
+        ARROW_ASSIGN_OR_RAISE(auto categories, product_table_->Select({"product_key", "category"}));
+        ARROW_ASSIGN_OR_RAISE(auto category_sales, AggregateFacts(
+            {"product_key", "gross_sales", "profit", "quantity"},
+            [&](std::shared_ptr<arrow::Table> facts) {
+                return JoinTables(facts, categories, "product_key", "product_key");
+            },
+            {"category"}, {"gross_sales", "profit", "quantity"},
+            {{"gross_sales", {0.5, 0.95, 0.99}}}));
+        ARROW_ASSIGN_OR_RAISE(category_sales, SortTable(category_sales,
+            {arrow::compute::SortKey("gross_sales_sum", arrow::compute::SortOrder::Descending)}));
+        ARROW_ASSIGN_OR_RAISE(auto category_totals, SelectAs(category_sales, {{"category", "category"},
+                                                                              {"gross_sales_sum", "gross_sales"},
+                                                                              {"profit_sum", "profit"},
+                                                                              {"quantity_sum", "quantity"}}));
+        PrintTable(category_totals, "Sales by Category");
+        
+        // Per-category sale size distribution from the per-group t-digests
+        ARROW_ASSIGN_OR_RAISE(auto category_percentiles, SelectAs(category_sales, {{"category", "category"},
+                                                                                   {"gross_sales_p50", "median_sale"},
+                                                                                   {"gross_sales_p95", "p95_sale"},
+                                                                                   {"gross_sales_p99", "p99_sale"}}));
+        PrintTable(category_percentiles, "Sale Percentiles by Category (t-digest)");
+        
+        // Standard deviation and variance from merged running moments, and
+        // the mean profit per item, in one pass without materializing a column
+        using olap::AggregateKind;
+        ARROW_ASSIGN_OR_RAISE(auto statistics, olap::FusedAggregator::Make(*sales_table_->schema(), {
+            {"stddev", AggregateKind::kStddev, "gross_sales"},
+            {"variance", AggregateKind::kVariance, "gross_sales"},
+            {"avg_profit_per_item", AggregateKind::kRatioMean, "profit", "quantity"}}));
+        ARROW_RETURN_NOT_OK(ScanFacts({"gross_sales", "profit", "quantity"},
+                                      [&](const arrow::RecordBatch& batch) {
+                                          return statistics->Consume(batch);
+                                      }));
         
         std::cout << "\nStatistical Measures\n";
         std::cout << "===================\n";
-        std::cout << "Standard Deviation: $" << FormatNumber(stddev->value) << "\n";
-        std::cout << "Variance: $" << FormatNumber(variance->value) << "\n";
-        
-        // Show vectorized calculations
-        ARROW_ASSIGN_OR_RAISE(auto profit_per_item, arrow::compute::Divide(profit, quantity));
-        arrow::compute::ScalarAggregateOptions agg_options;
-        ARROW_ASSIGN_OR_RAISE(auto avg_profit_per_item, arrow::compute::Mean(profit_per_item, agg_options));
-        auto avg_profit = std::static_pointer_cast<arrow::DoubleScalar>(avg_profit_per_item.scalar());
-        
-        std::cout << "Average Profit per Item: $" << FormatNumber(avg_profit->value) << "\n";
+        std::cout << "Standard Deviation: $" << FormatNumber(statistics->Value("stddev")) << "\n";
+        std::cout << "Variance: $" << FormatNumber(statistics->Value("variance")) << "\n";
+        std::cout << "Average Profit per Item: $" << FormatNumber(statistics->Value("avg_profit_per_item")) << "\n";
         
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
         
         std::cout << "\nArrow C++ Product Analysis completed in " << duration.count() << " milliseconds\n";
+        std::cout << "Arrow memory: " << allocations.stats().ToString() << "\n";
         std::cout << "✓ Advanced statistical functions\n";
         std::cout << "✓ Efficient quantile calculations\n";
         std::cout << "✓ Vectorized mathematical operations\n";
@@ -370,92 +932,37 @@ arrow::Status ArrowOLAPAnalyzer::AnalyzeCustomerSegments() {
     std::cout << "=============================================\n";
     
     auto start_time = std::chrono::high_resolution_clock::now();
+    olap::TraceSpan trace(olap::kStageAnalysis, "Customer Analysis");
+    olap::AllocationScope allocations;
     
     try {
-        // Get arrays for computation
-        ARROW_ASSIGN_OR_RAISE(auto customer_keys, GetColumnAsArray(sales_table_, "customer_key"));
-        ARROW_ASSIGN_OR_RAISE(auto gross_sales, GetColumnAsArray(sales_table_, "gross_sales"));
-        ARROW_ASSIGN_OR_RAISE(auto profit, GetColumnAsArray(sales_table_, "profit"));
-        
-        ARROW_ASSIGN_OR_RAISE(auto cust_customer_keys, GetColumnAsArray(customer_table_, "customer_key"));
-        ARROW_ASSIGN_OR_RAISE(auto customer_types, GetColumnAsArray(customer_table_, "customer_type"));
-        
-        // Build customer lookup map
-        std::unordered_map<int, std::string> cust_to_type;
-        for (int64_t i = 0; i < cust_customer_keys->length(); ++i) {
-            auto cust_scalar = cust_customer_keys->GetScalar(i);
-            auto type_scalar = customer_types->GetScalar(i);
-            
-            if (cust_scalar.ok() && type_scalar.ok()) {
-                auto cust_val = std::static_pointer_cast<arrow::Int32Scalar>(cust_scalar.ValueOrDie());
-                auto type_val = std::static_pointer_cast<arrow::StringScalar>(type_scalar.ValueOrDie());
-                
-                if (cust_val->is_valid && type_val->is_valid) {
-                    cust_to_type[cust_val->value] = type_val->value->ToString();
-                }
-            }
-        }
-        
-        // Aggregate by customer type
-        std::map<std::string, std::vector<double>> type_sales, type_profit;
-        std::map<std::string, std::set<int>> unique_customers;
-        std::map<std::string, int> order_counts;
-        
-        for (int64_t i = 0; i < customer_keys->length(); ++i) {
-            auto cust_scalar = customer_keys->GetScalar(i);
-            auto sales_scalar = gross_sales->GetScalar(i);
-            auto profit_scalar = profit->GetScalar(i);
-            
-            if (cust_scalar.ok() && sales_scalar.ok() && profit_scalar.ok()) {
-                auto cust_val = std::static_pointer_cast<arrow::Int32Scalar>(cust_scalar.ValueOrDie());
-                auto sales_val = std::static_pointer_cast<arrow::DoubleScalar>(sales_scalar.ValueOrDie());
-                auto profit_val = std::static_pointer_cast<arrow::DoubleScalar>(profit_scalar.ValueOrDie());
-                
-                if (cust_val->is_valid && sales_val->is_valid && profit_val->is_valid) {
-                    auto type_it = cust_to_type.find(cust_val->value);
-                    
-                    if (type_it != cust_to_type.end()) {
-                        const std::string& type = type_it->second;
-                        type_sales[type].push_back(sales_val->value);
-                        type_profit[type].push_back(profit_val->value);
-                        unique_customers[type].insert(cust_val->value);
-                        order_counts[type]++;
-                    }
-                }
-            }
-        }
-        
-        // Print customer segment results
-        std::cout << "\nSales by Customer Type\n";
-        std::cout << "======================\n";
-        std::cout << std::setw(18) << "customer_type" 
-                 << std::setw(15) << "total_sales"
-                 << std::setw(18) << "avg_sales_per_order" 
-                 << std::setw(15) << "total_profit"
-                 << std::setw(18) << "avg_profit_per_order"
-                 << std::setw(18) << "unique_customers" << "\n";
-        std::cout << std::string(102, '-') << "\n";
-        
-        for (const auto& [type, sales_vec] : type_sales) {
-            double total_sales = std::accumulate(sales_vec.begin(), sales_vec.end(), 0.0);
-            double total_profit = std::accumulate(type_profit[type].begin(), type_profit[type].end(), 0.0);
-            double avg_sales = total_sales / order_counts[type];
-            double avg_profit = total_profit / order_counts[type];
-            int unique_count = unique_customers[type].size();
-            
-            std::cout << std::setw(18) << type 
-                     << std::setw(15) << FormatNumber(total_sales)
-                     << std::setw(18) << FormatNumber(avg_sales)
-                     << std::setw(15) << FormatNumber(total_profit)
-                     << std::setw(18) << FormatNumber(avg_profit)
-                     << std::setw(18) << unique_count << "\n";
-        }
+        // Star join with the customer dimension; the distinct customers of
+        // each type are counted in per-group bitmaps of customer_key
+        ARROW_ASSIGN_OR_RAISE(auto customer_types, customer_table_->Select({"customer_key", "customer_type"}));
+        ARROW_ASSIGN_OR_RAISE(auto segments, AggregateFacts(
+            {"customer_key", "gross_sales", "profit"},
+            [&](std::shared_ptr<arrow::Table> facts) {
+                return JoinTables(facts, customer_types, "customer_key", "customer_key");
+            },
+            {"customer_type"}, {"gross_sales", "profit"}, {}, {"customer_key"}));
+        
+        ARROW_ASSIGN_OR_RAISE(segments, SelectAs(segments, {{"customer_type", "customer_type"},
+                                                            {"gross_sales_sum", "total_sales"},
+                                                            {"gross_sales_mean", "avg_sales_per_order"},
+                                                            {"profit_sum", "total_profit"},
+                                                            {"profit_mean", "avg_profit_per_order"},
+                                                            {"customer_key_distinct", "unique_customers"}}));
+        ARROW_ASSIGN_OR_RAISE(segments, SortTable(segments,
+            {arrow::compute::SortKey("total_sales", arrow::compute::SortOrder::Descending)}));
+        PrintTable(segments, "Sales by Customer Type");
         
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
         
         std::cout << "\nArrow C++ Customer Analysis completed in " << duration.count() << " milliseconds\n";
-        std::cout << "✓ Efficient set-based unique counting\n";
+        std::cout << "Arrow memory: " << allocations.stats().ToString() << "\n";
+        std::cout << (approximate_distinct_ ? "✓ Distinct counting with roaring bitmaps and HyperLogLog sketches\n"
+                                            : "✓ Exact distinct counting with per-group roaring bitmaps\n");
         std::cout << "✓ Parallel-ready aggregation patterns\n";
         std::cout << "✓ Memory-optimized data structures\n";
         
@@ -471,106 +978,40 @@ arrow::Status ArrowOLAPAnalyzer::MultidimensionalAnalysis() {
     std::cout << "=============================================\n";
     
     auto start_time = std::chrono::high_resolution_clock::now();
+    olap::TraceSpan trace(olap::kStageAnalysis, "Multidimensional Analysis");
+    olap::AllocationScope allocations;
     
     try {
-        // Multi-dimensional analysis: Region + Product Category
-        ARROW_ASSIGN_OR_RAISE(auto geo_keys, GetColumnAsArray(sales_table_, "geography_key"));
-        ARROW_ASSIGN_OR_RAISE(auto product_keys, GetColumnAsArray(sales_table_, "product_key"));
-        ARROW_ASSIGN_OR_RAISE(auto gross_sales, GetColumnAsArray(sales_table_, "gross_sales"));
-        
-        // Build lookup maps
-        ARROW_ASSIGN_OR_RAISE(auto geo_geo_keys, GetColumnAsArray(geography_table_, "geography_key"));
-        ARROW_ASSIGN_OR_RAISE(auto regions, GetColumnAsArray(geography_table_, "region"));
-        
-        ARROW_ASSIGN_OR_RAISE(auto prod_product_keys, GetColumnAsArray(product_table_, "product_key"));
-        ARROW_ASSIGN_OR_RAISE(auto categories, GetColumnAsArray(product_table_, "category"));
-        
-        std::unordered_map<int, std::string> geo_to_region, prod_to_category;
-        
-        // Build geography lookup
-        for (int64_t i = 0; i < geo_geo_keys->length(); ++i) {
-            auto geo_scalar = geo_geo_keys->GetScalar(i);
-            auto region_scalar = regions->GetScalar(i);
-            
-            if (geo_scalar.ok() && region_scalar.ok()) {
-                auto geo_val = std::static_pointer_cast<arrow::Int32Scalar>(geo_scalar.ValueOrDie());
-                auto region_val = std::static_pointer_cast<arrow::StringScalar>(region_scalar.ValueOrDie());
-                
-                if (geo_val->is_valid && region_val->is_valid) {
-                    geo_to_region[geo_val->value] = region_val->value->ToString();
-                }
-            }
-        }
-        
-        // Build product lookup
-        for (int64_t i = 0; i < prod_product_keys->length(); ++i) {
-            auto prod_scalar = prod_product_keys->GetScalar(i);
-            auto cat_scalar = categories->GetScalar(i);
-            
-            if (prod_scalar.ok() && cat_scalar.ok()) {
-                auto prod_val = std::static_pointer_cast<arrow::Int32Scalar>(prod_scalar.ValueOrDie());
-                auto cat_val = std::static_pointer_cast<arrow::StringScalar>(cat_scalar.ValueOrDie());
-                
-                if (prod_val->is_valid && cat_val->is_valid) {
-                    prod_to_category[prod_val->value] = cat_val->value->ToString();
-                }
-            }
-        }
-        
-        // Multi-dimensional aggregation
-        std::map<std::pair<std::string, std::string>, std::vector<double>> region_category_sales;
-        
-        for (int64_t i = 0; i < geo_keys->length(); ++i) {
-            auto geo_scalar = geo_keys->GetScalar(i);
-            auto prod_scalar = product_keys->GetScalar(i);
-            auto sales_scalar = gross_sales->GetScalar(i);
-            
-            if (geo_scalar.ok() && prod_scalar.ok() && sales_scalar.ok()) {
-                auto geo_val = std::static_pointer_cast<arrow::Int32Scalar>(geo_scalar.ValueOrDie());
-                auto prod_val = std::static_pointer_cast<arrow::Int32Scalar>(prod_scalar.ValueOrDie());
-                auto sales_val = std::static_pointer_cast<arrow::DoubleScalar>(sales_scalar.ValueOrDie());
-                
-                if (geo_val->is_valid && prod_val->is_valid && sales_val->is_valid) {
-                    auto region_it = geo_to_region.find(geo_val->value);
-                    auto category_it = prod_to_category.find(prod_val->value);
-                    
-                    if (region_it != geo_to_region.end() && category_it != prod_to_category.end()) {
-                        auto key = std::make_pair(region_it->second, category_it->second);
-                        region_category_sales[key].push_back(sales_val->value);
-                    }
-                }
-            }
-        }
-        
-        // Print multidimensional results
-        std::cout << "\nSales by Region and Product Category\n";
-        std::cout << "====================================\n";
-        std::cout << std::setw(20) << "region" << std::setw(20) << "category" << std::setw(15) << "gross_sales\n";
-        std::cout << std::string(55, '-') << "\n";
-        
-        // Sort by region then category
-        std::vector<std::pair<std::pair<std::string, std::string>, double>> sorted_results;
-        for (const auto& [key, sales_vec] : region_category_sales) {
-            double total_sales = std::accumulate(sales_vec.begin(), sales_vec.end(), 0.0);
-            sorted_results.emplace_back(key, total_sales);
-        }
-        
-        std::sort(sorted_results.begin(), sorted_results.end(),
-                 [](const auto& a, const auto& b) {
-                     if (a.first.first != b.first.first) return a.first.first < b.first.first;
-                     return a.first.second < b.first.second;
-                 });
-        
-        for (const auto& [key, total_sales] : sorted_results) {
-            std::cout << std::setw(20) << key.first 
-                     << std::setw(20) << key.second
-                     << std::setw(15) << FormatNumber(total_sales) << "\n";
+        // Star join with the geography and product dimensions, aggregated
+        // over composite (region, category) keys (or rolled up from the cube)
+        std::shared_ptr<arrow::Table> region_category_sales;
+        if (cube_) {
+            ARROW_ASSIGN_OR_RAISE(region_category_sales, cube_->Rollup({"region", "category"}));
+        } else {
+            ARROW_ASSIGN_OR_RAISE(auto regions, geography_table_->Select({"geography_key", "region"}));
+            ARROW_ASSIGN_OR_RAISE(auto categories, product_table_->Select({"product_key", "category"}));
+            ARROW_ASSIGN_OR_RAISE(region_category_sales, AggregateFacts(
+                {"geography_key", "product_key", "gross_sales"},
+                [&](std::shared_ptr<arrow::Table> facts) -> arrow::Result<std::shared_ptr<arrow::Table>> {
+                    ARROW_ASSIGN_OR_RAISE(auto sales_by_geo, JoinTables(facts, regions,
+                                                                        "geography_key", "geography_key"));
+                    return JoinTables(sales_by_geo, categories, "product_key", "product_key");
+                },
+                {"region", "category"}, {"gross_sales"}));
         }
+        ARROW_ASSIGN_OR_RAISE(region_category_sales, SortTable(region_category_sales,
+            {arrow::compute::SortKey("region"), arrow::compute::SortKey("category")}));
+        ARROW_ASSIGN_OR_RAISE(region_category_sales, SelectAs(region_category_sales,
+                                                              {{"region", "region"},
+                                                               {"category", "category"},
+                                                               {"gross_sales_sum", "gross_sales"}}));
+        PrintTable(region_category_sales, "Sales by Region and Product Category", 50);
         
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
         
         std::cout << "\nArrow C++ Multidimensional Analysis completed in " << duration.count() << " milliseconds\n";
+        std::cout << "Arrow memory: " << allocations.stats().ToString() << "\n";
         std::cout << "✓ Complex multi-table joins\n";
         std::cout << "✓ Efficient cross-dimensional aggregation\n";
         std::cout << "✓ Scalable hash-based processing\n";
@@ -588,16 +1029,144 @@ arrow::Status ArrowOLAPAnalyzer::MultidimensionalAnalysis() {
     return arrow::Status::OK();
 }
 
+arrow::Status ArrowOLAPAnalyzer::RunAceroAnalyses() {
+    std::cout << "\n\nACERO EXECUTION PLANS (Apache Arrow C++)\n";
+    std::cout << "========================================\n";
+    
+    ARROW_ASSIGN_OR_RAISE(auto years, time_table_->Select({"date_key", "year"}));
+    ARROW_ASSIGN_OR_RAISE(auto regions, geography_table_->Select({"geography_key", "region"}));
+    ARROW_ASSIGN_OR_RAISE(auto categories, product_table_->Select({"product_key", "category"}));
+    ARROW_ASSIGN_OR_RAISE(auto customer_types, customer_table_->Select({"customer_key", "customer_type"}));
+    
+    auto descending = [](const std::string& name) {
+        return cp::SortKey(name, cp::SortOrder::Descending);
+    };
+    std::vector<cp::Aggregate> measure_sums = {{"hash_sum", "gross_sales", "gross_sales"},
+                                               {"hash_sum", "profit", "profit"},
+                                               {"hash_sum", "quantity", "quantity"}};
+    
+    // Builds the plan, runs it to completion and prints its output
+    auto run = [&](const std::string& title,
+                   const std::function<arrow::Result<arrow::acero::Declaration>()>& build) -> arrow::Status {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        olap::AllocationScope allocations;
+        olap::TraceSpan trace(olap::kStageAnalysis, "Acero plan");
+        if (trace.active()) {
+            trace.SetDetail(title);
+        }
+        ARROW_ASSIGN_OR_RAISE(auto plan, build());
+        ARROW_ASSIGN_OR_RAISE(auto result, olap::RunPlan(plan));
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - start_time);
+        PrintTable(result, title, 50);
+        std::cout << "Acero plan completed in " << duration.count() << " milliseconds\n";
+        std::cout << "Arrow memory: " << allocations.stats().ToString() << "\n";
+        return arrow::Status::OK();
+    };
+    
+    ARROW_RETURN_NOT_OK(run("Sales by Year", [&]() -> arrow::Result<arrow::acero::Declaration> {
+        ARROW_ASSIGN_OR_RAISE(auto facts, AceroFactSource({"date_key", "gross_sales", "profit", "quantity"}));
+        return olap::OrderBy(olap::Aggregate(olap::JoinDimension(std::move(facts), years, "date_key"),
+                                             measure_sums, {"year"}),
+                             {cp::SortKey("year")});
+    }));
+    
+    // filter -> project -> scalar aggregate
+    ARROW_RETURN_NOT_OK(run("High-Value Sales (> $100)", [&]() -> arrow::Result<arrow::acero::Declaration> {
+        ARROW_ASSIGN_OR_RAISE(auto facts, AceroFactSource({"gross_sales", "profit"}));
+        return olap::Aggregate(
+            arrow::acero::Declaration::Sequence(
+                {std::move(facts),
+                 {"filter", arrow::acero::FilterNodeOptions(
+                                cp::greater(cp::field_ref("gross_sales"), cp::literal(100.0)))},
+                 {"project", arrow::acero::ProjectNodeOptions(
+                                 {cp::field_ref("gross_sales"), cp::field_ref("profit"),
+                                  cp::call("divide", {cp::field_ref("profit"), cp::field_ref("gross_sales")})},
+                                 {"gross_sales", "profit", "margin"})}}),
+            {{"count", "gross_sales", "records"},
+             {"sum", "gross_sales", "gross_sales"},
+             {"sum", "profit", "profit"},
+             {"mean", "margin", "avg_margin"}});
+    }));
+    
+    ARROW_RETURN_NOT_OK(run("Sales by Region", [&]() -> arrow::Result<arrow::acero::Declaration> {
+        ARROW_ASSIGN_OR_RAISE(auto facts, AceroFactSource({"geography_key", "gross_sales", "profit", "quantity"}));
+        return olap::OrderBy(olap::Aggregate(olap::JoinDimension(std::move(facts), regions, "geography_key"),
+                                             measure_sums, {"region"}),
+                             {descending("gross_sales")});
+    }));
+    
+    ARROW_RETURN_NOT_OK(run("Sales by Category", [&]() -> arrow::Result<arrow::acero::Declaration> {
+        ARROW_ASSIGN_OR_RAISE(auto facts, AceroFactSource({"product_key", "gross_sales", "profit", "quantity"}));
+        return olap::OrderBy(olap::Aggregate(olap::JoinDimension(std::move(facts), categories, "product_key"),
+                                             measure_sums, {"category"}),
+                             {descending("gross_sales")});
+    }));
+    
+    ARROW_RETURN_NOT_OK(run("Sales by Customer Type", [&]() -> arrow::Result<arrow::acero::Declaration> {
+        ARROW_ASSIGN_OR_RAISE(auto facts, AceroFactSource({"customer_key", "gross_sales", "profit"}));
+        auto segments = olap::Aggregate(olap::JoinDimension(std::move(facts), customer_types, "customer_key"),
+                                        {{"hash_sum", "gross_sales", "total_sales"},
+                                         {"hash_mean", "gross_sales", "avg_sales_per_order"},
+                                         {"hash_sum", "profit", "total_profit"},
+                                         {"hash_mean", "profit", "avg_profit_per_order"},
+                                         {"hash_count_distinct", "customer_key", "unique_customers"}},
+                                        {"customer_type"});
+        return olap::OrderBy(std::move(segments), {descending("total_sales")});
+    }));
+    
+    ARROW_RETURN_NOT_OK(run("Sales by Region and Product Category", [&]() -> arrow::Result<arrow::acero::Declaration> {
+        ARROW_ASSIGN_OR_RAISE(auto facts, AceroFactSource({"geography_key", "product_key", "gross_sales"}));
+        auto joined = olap::JoinDimension(olap::JoinDimension(std::move(facts), regions, "geography_key"),
+                                          categories, "product_key");
+        auto rollup = arrow::acero::Declaration::Sequence(
+            {olap::Aggregate(std::move(joined), {{"hash_sum", "gross_sales", "gross_sales"}},
+                             {"region", "category"}),
+             {"project", arrow::acero::ProjectNodeOptions(
+                             {AsString("region"), AsString("category"), cp::field_ref("gross_sales")},
+                             {"region", "category", "gross_sales"})}});
+        return olap::OrderBy(std::move(rollup), {cp::SortKey("region"), cp::SortKey("category")});
+    }));
+    
+    std::cout << "\n✓ Pipelined scan -> filter -> project -> hash_join -> aggregate -> order_by\n";
+    std::cout << "✓ Batches scheduled on Arrow's CPU thread pool\n";
+    return arrow::Status::OK();
+}
+
 arrow::Status ArrowOLAPAnalyzer::RunAllAnalyses() {
     try {
+        const auto start = std::chrono::steady_clock::now();
         ARROW_RETURN_NOT_OK(LoadAllTables());
         PrintDataInfo();
         
-        ARROW_RETURN_NOT_OK(AnalyzeSalesByTime());
-        ARROW_RETURN_NOT_OK(AnalyzeSalesByGeography());
-        ARROW_RETURN_NOT_OK(AnalyzeSalesByProduct());
-        ARROW_RETURN_NOT_OK(AnalyzeCustomerSegments());
-        ARROW_RETURN_NOT_OK(MultidimensionalAnalysis());
+        // Hardware counters of each analysis, over all threads (OLAP_PERF_COUNTERS=1)
+        auto counted = [&](const char* name, arrow::Status (ArrowOLAPAnalyzer::*analysis)()) -> arrow::Status {
+            olap::PerfCounterScope counters;
+            ARROW_RETURN_NOT_OK((this->*analysis)());
+            if (counters.enabled()) {
+                std::cout << "Hardware counters (" << name
+                          << "): " << counters.stats().ToString(sales_table_->num_rows()) << "\n";
+            }
+            return arrow::Status::OK();
+        };
+        if (run_native_) {
+            ARROW_RETURN_NOT_OK(counted("time", &ArrowOLAPAnalyzer::AnalyzeSalesByTime));
+            ARROW_RETURN_NOT_OK(counted("geography", &ArrowOLAPAnalyzer::AnalyzeSalesByGeography));
+            ARROW_RETURN_NOT_OK(counted("product", &ArrowOLAPAnalyzer::AnalyzeSalesByProduct));
+            ARROW_RETURN_NOT_OK(counted("customer", &ArrowOLAPAnalyzer::AnalyzeCustomerSegments));
+            ARROW_RETURN_NOT_OK(counted("multidimensional", &ArrowOLAPAnalyzer::MultidimensionalAnalysis));
+        }
+        if (run_acero_) {
+            ARROW_RETURN_NOT_OK(counted("acero", &ArrowOLAPAnalyzer::RunAceroAnalyses));
+        }
+        PrintLoadedColumns();
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        std::cout << "\nAll analyses completed in " << elapsed.count() << " milliseconds; peak RSS "
+                  << olap::PeakResidentSize() << "\n";
+        if (!olap::FinishTrace(std::cout)) {
+            return arrow::Status::IOError("Cannot write the trace to ", std::getenv("OLAP_TRACE"));
+        }
         
         std::cout << "\n" << std::string(50, '=') << "\n";
         std::cout << "Apache Arrow C++ analysis framework demonstrated!\n";
@@ -0,0 +1,106 @@
+#include "arrow_kernels.h"
+
+namespace olap {
+
+void InvalidateNulls(const arrow::Array& array, int32_t* codes) {
+    if (array.null_count() == 0) {
+        return;
+    }
+    const uint8_t* validity = array.null_bitmap_data();
+    const int64_t offset = array.offset();
+    for (int64_t i = 0; i < array.length(); ++i) {
+        if (!arrow::bit_util::GetBit(validity, offset + i)) {
+            codes[i] = kNoGroup;
+        }
+    }
+}
+
+void CombineGroupCodes(const int32_t* minor, int32_t minor_cardinality,
+                       int32_t* codes, int64_t length) {
+    for (int64_t i = 0; i < length; ++i) {
+        codes[i] = (codes[i] < 0 || minor[i] < 0)
+                       ? kNoGroup
+                       : codes[i] * minor_cardinality + minor[i];
+    }
+}
+
+namespace {
+
+template <typename T>
+void SumTyped(const T* values, int64_t length, const int32_t* codes,
+              double* sums, int64_t* counts) {
+    if (counts == nullptr) {
+        for (int64_t i = 0; i < length; ++i) {
+            if (codes[i] >= 0) {
+                sums[codes[i]] += static_cast<double>(values[i]);
+            }
+        }
+    } else {
+        for (int64_t i = 0; i < length; ++i) {
+            if (codes[i] >= 0) {
+                sums[codes[i]] += static_cast<double>(values[i]);
+                ++counts[codes[i]];
+            }
+        }
+    }
+}
+
+template <typename T, typename Sum>
+void AccumulateTyped(const T* values, const arrow::Array& array, const int32_t* codes,
+                     Sum* sums, int64_t* counts, double* mins, double* maxs, double* means, double* m2s) {
+    const uint8_t* validity = array.null_count() > 0 ? array.null_bitmap_data() : nullptr;
+    const int64_t offset = array.offset();
+    for (int64_t i = 0; i < array.length(); ++i) {
+        const int32_t group = codes[i];
+        if (group < 0 || (validity && !arrow::bit_util::GetBit(validity, offset + i))) {
+            continue;
+        }
+        const double value = static_cast<double>(values[i]);
+        sums[group] += values[i];
+        const double delta = value - means[group];
+        means[group] += delta / static_cast<double>(++counts[group]);
+        m2s[group] += delta * (value - means[group]);
+        mins[group] = value < mins[group] ? value : mins[group];
+        maxs[group] = value > maxs[group] ? value : maxs[group];
+    }
+}
+
+}  // namespace
+
+arrow::Status AccumulateByGroup(const arrow::Array& values, const int32_t* codes,
+                                double* sums, int64_t* integer_sums, int64_t* counts,
+                                double* mins, double* maxs, double* means, double* m2s) {
+    if (values.type_id() == arrow::Type::DOUBLE) {
+        const auto& doubles = static_cast<const arrow::DoubleArray&>(values);
+        AccumulateTyped(doubles.raw_values(), values, codes, sums, counts, mins, maxs, means, m2s);
+        return arrow::Status::OK();
+    }
+    return VisitIntegerValues(values, [&](const auto* ints) {
+        AccumulateTyped(ints, values, codes, integer_sums, counts, mins, maxs, means, m2s);
+        return arrow::Status::OK();
+    });
+}
+
+arrow::Status SumByGroup(const arrow::Array& values, const int32_t* codes,
+                         double* sums, int64_t* counts) {
+    if (values.type_id() == arrow::Type::DOUBLE) {
+        const auto& doubles = static_cast<const arrow::DoubleArray&>(values);
+        SumTyped(doubles.raw_values(), values.length(), codes, sums, counts);
+        return arrow::Status::OK();
+    }
+    return VisitIntegerValues(values, [&](const auto* ints) {
+        SumTyped(ints, values.length(), codes, sums, counts);
+        return arrow::Status::OK();
+    });
+}
+
+arrow::Status GatherIntegers(const arrow::Array& array, int64_t* out) {
+    return VisitIntegerValues(array, [&](const auto* values) {
+        for (int64_t i = 0; i < array.length(); ++i) {
+            out[i] = static_cast<int64_t>(values[i]);
+        }
+        return arrow::Status::OK();
+    });
+}
+
+}  // namespace olap
@@ -0,0 +1,1057 @@
+#include "acero_plan.h"
+#include "arrow_kernels.h"
+#include "chunked_column.h"
+#include "dimension_index.h"
+#include "distinct_count.h"
+#include "fused_aggregate.h"
+#include "hash_aggregator.h"
+#include "memory_pool.h"
+#include "morsel_executor.h"
+#include "parquet_source.h"
+#include "partitioned_dataset.h"
+#include "tdigest.h"
+#include <arrow/compute/api.h>
+#include <arrow/api.h>
+#include <arrow/array/concatenate.h>
+#include <arrow/io/file.h>
+#include <arrow/util/byte_size.h>
+#include <arrow/util/thread_pool.h>
+#include <parquet/arrow/reader.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Microbenchmarks for the building blocks of the Arrow OLAP analyzer.
+ *
+ * Usage: arrow_microbench <benchmark> [data_dir]
+ *   kernels   per-row GetScalar aggregation vs typed raw-buffer kernels
+ *   columns   Concatenate-per-access column reads vs zero-copy chunked views
+ *   decode    Parquet decode throughput (GB/s) against the number of threads
+ *   mmap      read-syscall vs memory-mapped input, cold and warm page cache
+ *   fused     separate arrow::compute aggregate passes vs one fused pass
+ *   prune     selective scans with and without row-group statistics pruning
+ *   quantiles exact percentiles vs single and merged t-digests
+ *   morsels   region x category rollup scaling with the number of worker threads
+ *   distinct  per-group distinct counts: hash sets vs roaring bitmaps vs HyperLogLog
+ *   acero     eager compute calls and hand-written kernels vs Acero execution plans
+ *   dataset   partitioned fact_sales directory: full vs partition-pruned scans
+ *   pools     rollup time and Arrow allocations on the system, jemalloc and mimalloc pools
+ *
+ * data_dir defaults to $OLAP_DATA_PATH, then "olap_data".
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+arrow::Result<std::shared_ptr<arrow::Table>> ReadParquet(const std::string& path) {
+    parquet::arrow::FileReaderBuilder builder;
+    ARROW_RETURN_NOT_OK(builder.OpenFile(path));
+    std::unique_ptr<parquet::arrow::FileReader> reader;
+    ARROW_RETURN_NOT_OK(builder.Build(&reader));
+    return reader->ReadTable();
+}
+
+arrow::Result<std::shared_ptr<arrow::Array>> Column(const std::shared_ptr<arrow::Table>& table,
+                                                    const std::string& name) {
+    auto column = table->GetColumnByName(name);
+    if (!column) {
+        return arrow::Status::Invalid("Column '" + name + "' not found");
+    }
+    return arrow::Concatenate(column->chunks());
+}
+
+// Runs fn `iterations` times and returns the best wall time in seconds.
+double BestOf(int iterations, const std::function<arrow::Status()>& fn, arrow::Status& status) {
+    double best = 1e300;
+    for (int i = 0; i < iterations && status.ok(); ++i) {
+        auto start = Clock::now();
+        status = fn();
+        best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+void Report(const std::string& label, int64_t rows, double seconds) {
+    std::cout << std::setw(28) << std::left << label << std::right
+              << std::setw(12) << std::fixed << std::setprecision(1) << seconds * 1e3 << " ms"
+              << std::setw(16) << std::setprecision(2) << rows / seconds / 1e6 << " Mrows/s\n";
+}
+
+int64_t ScalarKey(const std::shared_ptr<arrow::Scalar>& scalar) {
+    if (scalar->type->id() == arrow::Type::INT64) {
+        return std::static_pointer_cast<arrow::Int64Scalar>(scalar)->value;
+    }
+    return std::static_pointer_cast<arrow::Int32Scalar>(scalar)->value;
+}
+
+// Customer segment aggregation as originally written: one Scalar per cell.
+arrow::Status ScalarSegments(const arrow::Array& customer_keys, const arrow::Array& gross_sales,
+                             const arrow::Array& profit,
+                             const std::unordered_map<int64_t, std::string>& cust_to_type,
+                             double& checksum) {
+    std::map<std::string, std::vector<double>> type_sales, type_profit;
+    std::map<std::string, std::set<int64_t>> unique_customers;
+
+    for (int64_t i = 0; i < customer_keys.length(); ++i) {
+        ARROW_ASSIGN_OR_RAISE(auto cust_scalar, customer_keys.GetScalar(i));
+        ARROW_ASSIGN_OR_RAISE(auto sales_scalar, gross_sales.GetScalar(i));
+        ARROW_ASSIGN_OR_RAISE(auto profit_scalar, profit.GetScalar(i));
+        if (!cust_scalar->is_valid || !sales_scalar->is_valid || !profit_scalar->is_valid) {
+            continue;
+        }
+        auto type_it = cust_to_type.find(ScalarKey(cust_scalar));
+        if (type_it == cust_to_type.end()) {
+            continue;
+        }
+        type_sales[type_it->second].push_back(
+            std::static_pointer_cast<arrow::DoubleScalar>(sales_scalar)->value);
+        type_profit[type_it->second].push_back(
+            std::static_pointer_cast<arrow::DoubleScalar>(profit_scalar)->value);
+        unique_customers[type_it->second].insert(ScalarKey(cust_scalar));
+    }
+
+    checksum = 0;
+    for (const auto& [type, sales] : type_sales) {
+        for (double value : sales) {
+            checksum += value;
+        }
+    }
+    return arrow::Status::OK();
+}
+
+// The same aggregation through the typed kernels, batch by batch.
+arrow::Status KernelSegments(const arrow::Table& facts,
+                             const std::unordered_map<int64_t, int32_t>& cust_to_code,
+                             size_t num_types, double& checksum) {
+    auto lookup = [&](int64_t key) {
+        auto it = cust_to_code.find(key);
+        return it == cust_to_code.end() ? olap::kNoGroup : it->second;
+    };
+    olap::GroupSums sales(num_types), profit(num_types);
+    std::vector<std::set<int64_t>> unique_customers(num_types);
+    std::vector<int32_t> codes;
+    std::vector<int64_t> keys;
+
+    ARROW_RETURN_NOT_OK(olap::ForEachBatch(facts, olap::kDefaultBatchRows,
+                                           [&](const arrow::RecordBatch& batch) {
+        codes.resize(batch.num_rows());
+        keys.resize(batch.num_rows());
+        ARROW_RETURN_NOT_OK(olap::LookupGroupCodes(*batch.column(0), lookup, codes.data()));
+        olap::InvalidateNulls(*batch.column(1), codes.data());
+        olap::InvalidateNulls(*batch.column(2), codes.data());
+        ARROW_RETURN_NOT_OK(olap::SumByGroup(*batch.column(1), codes.data(),
+                                             sales.sum.data(), sales.count.data()));
+        ARROW_RETURN_NOT_OK(olap::SumByGroup(*batch.column(2), codes.data(),
+                                             profit.sum.data(), nullptr));
+        ARROW_RETURN_NOT_OK(olap::GatherIntegers(*batch.column(0), keys.data()));
+        for (int64_t i = 0; i < batch.num_rows(); ++i) {
+            if (codes[i] >= 0) {
+                unique_customers[codes[i]].insert(keys[i]);
+            }
+        }
+        return arrow::Status::OK();
+    }));
+
+    checksum = 0;
+    for (double value : sales.sum) {
+        checksum += value;
+    }
+    return arrow::Status::OK();
+}
+
+arrow::Status RunKernelBenchmark(const std::string& data_path) {
+    ARROW_ASSIGN_OR_RAISE(auto sales, ReadParquet(data_path + "/fact_sales.parquet"));
+    ARROW_ASSIGN_OR_RAISE(auto customers, ReadParquet(data_path + "/dim_customer.parquet"));
+
+    // Dimension lookups shared by both variants
+    ARROW_ASSIGN_OR_RAISE(auto dim_keys, Column(customers, "customer_key"));
+    ARROW_ASSIGN_OR_RAISE(auto dim_types, Column(customers, "customer_type"));
+    std::vector<int64_t> keys(dim_keys->length());
+    ARROW_RETURN_NOT_OK(olap::GatherIntegers(*dim_keys, keys.data()));
+    std::unordered_map<int64_t, std::string> cust_to_type;
+    std::unordered_map<std::string, int32_t> type_codes;
+    std::unordered_map<int64_t, int32_t> cust_to_code;
+    ARROW_RETURN_NOT_OK(olap::VisitStringValues(*dim_types, [&](int64_t i, std::string_view type) {
+        auto code = type_codes.emplace(std::string(type), static_cast<int32_t>(type_codes.size()));
+        cust_to_type[keys[i]] = std::string(type);
+        cust_to_code[keys[i]] = code.first->second;
+    }));
+
+    ARROW_ASSIGN_OR_RAISE(auto customer_keys, Column(sales, "customer_key"));
+    ARROW_ASSIGN_OR_RAISE(auto gross_sales, Column(sales, "gross_sales"));
+    ARROW_ASSIGN_OR_RAISE(auto profit, Column(sales, "profit"));
+    auto facts = arrow::Table::Make(
+        arrow::schema({arrow::field("customer_key", customer_keys->type()),
+                       arrow::field("gross_sales", gross_sales->type()),
+                       arrow::field("profit", profit->type())}),
+        {customer_keys, gross_sales, profit});
+
+    const int64_t rows = sales->num_rows();
+    std::cout << "Customer segment aggregation over " << rows << " rows\n";
+    std::cout << std::string(64, '-') << "\n";
+
+    // Both variants get the same repetitions, so neither gains from a warm cache
+    constexpr int kRepetitions = 5;
+    arrow::Status status;
+    double scalar_checksum = 0, kernel_checksum = 0;
+    double scalar_seconds = BestOf(kRepetitions, [&] {
+        return ScalarSegments(*customer_keys, *gross_sales, *profit, cust_to_type, scalar_checksum);
+    }, status);
+    ARROW_RETURN_NOT_OK(status);
+    Report("GetScalar per row", rows, scalar_seconds);
+
+    double kernel_seconds = BestOf(kRepetitions, [&] {
+        return KernelSegments(*facts, cust_to_code, type_codes.size(), kernel_checksum);
+    }, status);
+    ARROW_RETURN_NOT_OK(status);
+    Report("typed raw-buffer kernels", rows, kernel_seconds);
+
+    std::cout << "Speedup: " << std::setprecision(1) << scalar_seconds / kernel_seconds << "x"
+              << "  (checksum " << std::setprecision(2) << scalar_checksum << " vs "
+              << kernel_checksum << ")\n";
+    return arrow::Status::OK();
+}
+
+// Sums the measure columns the analyses read most, the way they read them:
+// each analysis fetches gross_sales and profit again.
+constexpr int kColumnAccesses = 3;
+
+arrow::Status SumColumns(const std::vector<arrow::Datum>& columns, double& checksum) {
+    checksum = 0;
+    for (const auto& column : columns) {
+        ARROW_ASSIGN_OR_RAISE(auto sum, arrow::compute::Sum(column));
+        checksum += std::static_pointer_cast<arrow::DoubleScalar>(sum.scalar())->value;
+    }
+    return arrow::Status::OK();
+}
+
+arrow::Status RunColumnBenchmark(const std::string& data_path) {
+    ARROW_ASSIGN_OR_RAISE(auto sales, ReadParquet(data_path + "/fact_sales.parquet"));
+    const std::vector<std::string> names = {"gross_sales", "profit"};
+    auto* pool = arrow::default_memory_pool();
+
+    const int64_t rows = sales->num_rows();
+    std::cout << "Column access over " << rows << " rows in "
+              << sales->column(0)->num_chunks() << " chunks (" << kColumnAccesses
+              << " reads of " << names.size() << " columns)\n";
+    std::cout << std::string(64, '-') << "\n";
+
+    arrow::Status status;
+    double concat_checksum = 0, view_checksum = 0;
+    int64_t concat_bytes = 0, view_bytes = 0;
+    double concat_seconds = BestOf(5, [&]() -> arrow::Status {
+        const int64_t before = pool->bytes_allocated();
+        std::vector<arrow::Datum> columns;
+        for (int access = 0; access < kColumnAccesses; ++access) {
+            for (const auto& name : names) {
+                ARROW_ASSIGN_OR_RAISE(auto column, Column(sales, name));
+                columns.emplace_back(column);
+            }
+        }
+        concat_bytes = pool->bytes_allocated() - before;
+        return SumColumns(columns, concat_checksum);
+    }, status);
+    ARROW_RETURN_NOT_OK(status);
+    Report("Concatenate per access", rows, concat_seconds);
+
+    double view_seconds = BestOf(5, [&]() -> arrow::Status {
+        const int64_t before = pool->bytes_allocated();
+        std::vector<arrow::Datum> columns;
+        for (int access = 0; access < kColumnAccesses; ++access) {
+            for (const auto& name : names) {
+                ARROW_ASSIGN_OR_RAISE(auto column, olap::ChunkedColumn::Make(*sales, name));
+                columns.push_back(column.datum());
+            }
+        }
+        view_bytes = pool->bytes_allocated() - before;
+        return SumColumns(columns, view_checksum);
+    }, status);
+    ARROW_RETURN_NOT_OK(status);
+    Report("ChunkedColumn view", rows, view_seconds);
+
+    std::cout << "Speedup: " << std::setprecision(1) << concat_seconds / view_seconds << "x"
+              << "  (extra memory " << concat_bytes / (1 << 20) << " MiB vs "
+              << view_bytes / (1 << 20) << " MiB)\n";
+    return arrow::Status::OK();
+}
+
+arrow::Status RunDecodeBenchmark(const std::string& data_path) {
+    const std::string path = data_path + "/fact_sales.parquet";
+    const double file_gb = std::filesystem::file_size(path) / 1e9;
+    ARROW_ASSIGN_OR_RAISE(auto probe, olap::ParquetSource::Open(path));
+
+    const int cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> thread_counts;
+    for (int threads = 1; threads < cores; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(cores);
+
+    std::cout << "Decoding " << path << " (" << probe->num_rows() << " rows, "
+              << probe->num_row_groups() << " row groups) on " << cores << " cores\n";
+    std::cout << std::setw(10) << "threads" << std::setw(14) << "time"
+              << std::setw(18) << "decoded GB/s" << std::setw(16) << "file GB/s" << "\n";
+    std::cout << std::string(58, '-') << "\n";
+
+    arrow::Status status;
+    for (int threads : thread_counts) {
+        // Arrow's CPU pool does the column-parallel decoding of single row groups
+        ARROW_RETURN_NOT_OK(arrow::SetCpuThreadPoolCapacity(threads));
+        olap::LoadOptions options;
+        options.threads = threads;
+        int64_t decoded_bytes = 0;
+        double seconds = BestOf(3, [&]() -> arrow::Status {
+            ARROW_ASSIGN_OR_RAISE(auto source, olap::ParquetSource::Open(path, options));
+            ARROW_ASSIGN_OR_RAISE(auto table, source->ReadTable());
+            decoded_bytes = arrow::util::TotalBufferSize(*table);
+            return arrow::Status::OK();
+        }, status);
+        ARROW_RETURN_NOT_OK(status);
+        std::cout << std::setw(10) << threads
+                  << std::setw(11) << std::fixed << std::setprecision(1) << seconds * 1e3 << " ms"
+                  << std::setw(18) << std::setprecision(2) << decoded_bytes / 1e9 / seconds
+                  << std::setw(16) << file_gb / seconds << "\n";
+    }
+    if (probe->num_row_groups() == 1) {
+        std::cout << "Single row group: scaling is limited to column-parallel decoding\n";
+    }
+    return arrow::Status::OK();
+}
+
+// Asks the kernel to drop the file's clean pages from the page cache.
+// Returns false when the hint could not be given.
+bool EvictFromPageCache(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool evicted = ::fdatasync(fd) == 0 && ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    ::close(fd);
+    return evicted;
+}
+
+arrow::Status RunMmapBenchmark(const std::string& data_path) {
+    const std::string path = data_path + "/fact_sales.parquet";
+    std::cout << "Reading " << path << " with read syscalls and memory mapping\n";
+    std::cout << std::setw(16) << "input" << std::setw(16) << "cold" << std::setw(16) << "warm" << "\n";
+    std::cout << std::string(48, '-') << "\n";
+
+    bool evicted = true;
+    for (bool memory_map : {false, true}) {
+        olap::LoadOptions options;
+        options.memory_map = memory_map;
+        auto read = [&]() -> arrow::Status {
+            ARROW_ASSIGN_OR_RAISE(auto source, olap::ParquetSource::Open(path, options));
+            return source->ReadTable().status();
+        };
+
+        arrow::Status status;
+        evicted &= EvictFromPageCache(path);
+        double cold = BestOf(1, read, status);
+        ARROW_RETURN_NOT_OK(status);
+        double warm = BestOf(5, read, status);
+        ARROW_RETURN_NOT_OK(status);
+        std::cout << std::setw(16) << (memory_map ? "MemoryMappedFile" : "ReadableFile")
+                  << std::setw(13) << std::fixed << std::setprecision(1) << cold * 1e3 << " ms"
+                  << std::setw(13) << warm * 1e3 << " ms\n";
+    }
+    if (!evicted) {
+        std::cout << "Page cache eviction failed; cold timings may be warm\n";
+    }
+    return arrow::Status::OK();
+}
+
+// The time analysis summary: seven arrow::compute passes (one of them over a
+// materialized margin array) against one fused pass
+arrow::Status RunFusedBenchmark(const std::string& data_path) {
+    ARROW_ASSIGN_OR_RAISE(auto sales, ReadParquet(data_path + "/fact_sales.parquet"));
+    ARROW_ASSIGN_OR_RAISE(sales, sales->SelectColumns({sales->schema()->GetFieldIndex("gross_sales"),
+                                                       sales->schema()->GetFieldIndex("profit"),
+                                                       sales->schema()->GetFieldIndex("quantity")}));
+    arrow::Datum gross_sales(sales->GetColumnByName("gross_sales"));
+    arrow::Datum profit(sales->GetColumnByName("profit"));
+    arrow::Datum quantity(sales->GetColumnByName("quantity"));
+
+    const int64_t rows = sales->num_rows();
+    std::cout << "Time analysis summary aggregates over " << rows << " rows\n";
+    std::cout << std::string(64, '-') << "\n";
+
+    arrow::Status status;
+    double compute_margin = 0, fused_margin = 0;
+    double compute_seconds = BestOf(5, [&]() -> arrow::Status {
+        ARROW_RETURN_NOT_OK(arrow::compute::Sum(gross_sales).status());
+        ARROW_RETURN_NOT_OK(arrow::compute::Sum(profit).status());
+        ARROW_RETURN_NOT_OK(arrow::compute::Sum(quantity).status());
+        ARROW_RETURN_NOT_OK(arrow::compute::Count(gross_sales).status());
+        ARROW_RETURN_NOT_OK(arrow::compute::MinMax(gross_sales).status());
+        ARROW_ASSIGN_OR_RAISE(auto margin, arrow::compute::Divide(profit, gross_sales));
+        ARROW_ASSIGN_OR_RAISE(auto mean, arrow::compute::Mean(margin));
+        compute_margin = std::static_pointer_cast<arrow::DoubleScalar>(mean.scalar())->value;
+        return arrow::Status::OK();
+    }, status);
+    ARROW_RETURN_NOT_OK(status);
+    Report("separate compute passes", rows, compute_seconds);
+
+    double fused_seconds = BestOf(5, [&]() -> arrow::Status {
+        using olap::AggregateKind;
+        ARROW_ASSIGN_OR_RAISE(auto summary, olap::FusedAggregator::Make(*sales->schema(), {
+            {"records", AggregateKind::kCount, "gross_sales"},
+            {"gross_sales", AggregateKind::kSum, "gross_sales"},
+            {"profit", AggregateKind::kSum, "profit"},
+            {"quantity", AggregateKind::kSum, "quantity"},
+            {"min_sale", AggregateKind::kMin, "gross_sales"},
+            {"max_sale", AggregateKind::kMax, "gross_sales"},
+            {"margin", AggregateKind::kRatioMean, "profit", "gross_sales"}}));
+        ARROW_RETURN_NOT_OK(olap::ForEachBatch(*sales, olap::kDefaultBatchRows,
+                                               [&](const arrow::RecordBatch& batch) {
+                                                   return summary->Consume(batch);
+                                               }));
+        fused_margin = summary->Value("margin");
+        return arrow::Status::OK();
+    }, status);
+    ARROW_RETURN_NOT_OK(status);
+    Report("fused single pass", rows, fused_seconds);
+
+    std::cout << "Speedup: " << std::setprecision(1) << compute_seconds / fused_seconds << "x"
+              << "  (mean margin " << std::setprecision(6) << compute_margin << " vs "
+              << fused_margin << ")\n";
+    return arrow::Status::OK();
+}
+
+// Selective scans (gross_sales > threshold) at decreasing selectivity: full
+// decode vs reading only the row groups that survive statistics pruning
+arrow::Status RunPruneBenchmark(const std::string& data_path) {
+    const std::string path = data_path + "/fact_sales.parquet";
+    ARROW_ASSIGN_OR_RAISE(auto source, olap::ParquetSource::Open(path));
+    ARROW_ASSIGN_OR_RAISE(auto sales, source->ReadTable({"gross_sales"}));
+    arrow::compute::QuantileOptions quantile_options({0.0, 0.5, 0.9, 0.99});
+    ARROW_ASSIGN_OR_RAISE(auto quantiles, arrow::compute::Quantile(sales->column(0), quantile_options));
+    auto thresholds = std::static_pointer_cast<arrow::DoubleArray>(quantiles.make_array());
+
+    const int64_t rows = source->num_rows();
+    std::cout << "Scanning gross_sales, profit where gross_sales > t in " << path << " ("
+              << source->num_row_groups() << " row groups)\n";
+    std::cout << std::string(64, '-') << "\n";
+
+    const std::vector<std::string> columns = {"gross_sales", "profit"};
+    auto count_matches = [&](const std::shared_ptr<arrow::Table>& table, double threshold,
+                             int64_t& matches) -> arrow::Status {
+        ARROW_ASSIGN_OR_RAISE(auto mask, arrow::compute::CallFunction(
+                                             "greater", {table->GetColumnByName("gross_sales"),
+                                                         arrow::MakeScalar(threshold)}));
+        ARROW_ASSIGN_OR_RAISE(auto filtered, arrow::compute::Filter(table, mask));
+        matches = filtered.table()->num_rows();
+        return arrow::Status::OK();
+    };
+
+    arrow::Status status;
+    const char* labels[] = {"p0", "p50", "p90", "p99"};
+    for (int64_t q = 0; q < thresholds->length(); ++q) {
+        const double threshold = thresholds->Value(q);
+        int64_t full_matches = 0, pruned_matches = 0;
+        olap::PruneStats stats;
+
+        double full_seconds = BestOf(3, [&]() -> arrow::Status {
+            ARROW_ASSIGN_OR_RAISE(auto table, source->ReadTable(columns));
+            return count_matches(table, threshold, full_matches);
+        }, status);
+        ARROW_RETURN_NOT_OK(status);
+        double pruned_seconds = BestOf(3, [&]() -> arrow::Status {
+            ARROW_ASSIGN_OR_RAISE(auto row_groups, source->PruneRowGroups(
+                {{"gross_sales", olap::CompareOp::kGreater, threshold}}, &stats));
+            ARROW_ASSIGN_OR_RAISE(auto table, source->ReadRowGroups(row_groups, columns));
+            return count_matches(table, threshold, pruned_matches);
+        }, status);
+        ARROW_RETURN_NOT_OK(status);
+        if (full_matches != pruned_matches) {
+            return arrow::Status::Invalid("Pruned scan matched ", pruned_matches, " rows, full scan ",
+                                          full_matches);
+        }
+
+        std::cout << "> " << labels[q] << ": " << full_matches << " matching rows, "
+                  << stats.row_groups - stats.skipped() << " of " << stats.row_groups
+                  << " row groups read\n";
+        Report("  full scan", rows, full_seconds);
+        Report("  pruned scan", rows, pruned_seconds);
+    }
+    std::cout << "Row groups are only skipped when gross_sales is sorted or clustered in the file\n";
+    return arrow::Status::OK();
+}
+
+// Percentiles of gross_sales: exact arrow::compute::Quantile against a
+// t-digest built in one pass, and one built as per-batch digests that are
+// merged (as per-thread digests would be), at several compressions
+arrow::Status RunQuantileBenchmark(const std::string& data_path) {
+    ARROW_ASSIGN_OR_RAISE(auto sales, ReadParquet(data_path + "/fact_sales.parquet"));
+    auto gross_sales = sales->GetColumnByName("gross_sales");
+    const std::vector<double> percentiles = {0.25, 0.5, 0.75, 0.95, 0.99};
+    const int64_t rows = sales->num_rows();
+    std::cout << "gross_sales percentiles over " << rows << " rows\n";
+    std::cout << std::string(64, '-') << "\n";
+
+    arrow::Status status;
+    std::vector<double> exact;
+    double exact_seconds = BestOf(3, [&]() -> arrow::Status {
+        arrow::compute::QuantileOptions options;
+        options.q = percentiles;
+        ARROW_ASSIGN_OR_RAISE(auto result, arrow::compute::Quantile(gross_sales, options));
+        auto values = std::static_pointer_cast<arrow::DoubleArray>(result.make_array());
+        exact.assign(values->raw_values(), values->raw_values() + values->length());
+        return arrow::Status::OK();
+    }, status);
+    ARROW_RETURN_NOT_OK(status);
+    Report("exact Quantile", rows, exact_seconds);
+
+    // Rank error of an estimate, from the sorted column
+    ARROW_ASSIGN_OR_RAISE(auto values, Column(sales, "gross_sales"));
+    const auto& doubles = static_cast<const arrow::DoubleArray&>(*values);
+    std::vector<double> sorted(doubles.raw_values(), doubles.raw_values() + doubles.length());
+    std::sort(sorted.begin(), sorted.end());
+    auto rank_error = [&](double estimate, double q) {
+        const double rank = static_cast<double>(std::lower_bound(sorted.begin(), sorted.end(), estimate) -
+                                                sorted.begin());
+        return std::abs(rank / sorted.size() - q);
+    };
+
+    for (double compression : {50.0, 100.0, 200.0}) {
+        olap::TDigest single(compression), merged(compression);
+        double single_seconds = BestOf(3, [&]() -> arrow::Status {
+            single = olap::TDigest(compression);
+            for (const auto& chunk : gross_sales->chunks()) {
+                ARROW_RETURN_NOT_OK(single.Add(*chunk));
+            }
+            single.Quantile(0.5);
+            return arrow::Status::OK();
+        }, status);
+        ARROW_RETURN_NOT_OK(status);
+        double merged_seconds = BestOf(3, [&]() -> arrow::Status {
+            merged = olap::TDigest(compression);
+            return olap::ForEachBatch(*sales, olap::kDefaultBatchRows / 4, [&](const arrow::RecordBatch& batch) {
+                olap::TDigest part(compression);
+                ARROW_RETURN_NOT_OK(part.Add(*batch.GetColumnByName("gross_sales")));
+                merged.Merge(part);
+                return arrow::Status::OK();
+            });
+        }, status);
+        ARROW_RETURN_NOT_OK(status);
+
+        std::cout << "t-digest, compression " << std::setprecision(0) << compression << " ("
+                  << single.num_centroids()
+                  << " centroids)\n";
+        Report("  single digest", rows, single_seconds);
+        Report("  merged per-batch digests", rows, merged_seconds);
+        for (size_t i = 0; i < percentiles.size(); ++i) {
+            const double q = percentiles[i];
+            std::cout << "    " << std::setw(5) << olap::PercentileName(q) << std::setprecision(2)
+                      << "  exact " << std::setw(10) << exact[i]
+                      << "  single " << std::setw(10) << single.Quantile(q)
+                      << "  merged " << std::setw(10) << merged.Quantile(q)
+                      << std::setprecision(4) << "  rank error " << rank_error(single.Quantile(q), q) * 100
+                      << "% / " << rank_error(merged.Quantile(q), q) * 100
+                      << "% (bound " << single.MaxRankError(q) * 100 << "%)\n";
+        }
+    }
+    return arrow::Status::OK();
+}
+
+// Inner join of a fact morsel with one dimension attribute through its
+// key index: the matching fact rows plus the attribute as column `name`.
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> JoinAttribute(const arrow::RecordBatch& facts,
+                                                                 const std::string& key,
+                                                                 const olap::DimensionIndex& index,
+                                                                 const std::shared_ptr<arrow::Array>& attribute,
+                                                                 const std::string& name) {
+    std::vector<int64_t> left_rows, right_rows;
+    ARROW_RETURN_NOT_OK(index.Probe(*facts.GetColumnByName(key), 0, olap::JoinType::kInner,
+                                    left_rows, right_rows));
+    arrow::Int64Builder left_indices(olap::memory_pool()), right_indices(olap::memory_pool());
+    ARROW_RETURN_NOT_OK(left_indices.AppendValues(left_rows));
+    ARROW_RETURN_NOT_OK(right_indices.AppendValues(right_rows));
+    ARROW_ASSIGN_OR_RAISE(auto left, left_indices.Finish());
+    ARROW_ASSIGN_OR_RAISE(auto right, right_indices.Finish());
+    auto rows = arrow::RecordBatch::Make(facts.schema(), facts.num_rows(), facts.columns());
+    const auto take_options = arrow::compute::TakeOptions::Defaults();
+    ARROW_ASSIGN_OR_RAISE(auto matched, arrow::compute::Take(rows, left, take_options, olap::exec_context()));
+    ARROW_ASSIGN_OR_RAISE(auto values, arrow::compute::Take(attribute, right, take_options, olap::exec_context()));
+    auto batch = matched.record_batch();
+    return batch->AddColumn(batch->num_columns(), name, values.make_array());
+}
+
+// Star-schema inputs of the region x category rollup; attributes are
+// dictionary-encoded, as the analyzer reads them
+struct RollupInputs {
+    std::shared_ptr<arrow::Table> sales;
+    std::shared_ptr<arrow::Table> geography;
+    std::shared_ptr<arrow::Table> product;
+    std::shared_ptr<olap::DimensionIndex> geography_index;
+    std::shared_ptr<olap::DimensionIndex> product_index;
+    std::shared_ptr<arrow::Array> regions;
+    std::shared_ptr<arrow::Array> categories;
+};
+
+arrow::Result<RollupInputs> LoadRollupInputs(const std::string& data_path) {
+    RollupInputs inputs;
+    ARROW_ASSIGN_OR_RAISE(auto source, olap::ParquetSource::Open(data_path + "/fact_sales.parquet"));
+    ARROW_ASSIGN_OR_RAISE(inputs.sales, source->ReadTable({"geography_key", "product_key", "gross_sales"}));
+    olap::LoadOptions dimension_options;
+    dimension_options.read_dictionary = true;
+    ARROW_ASSIGN_OR_RAISE(auto geography_source, olap::ParquetSource::Open(data_path + "/dim_geography.parquet",
+                                                                          dimension_options));
+    ARROW_ASSIGN_OR_RAISE(auto product_source, olap::ParquetSource::Open(data_path + "/dim_product.parquet",
+                                                                        dimension_options));
+    ARROW_ASSIGN_OR_RAISE(inputs.geography, geography_source->ReadTable({"geography_key", "region"}));
+    ARROW_ASSIGN_OR_RAISE(inputs.product, product_source->ReadTable({"product_key", "category"}));
+    ARROW_ASSIGN_OR_RAISE(inputs.geography_index, olap::DimensionIndex::Make(*inputs.geography, "geography_key"));
+    ARROW_ASSIGN_OR_RAISE(inputs.product_index, olap::DimensionIndex::Make(*inputs.product, "product_key"));
+    ARROW_ASSIGN_OR_RAISE(inputs.regions, Column(inputs.geography, "region"));
+    ARROW_ASSIGN_OR_RAISE(inputs.categories, Column(inputs.product, "category"));
+    return inputs;
+}
+
+// The multidimensional analysis: star join, then a (region, category)
+// hash aggregation into per-worker tables merged at the end
+arrow::Result<std::shared_ptr<arrow::Table>> NativeRollup(const RollupInputs& inputs,
+                                                          const olap::MorselExecutor& executor) {
+    arrow::SchemaBuilder joined_schema;
+    ARROW_RETURN_NOT_OK(joined_schema.AddSchema(inputs.sales->schema()));
+    ARROW_RETURN_NOT_OK(joined_schema.AddField(arrow::field("region", inputs.regions->type())));
+    ARROW_RETURN_NOT_OK(joined_schema.AddField(arrow::field("category", inputs.categories->type())));
+    ARROW_ASSIGN_OR_RAISE(auto schema, joined_schema.Finish());
+    std::vector<std::unique_ptr<olap::HashAggregator>> aggregators;
+    for (int worker = 0; worker < executor.num_threads(); ++worker) {
+        ARROW_ASSIGN_OR_RAISE(auto aggregator,
+                              olap::HashAggregator::Make(*schema, {"region", "category"}, {"gross_sales"}));
+        aggregators.push_back(std::move(aggregator));
+    }
+    ARROW_RETURN_NOT_OK(executor.Run(*inputs.sales, [&](int worker, const arrow::RecordBatch& morsel) {
+        ARROW_ASSIGN_OR_RAISE(auto by_region, JoinAttribute(morsel, "geography_key", *inputs.geography_index,
+                                                            inputs.regions, "region"));
+        ARROW_ASSIGN_OR_RAISE(auto joined, JoinAttribute(*by_region, "product_key", *inputs.product_index,
+                                                         inputs.categories, "category"));
+        return aggregators[worker]->Consume(*joined);
+    }));
+    for (size_t worker = 1; worker < aggregators.size(); ++worker) {
+        ARROW_RETURN_NOT_OK(aggregators[0]->Merge(*aggregators[worker]));
+    }
+    return aggregators[0]->Finish();
+}
+
+arrow::Result<double> SumColumn(const std::shared_ptr<arrow::Table>& table, const std::string& name) {
+    ARROW_ASSIGN_OR_RAISE(auto total, arrow::compute::Sum(table->GetColumnByName(name)));
+    return total.scalar_as<arrow::DoubleScalar>().value;
+}
+
+arrow::Status RunMorselBenchmark(const std::string& data_path) {
+    ARROW_ASSIGN_OR_RAISE(auto inputs, LoadRollupInputs(data_path));
+    const int64_t rows = inputs.sales->num_rows();
+
+    // Up to one thread per core, or OLAP_EXEC_THREADS to chart past it
+    const int cores = std::max(1u, std::thread::hardware_concurrency());
+    const auto configured = olap::MorselExecutor::FromEnvironment();
+    const int max_threads = configured.num_threads();
+    std::vector<int> thread_counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    std::cout << "Region x category rollup of " << rows << " rows, morsels of "
+              << configured.morsel_rows() << " rows, " << cores << " cores\n";
+    std::cout << std::setw(10) << "threads" << std::setw(14) << "time" << std::setw(16) << "Mrows/s"
+              << std::setw(12) << "speedup" << std::setw(14) << "efficiency" << std::setw(10) << "groups" << "\n";
+    std::cout << std::string(76, '-') << "\n";
+
+    arrow::Status status;
+    double serial_seconds = 0;
+    double serial_total = 0;
+    for (int threads : thread_counts) {
+        olap::MorselExecutor executor(threads, configured.morsel_rows());
+        std::shared_ptr<arrow::Table> result;
+        double seconds = BestOf(3, [&]() -> arrow::Status {
+            ARROW_ASSIGN_OR_RAISE(result, NativeRollup(inputs, executor));
+            return arrow::Status::OK();
+        }, status);
+        ARROW_RETURN_NOT_OK(status);
+        ARROW_ASSIGN_OR_RAISE(const double checksum, SumColumn(result, "gross_sales_sum"));
+        if (threads == 1) {
+            serial_seconds = seconds;
+            serial_total = checksum;
+        } else if (std::abs(checksum - serial_total) > 1e-9 * std::abs(serial_total)) {
+            return arrow::Status::Invalid("Parallel rollup total ", checksum, " differs from ", serial_total);
+        }
+        std::cout << std::setw(10) << threads
+                  << std::setw(11) << std::fixed << std::setprecision(1) << seconds * 1e3 << " ms"
+                  << std::setw(16) << std::setprecision(2) << rows / seconds / 1e6
+                  << std::setw(11) << serial_seconds / seconds << "x"
+                  << std::setw(13) << std::setprecision(0) << 100 * serial_seconds / seconds / threads << "%"
+                  << std::setw(10) << result->num_rows() << "\n";
+    }
+    return arrow::Status::OK();
+}
+
+// The rollup on each of Arrow's allocators, with the bytes, allocation
+// calls and peak of its Arrow buffers
+arrow::Status RunPoolBenchmark(const std::string& data_path) {
+    std::cout << "Region x category rollup per memory pool (inputs loaded first, not counted)\n";
+    std::cout << std::setw(10) << "pool" << std::setw(14) << "time" << std::setw(14) << "allocated"
+              << std::setw(14) << "allocations" << std::setw(14) << "peak" << "\n";
+    std::cout << std::string(66, '-') << "\n";
+    const auto executor = olap::MorselExecutor::FromEnvironment();
+    for (const std::string backend : {"system", "jemalloc", "mimalloc"}) {
+        // Every buffer of the previous backend is released by now
+        auto selected = olap::SelectMemoryPool(backend);
+        if (!selected.ok()) {
+            std::cout << std::setw(10) << backend << "  unavailable: " << selected.message() << "\n";
+            continue;
+        }
+        ARROW_ASSIGN_OR_RAISE(auto inputs, LoadRollupInputs(data_path));
+        arrow::Status status;
+        olap::AllocationStats allocations;
+        double seconds = BestOf(3, [&]() -> arrow::Status {
+            olap::AllocationScope scope;
+            ARROW_ASSIGN_OR_RAISE(auto result, NativeRollup(inputs, executor));
+            allocations = scope.stats();
+            return arrow::Status::OK();
+        }, status);
+        ARROW_RETURN_NOT_OK(status);
+        std::cout << std::setw(10) << backend
+                  << std::setw(11) << std::fixed << std::setprecision(1) << seconds * 1e3 << " ms"
+                  << std::setw(11) << allocations.bytes_allocated / 1048576.0 << " MB"
+                  << std::setw(14) << allocations.allocations
+                  << std::setw(11) << allocations.peak_bytes / 1048576.0 << " MB\n";
+    }
+    return arrow::Status::OK();
+}
+
+// The same queries three ways: eager arrow::compute calls that materialize
+// every intermediate array, the hand-written kernels the analyzer uses, and
+// an Acero plan that pipelines batches through its nodes on the CPU pool
+arrow::Status RunAceroBenchmark(const std::string& data_path) {
+    namespace cp = arrow::compute;
+    ARROW_ASSIGN_OR_RAISE(auto source, olap::ParquetSource::Open(data_path + "/fact_sales.parquet"));
+    ARROW_ASSIGN_OR_RAISE(auto sales, source->ReadTable({"gross_sales", "profit"}));
+    const int64_t rows = sales->num_rows();
+    arrow::Status status;
+
+    std::cout << "High-value sales (gross_sales > 100): filter, margin = profit / gross_sales, sums and mean\n";
+    std::cout << std::string(64, '-') << "\n";
+    double eager_total = 0;
+    double eager_seconds = BestOf(3, [&]() -> arrow::Status {
+        auto gross_sales = sales->GetColumnByName("gross_sales");
+        ARROW_ASSIGN_OR_RAISE(auto mask, cp::CallFunction("greater", {gross_sales, arrow::Datum(100.0)}));
+        ARROW_ASSIGN_OR_RAISE(auto high_sales, cp::CallFunction("filter", {gross_sales, mask}));
+        ARROW_ASSIGN_OR_RAISE(auto high_profit, cp::CallFunction("filter", {sales->GetColumnByName("profit"), mask}));
+        ARROW_ASSIGN_OR_RAISE(auto margin, cp::Divide(high_profit, high_sales));
+        ARROW_ASSIGN_OR_RAISE(auto total, cp::Sum(high_sales));
+        ARROW_RETURN_NOT_OK(cp::Sum(high_profit).status());
+        ARROW_RETURN_NOT_OK(cp::Mean(margin).status());
+        eager_total = total.scalar_as<arrow::DoubleScalar>().value;
+        return arrow::Status::OK();
+    }, status);
+    ARROW_RETURN_NOT_OK(status);
+    Report("eager compute calls", rows, eager_seconds);
+
+    double kernel_total = 0, kernel_profit = 0, kernel_margin = 0;
+    double kernel_seconds = BestOf(3, [&]() -> arrow::Status {
+        double total = 0, profit_total = 0, margin_total = 0;
+        int64_t count = 0;
+        auto gross_sales = sales->GetColumnByName("gross_sales");
+        auto profit = sales->GetColumnByName("profit");
+        for (int c = 0; c < gross_sales->num_chunks(); ++c) {
+            const double* sales_values = static_cast<const arrow::DoubleArray&>(*gross_sales->chunk(c)).raw_values();
+            const double* profit_values = static_cast<const arrow::DoubleArray&>(*profit->chunk(c)).raw_values();
+            for (int64_t i = 0; i < gross_sales->chunk(c)->length(); ++i) {
+                if (sales_values[i] > 100.0) {
+                    total += sales_values[i];
+                    profit_total += profit_values[i];
+                    margin_total += profit_values[i] / sales_values[i];
+                    ++count;
+                }
+            }
+        }
+        kernel_total = total;
+        kernel_profit = profit_total;
+        kernel_margin = count > 0 ? margin_total / count : 0;
+        return arrow::Status::OK();
+    }, status);
+    ARROW_RETURN_NOT_OK(status);
+    Report("hand-written loop", rows, kernel_seconds);
+    std::cout << "  profit " << std::setprecision(2) << kernel_profit << ", mean margin "
+              << std::setprecision(4) << kernel_margin << "\n";
+
+    double plan_total = 0;
+    double plan_seconds = BestOf(3, [&]() -> arrow::Status {
+        auto plan = olap::Aggregate(
+            arrow::acero::Declaration::Sequence(
+                {olap::TableSource(sales),
+                 {"filter", arrow::acero::FilterNodeOptions(cp::greater(cp::field_ref("gross_sales"),
+                                                                        cp::literal(100.0)))},
+                 {"project", arrow::acero::ProjectNodeOptions(
+                                 {cp::field_ref("gross_sales"), cp::field_ref("profit"),
+                                  cp::call("divide", {cp::field_ref("profit"), cp::field_ref("gross_sales")})},
+                                 {"gross_sales", "profit", "margin"})}}),
+            {{"sum", "gross_sales", "gross_sales"}, {"sum", "profit", "profit"}, {"mean", "margin", "margin"}});
+        ARROW_ASSIGN_OR_RAISE(auto result, olap::RunPlan(plan));
+        ARROW_ASSIGN_OR_RAISE(plan_total, SumColumn(result, "gross_sales"));
+        return arrow::Status::OK();
+    }, status);
+    ARROW_RETURN_NOT_OK(status);
+    Report("acero plan", rows, plan_seconds);
+    for (double total : {kernel_total, plan_total}) {
+        if (std::abs(total - eager_total) > 1e-9 * std::abs(eager_total)) {
+            return arrow::Status::Invalid("High-value total ", total, " differs from ", eager_total);
+        }
+    }
+
+    ARROW_ASSIGN_OR_RAISE(auto inputs, LoadRollupInputs(data_path));
+    const auto executor = olap::MorselExecutor::FromEnvironment();
+    std::cout << "\nRegion x category rollup (two hash joins, grouped sum), "
+              << executor.num_threads() << " worker threads\n";
+    std::cout << std::string(64, '-') << "\n";
+    double native_total = 0;
+    double native_seconds = BestOf(3, [&]() -> arrow::Status {
+        ARROW_ASSIGN_OR_RAISE(auto result, NativeRollup(inputs, executor));
+        ARROW_ASSIGN_OR_RAISE(native_total, SumColumn(result, "gross_sales_sum"));
+        return arrow::Status::OK();
+    }, status);
+    ARROW_RETURN_NOT_OK(status);
+    Report("index joins + HashAggregator", rows, native_seconds);
+
+    double rollup_total = 0;
+    double rollup_seconds = BestOf(3, [&]() -> arrow::Status {
+        auto joined = olap::JoinDimension(olap::JoinDimension(olap::TableSource(inputs.sales), inputs.geography,
+                                                              "geography_key"),
+                                          inputs.product, "product_key");
+        ARROW_ASSIGN_OR_RAISE(auto result, olap::RunPlan(olap::Aggregate(
+            std::move(joined), {{"hash_sum", "gross_sales", "gross_sales"}}, {"region", "category"})));
+        ARROW_ASSIGN_OR_RAISE(rollup_total, SumColumn(result, "gross_sales"));
+        return arrow::Status::OK();
+    }, status);
+    ARROW_RETURN_NOT_OK(status);
+    Report("acero plan", rows, rollup_seconds);
+    if (std::abs(rollup_total - native_total) > 1e-9 * std::abs(native_total)) {
+        return arrow::Status::Invalid("Acero rollup total ", rollup_total, " differs from ", native_total);
+    }
+    std::cout << "Acero runs on " << arrow::GetCpuThreadPoolCapacity() << " CPU pool threads\n";
+    return arrow::Status::OK();
+}
+
+// Scans of a hive-partitioned fact_sales directory: every file against a
+// one-year filter that prunes directories, single-threaded and file-parallel
+arrow::Status RunDatasetBenchmark(const std::string& data_path) {
+    const std::string directory = data_path + "/fact_sales";
+    if (!std::filesystem::is_directory(directory)) {
+        return arrow::Status::Invalid("No partitioned dataset at ", directory,
+                                      " (generate one with OLAP_PARTITION_FACTS=1)");
+    }
+    ARROW_ASSIGN_OR_RAISE(auto probe, olap::PartitionedDataset::Open(directory));
+    ARROW_ASSIGN_OR_RAISE(auto years, probe->ReadTable({"year"}));
+    ARROW_ASSIGN_OR_RAISE(auto last_year, arrow::compute::MinMax(years->column(0)));
+    const auto& max_year = last_year.scalar_as<arrow::StructScalar>().value[1];
+    const std::vector<std::pair<std::string, arrow::compute::Expression>> filters = {
+        {"all files", arrow::compute::literal(true)},
+        {"year = " + max_year->ToString(),
+         arrow::compute::equal(arrow::compute::field_ref("year"), arrow::compute::literal(max_year))}};
+
+    const int cores = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "gross_sales, profit from " << directory << " (" << probe->num_files() << " files, "
+              << cores << " cores)\n";
+    std::cout << std::string(64, '-') << "\n";
+    arrow::Status status;
+    for (int threads : std::set<int>{1, cores}) {
+        olap::LoadOptions options;
+        options.threads = threads;
+        ARROW_ASSIGN_OR_RAISE(auto dataset, olap::PartitionedDataset::Open(directory, options));
+        for (const auto& [label, filter] : filters) {
+            ARROW_RETURN_NOT_OK(dataset->SetFilter(filter));
+            double seconds = BestOf(3, [&]() {
+                return dataset->ReadTable({"gross_sales", "profit"}).status();
+            }, status);
+            ARROW_RETURN_NOT_OK(status);
+            Report(label + ", " + std::to_string(threads) + (threads == 1 ? " thread" : " threads"),
+                   dataset->num_rows(), seconds);
+            std::cout << "    " << dataset->num_selected_files() << " of " << dataset->num_files()
+                      << " files scanned\n";
+        }
+    }
+    return arrow::Status::OK();
+}
+
+// Distinct values of one column per group of another: a hash set per group
+// against exact roaring-bitmap counters, approximate counters (HyperLogLog
+// past the sketch size) and approximate counters built per batch and merged.
+// Memory is the counters' footprint; for the hash sets it is estimated from
+// their node and bucket counts.
+arrow::Status RunDistinctBenchmark(const std::string& data_path) {
+    ARROW_ASSIGN_OR_RAISE(auto source, olap::ParquetSource::Open(data_path + "/fact_sales.parquet"));
+    ARROW_ASSIGN_OR_RAISE(auto sales, source->ReadTable({"sales_key", "product_key", "customer_key"}));
+    const int64_t rows = sales->num_rows();
+    auto gather = [&](const std::string& name) -> arrow::Result<std::vector<int64_t>> {
+        ARROW_ASSIGN_OR_RAISE(auto column, Column(sales, name));
+        std::vector<int64_t> values(column->length());
+        ARROW_RETURN_NOT_OK(olap::GatherIntegers(*column, values.data()));
+        return values;
+    };
+    ARROW_ASSIGN_OR_RAISE(auto product_keys, gather("product_key"));
+    ARROW_ASSIGN_OR_RAISE(auto customer_keys, gather("customer_key"));
+    ARROW_ASSIGN_OR_RAISE(auto sales_keys, gather("sales_key"));
+    const std::vector<int64_t> no_groups(rows, 0);
+
+    struct Case {
+        std::string label;
+        const std::vector<int64_t>* groups;
+        const std::vector<int64_t>* values;
+    };
+    const std::vector<Case> cases = {{"customer_key per product_key", &product_keys, &customer_keys},
+                                     {"sales_key", &no_groups, &sales_keys}};
+
+    arrow::Status status;
+    for (const auto& test : cases) {
+        const auto& groups = *test.groups;
+        const auto& values = *test.values;
+        std::cout << "Distinct " << test.label << " over " << rows << " rows\n";
+        std::cout << std::string(96, '-') << "\n";
+
+        std::unordered_map<int64_t, std::unordered_set<int64_t>> sets;
+        double set_seconds = BestOf(3, [&]() -> arrow::Status {
+            sets.clear();
+            for (int64_t i = 0; i < rows; ++i) {
+                sets[groups[i]].insert(values[i]);
+            }
+            return arrow::Status::OK();
+        }, status);
+        ARROW_RETURN_NOT_OK(status);
+        int64_t set_bytes = 0;
+        for (const auto& [group, set] : sets) {
+            set_bytes += static_cast<int64_t>(set.size() * (2 * sizeof(void*) + sizeof(int64_t)) +
+                                              set.bucket_count() * sizeof(void*));
+        }
+
+        // Counters of one group per entry; batch_rows > 0 builds them per
+        // batch of that many rows and merges each batch into the result
+        using Counters = std::unordered_map<int64_t, olap::DistinctCounter>;
+        auto count = [&](bool approximate, int64_t batch_rows, Counters& result) -> arrow::Status {
+            result.clear();
+            const int64_t step = batch_rows > 0 ? batch_rows : rows;
+            for (int64_t begin = 0; begin < rows; begin += step) {
+                Counters batch;
+                Counters& target = batch_rows > 0 ? batch : result;
+                for (int64_t i = begin; i < std::min(rows, begin + step); ++i) {
+                    auto it = target.try_emplace(groups[i], approximate).first;
+                    ARROW_RETURN_NOT_OK(it->second.Add(values[i]));
+                }
+                for (auto& [group, counter] : batch) {
+                    ARROW_RETURN_NOT_OK(result.try_emplace(group, approximate).first->second.Merge(counter));
+                }
+            }
+            return arrow::Status::OK();
+        };
+
+        std::cout << std::setw(28) << std::left << "variant" << std::right << std::setw(14) << "time"
+                  << std::setw(16) << "Mrows/s" << std::setw(14) << "memory" << std::setw(12) << "sketched"
+                  << std::setw(12) << "max error" << "\n";
+        auto report = [&](const std::string& label, double seconds, int64_t bytes, int64_t sketched,
+                          double max_error) {
+            std::cout << std::setw(28) << std::left << label << std::right
+                      << std::setw(11) << std::fixed << std::setprecision(1) << seconds * 1e3 << " ms"
+                      << std::setw(16) << std::setprecision(2) << rows / seconds / 1e6
+                      << std::setw(11) << std::setprecision(1) << bytes / 1024.0 << " KB"
+                      << std::setw(12) << sketched
+                      << std::setw(11) << std::setprecision(2) << max_error * 100 << "%\n";
+        };
+        report("hash sets", set_seconds, set_bytes, 0, 0);
+
+        const std::vector<std::tuple<std::string, bool, int64_t>> variants = {
+            {"roaring bitmaps", false, 0},
+            {"roaring + HyperLogLog", true, 0},
+            {"merged per-batch counters", true, olap::kDefaultBatchRows / 4}};
+        for (const auto& [label, approximate, batch_rows] : variants) {
+            Counters counters;
+            double seconds = BestOf(3, [&]() { return count(approximate, batch_rows, counters); }, status);
+            ARROW_RETURN_NOT_OK(status);
+            int64_t bytes = 0;
+            int64_t sketched = 0;
+            double max_error = 0;
+            for (const auto& [group, counter] : counters) {
+                const double exact = static_cast<double>(sets.at(group).size());
+                bytes += counter.memory_bytes();
+                sketched += counter.exact() ? 0 : 1;
+                max_error = std::max(max_error, std::abs(counter.Count() - exact) / exact);
+            }
+            report(label, seconds, bytes, sketched, max_error);
+        }
+        std::cout << sets.size() << " groups; approximate counters sketch groups past "
+                  << (1 << olap::HyperLogLog::kDefaultPrecision) / 2 << " distinct values\n\n";
+    }
+    return arrow::Status::OK();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <kernels|columns|decode|mmap|fused|prune|quantiles|morsels|distinct|acero|dataset|pools> [data_dir]\n";
+        return 1;
+    }
+    std::string benchmark = argv[1];
+    std::string data_path = "olap_data";
+    if (std::getenv("OLAP_DATA_PATH")) {
+        data_path = std::getenv("OLAP_DATA_PATH");
+    }
+    if (argc > 2) {
+        data_path = argv[2];
+    }
+
+    arrow::Status status;
+    if (benchmark == "kernels") {
+        status = RunKernelBenchmark(data_path);
+    } else if (benchmark == "columns") {
+        status = RunColumnBenchmark(data_path);
+    } else if (benchmark == "decode") {
+        status = RunDecodeBenchmark(data_path);
+    } else if (benchmark == "mmap") {
+        status = RunMmapBenchmark(data_path);
+    } else if (benchmark == "fused") {
+        status = RunFusedBenchmark(data_path);
+    } else if (benchmark == "prune") {
+        status = RunPruneBenchmark(data_path);
+    } else if (benchmark == "quantiles") {
+        status = RunQuantileBenchmark(data_path);
+    } else if (benchmark == "morsels") {
+        status = RunMorselBenchmark(data_path);
+    } else if (benchmark == "distinct") {
+        status = RunDistinctBenchmark(data_path);
+    } else if (benchmark == "acero") {
+        status = RunAceroBenchmark(data_path);
+    } else if (benchmark == "dataset") {
+        status = RunDatasetBenchmark(data_path);
+    } else if (benchmark == "pools") {
+        status = RunPoolBenchmark(data_path);
+    } else {
+        std::cerr << "Unknown benchmark: " << benchmark << "\n";
+        return 1;
+    }
+
+    if (!status.ok()) {
+        std::cerr << "Benchmark failed: " << status.ToString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include "chunked_column.h"
+#include <algorithm>
+
+namespace olap {
+
+ChunkedColumn::ChunkedColumn() : ChunkedColumn(nullptr) {}
+
+ChunkedColumn::ChunkedColumn(std::shared_ptr<arrow::ChunkedArray> data)
+    : data_(data ? std::move(data) : std::make_shared<arrow::ChunkedArray>(arrow::ArrayVector{}, arrow::null())) {
+    offsets_.reserve(data_->num_chunks() + 1);
+    int64_t offset = 0;
+    offsets_.push_back(offset);
+    for (const auto& chunk : data_->chunks()) {
+        offset += chunk->length();
+        offsets_.push_back(offset);
+    }
+}
+
+arrow::Result<ChunkedColumn> ChunkedColumn::Make(const arrow::Table& table, const std::string& name) {
+    auto column = table.GetColumnByName(name);
+    if (!column) {
+        return arrow::Status::Invalid("Column '" + name + "' not found");
+    }
+    return ChunkedColumn(std::move(column));
+}
+
+std::pair<int, int64_t> ChunkedColumn::Locate(int64_t row) const {
+    // Last chunk starting at or before row; empty chunks share their start
+    auto it = std::upper_bound(offsets_.begin(), offsets_.end() - 1, row);
+    int chunk_index = static_cast<int>(it - offsets_.begin()) - 1;
+    return {chunk_index, row - offsets_[chunk_index]};
+}
+
+arrow::Result<std::shared_ptr<arrow::Scalar>> ChunkedColumn::GetScalar(int64_t row) const {
+    if (row < 0 || row >= length()) {
+        return arrow::Status::IndexError("Row ", row, " out of bounds for column of length ",
+                                         length());
+    }
+    auto [chunk_index, index] = Locate(row);
+    return chunk(chunk_index).GetScalar(index);
+}
+
+}  // namespace olap
@@ -0,0 +1,148 @@
+#include "cube_layout.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <sstream>
+
+namespace olap {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// FNV-1a, so fingerprints agree across builds and standard libraries
+void Hash(uint64_t& hash, const std::string& text) {
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 0x100000001B3ULL;
+    }
+}
+
+void AddFile(const fs::path& path, const fs::path& root, uint64_t& hash, int& files, uintmax_t& bytes) {
+    std::error_code error;
+    const uintmax_t size = fs::file_size(path, error);
+    const auto modified = fs::last_write_time(path, error);
+    if (error) {
+        Hash(hash, path.string() + ":missing;");
+        return;
+    }
+    Hash(hash, fs::relative(path, root).generic_string() + ":" + std::to_string(size) + ":" +
+                   std::to_string(modified.time_since_epoch().count()) + ";");
+    ++files;
+    bytes += size;
+}
+
+}  // namespace
+
+const std::vector<CubeHierarchy>& CubeHierarchies() {
+    static const std::vector<CubeHierarchy> hierarchies = {
+        {"time", "dim_time", "date_key", {"year", "quarter", "month"}},
+        {"geography", "dim_geography", "geography_key", {"region", "country", "city"}},
+        {"product", "dim_product", "product_key", {"category", "subcategory"}},
+        {"customer", "dim_customer", "customer_key", {"customer_type"}}};
+    return hierarchies;
+}
+
+const std::vector<std::string>& CubeMeasures() {
+    static const std::vector<std::string> measures = {"gross_sales", "profit", "quantity"};
+    return measures;
+}
+
+const std::vector<std::vector<std::string>>& CubeGroupingSets() {
+    static const std::vector<std::vector<std::string>> sets = [] {
+        std::vector<std::vector<std::string>> sets;
+        for (const auto& hierarchy : CubeHierarchies()) {
+            sets.push_back(hierarchy.levels);
+        }
+        sets.push_back({"year", "quarter", "month", "region", "category", "customer_type"});
+        return sets;
+    }();
+    return sets;
+}
+
+std::string GroupingSetName(const std::vector<std::string>& levels) {
+    std::string name;
+    for (const auto& level : levels) {
+        name += (name.empty() ? "" : ",") + level;
+    }
+    return name;
+}
+
+const std::vector<std::string>* FindGroupingSet(const std::vector<std::string>& levels) {
+    const std::vector<std::string>* best = nullptr;
+    for (const auto& set : CubeGroupingSets()) {
+        const bool covers = std::all_of(levels.begin(), levels.end(), [&](const std::string& level) {
+            return std::find(set.begin(), set.end(), level) != set.end();
+        });
+        if (covers && (!best || set.size() < best->size())) {
+            best = &set;
+        }
+    }
+    return best;
+}
+
+const CubeHierarchy* FindHierarchy(const std::string& level) {
+    for (const auto& hierarchy : CubeHierarchies()) {
+        if (std::find(hierarchy.levels.begin(), hierarchy.levels.end(), level) != hierarchy.levels.end()) {
+            return &hierarchy;
+        }
+    }
+    return nullptr;
+}
+
+bool FactYearsFromEnvironment(FactYears& years, std::string& error) {
+    years = FactYears();
+    const char* value = std::getenv("OLAP_FACT_YEARS");
+    if (!value || !*value) {
+        return true;
+    }
+    const std::string range = value;
+    const size_t dash = range.find('-');
+    const std::string first = range.substr(0, dash);
+    const std::string last = dash == std::string::npos ? first : range.substr(dash + 1);
+    // Digits only (no sign, no trailing text), short enough for an int
+    const auto is_year = [](const std::string& text) {
+        return !text.empty() && text.size() <= 9 && text.find_first_not_of("0123456789") == std::string::npos;
+    };
+    if (!is_year(first) || !is_year(last) || std::stoi(first) > std::stoi(last)) {
+        error = "OLAP_FACT_YEARS must be YEAR or FIRST-LAST, got '" + range + "'";
+        return false;
+    }
+    years.all = false;
+    years.first = std::stoi(first);
+    years.last = std::stoi(last);
+    return true;
+}
+
+std::string CubeSourceFingerprint(const std::string& data_path) {
+    const fs::path root(data_path);
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    int files = 0;
+    uintmax_t bytes = 0;
+    std::error_code error;
+    if (fs::is_directory(root / "fact_sales")) {
+        std::vector<fs::path> parts;
+        for (const auto& entry : fs::recursive_directory_iterator(root / "fact_sales", error)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".parquet") {
+                parts.push_back(entry.path());
+            }
+        }
+        std::sort(parts.begin(), parts.end());
+        for (const auto& part : parts) {
+            AddFile(part, root, hash, files, bytes);
+        }
+    } else {
+        AddFile(root / "fact_sales.parquet", root, hash, files, bytes);
+    }
+    for (const auto& hierarchy : CubeHierarchies()) {
+        AddFile(root / (hierarchy.table + ".parquet"), root, hash, files, bytes);
+    }
+    const char* years = std::getenv("OLAP_FACT_YEARS");
+    std::ostringstream fingerprint;
+    fingerprint << "files=" << files << " bytes=" << bytes << " hash=" << std::hex << hash
+                << " years=" << (years && *years ? years : "all");
+    return fingerprint.str();
+}
+
+}  // namespace olap
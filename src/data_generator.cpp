@@ -0,0 +1,574 @@
+#include "data_generator.h"
+#include "memory_pool.h"
+#include <arrow/compute/api.h>
+#include <arrow/io/file.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/file_writer.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace olap {
+
+namespace {
+
+namespace cp = arrow::compute;
+namespace fs = std::filesystem;
+
+// Random streams of the generated tables
+constexpr uint32_t kProductStream = 1;
+constexpr uint32_t kCustomerStream = 2;
+constexpr uint32_t kFactStream = 3;
+
+constexpr int64_t kMicrosPerDay = 86400LL * 1000 * 1000;
+
+// Days since 1970-01-01 of a proleptic Gregorian date, and back
+// (H. Hinnant's days_from_civil / civil_from_days)
+int64_t DaysFromCivil(int64_t year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned year_of_era = static_cast<unsigned>(year - era * 400);
+    const unsigned day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + static_cast<int64_t>(day_of_era) - 719468;
+}
+
+void CivilFromDays(int64_t days, int& year, unsigned& month, unsigned& day) {
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned day_of_era = static_cast<unsigned>(days - era * 146097);
+    const unsigned year_of_era =
+        (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    const unsigned day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    const unsigned shifted_month = (5 * day_of_year + 2) / 153;
+    day = day_of_year - (153 * shifted_month + 2) / 5 + 1;
+    month = shifted_month < 10 ? shifted_month + 3 : shifted_month - 9;
+    year = static_cast<int>(year_of_era + era * 400 + (month <= 2));
+}
+
+// ISO 8601 week numbering: weeks start on Monday, week 1 holds the
+// year's first Thursday
+int IsoWeeksInYear(int year) {
+    const auto jan1_offset = [](int y) { return (y + y / 4 - y / 100 + y / 400) % 7; };
+    return jan1_offset(year) == 4 || jan1_offset(year - 1) == 3 ? 53 : 52;
+}
+
+int IsoWeek(int year, int day_of_year, int day_of_week) {
+    const int week = (day_of_year - day_of_week + 10) / 7;
+    if (week < 1) {
+        return IsoWeeksInYear(year - 1);
+    }
+    return week > IsoWeeksInYear(year) ? 1 : week;
+}
+
+// Two decimals, as np.round(x, 2)
+double Round2(double value) {
+    return std::nearbyint(value * 100.0) / 100.0;
+}
+
+// Columns of a table under construction
+struct TableColumns {
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    std::vector<std::shared_ptr<arrow::Array>> arrays;
+
+    arrow::Status Add(const std::string& name, arrow::ArrayBuilder& builder) {
+        ARROW_ASSIGN_OR_RAISE(auto array, builder.Finish());
+        fields.push_back(arrow::field(name, array->type()));
+        arrays.push_back(std::move(array));
+        return arrow::Status::OK();
+    }
+
+    std::shared_ptr<arrow::Table> Finish() const { return arrow::Table::Make(arrow::schema(fields), arrays); }
+};
+
+// Per-row attributes of the dimensions that fact rows depend on, indexed by
+// dimension row (date_key for dates, key - 1 for the others)
+struct FactDimensions {
+    std::vector<bool> is_weekend;
+    std::vector<int> partition;  // (year, month) of a date, numbered from the first
+    std::vector<std::string> partition_paths;  // e.g. year=2024/month=3
+    std::vector<double> unit_price;
+    std::vector<double> unit_cost;
+    uint32_t num_geographies = 0;
+    uint32_t num_customers = 0;
+};
+
+arrow::Result<FactDimensions> MakeFactDimensions(const arrow::Table& time, const arrow::Table& geography,
+                                                 const arrow::Table& product, const arrow::Table& customer) {
+    FactDimensions dims;
+    const auto& weekend = static_cast<const arrow::Int64Array&>(*time.GetColumnByName("is_weekend")->chunk(0));
+    const auto& years = static_cast<const arrow::Int32Array&>(*time.GetColumnByName("year")->chunk(0));
+    const auto& months = static_cast<const arrow::Int32Array&>(*time.GetColumnByName("month")->chunk(0));
+    const int first_year = years.Value(0);
+    std::map<int, std::string> partitions;
+    for (int64_t i = 0; i < time.num_rows(); ++i) {
+        dims.is_weekend.push_back(weekend.Value(i) == 1);
+        const int partition = (years.Value(i) - first_year) * 12 + months.Value(i) - 1;
+        dims.partition.push_back(partition);
+        partitions[partition] = "year=" + std::to_string(years.Value(i)) + "/month=" + std::to_string(months.Value(i));
+    }
+    dims.partition_paths.resize(partitions.rbegin()->first + 1);
+    for (const auto& [partition, path] : partitions) {
+        dims.partition_paths[partition] = path;
+    }
+    const auto& prices = static_cast<const arrow::DoubleArray&>(*product.GetColumnByName("unit_price")->chunk(0));
+    const auto& costs = static_cast<const arrow::DoubleArray&>(*product.GetColumnByName("unit_cost")->chunk(0));
+    dims.unit_price.assign(prices.raw_values(), prices.raw_values() + prices.length());
+    dims.unit_cost.assign(costs.raw_values(), costs.raw_values() + costs.length());
+    dims.num_geographies = static_cast<uint32_t>(geography.num_rows());
+    dims.num_customers = static_cast<uint32_t>(customer.num_rows());
+    return dims;
+}
+
+std::shared_ptr<arrow::Schema> FactSchema() {
+    return arrow::schema({arrow::field("sales_key", arrow::int64()), arrow::field("date_key", arrow::int64()),
+                          arrow::field("geography_key", arrow::int64()), arrow::field("product_key", arrow::int64()),
+                          arrow::field("customer_key", arrow::int64()), arrow::field("quantity", arrow::int64()),
+                          arrow::field("unit_price", arrow::float64()), arrow::field("unit_cost", arrow::float64()),
+                          arrow::field("gross_sales", arrow::float64()), arrow::field("total_cost", arrow::float64()),
+                          arrow::field("profit", arrow::float64())});
+}
+
+// Fact rows [first_row, first_row + rows). Each row reads 256 bits of its
+// own counter, so its values do not depend on how rows are sliced.
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> GenerateFactSlice(const FactDimensions& dims, const CounterRng& rng,
+                                                                     int64_t first_row, int64_t rows) {
+    arrow::Int64Builder sales_key(memory_pool()), date_key(memory_pool()), geography_key(memory_pool()),
+        product_key(memory_pool()), customer_key(memory_pool()), quantity(memory_pool());
+    arrow::DoubleBuilder unit_price(memory_pool()), unit_cost(memory_pool()), gross_sales(memory_pool()),
+        total_cost(memory_pool()), profit(memory_pool());
+    for (arrow::ArrayBuilder* builder : std::initializer_list<arrow::ArrayBuilder*>{
+             &sales_key, &date_key, &geography_key, &product_key, &customer_key, &quantity, &unit_price,
+             &unit_cost, &gross_sales, &total_cost, &profit}) {
+        ARROW_RETURN_NOT_OK(builder->Reserve(rows));
+    }
+    const auto num_dates = static_cast<uint32_t>(dims.is_weekend.size());
+    const auto num_products = static_cast<uint32_t>(dims.unit_price.size());
+    for (int64_t row = first_row; row < first_row + rows; ++row) {
+        const auto keys = rng(row, 0);
+        const auto values = rng(row, 1);
+        const uint32_t date = CounterRng::Below(keys[0], num_dates);
+        const uint32_t product = CounterRng::Below(keys[2], num_products);
+        // 1-10 units, 1.2-1.8x on weekends
+        const int64_t base_quantity = 1 + CounterRng::Below(values[0], 10);
+        const double weekend_multiplier = dims.is_weekend[date] ? CounterRng::Uniform(values[1], 1.2, 1.8) : 1.0;
+        const int64_t units = std::max<int64_t>(1, static_cast<int64_t>(base_quantity * weekend_multiplier));
+        // Discounts and promotions: 0.8-1.1x the list price
+        const double price = Round2(dims.unit_price[product] * CounterRng::Uniform(values[2], 0.8, 1.1));
+        const double cost = dims.unit_cost[product];
+        const double gross = Round2(units * price);
+        const double total = Round2(units * cost);
+
+        sales_key.UnsafeAppend(row + 1);
+        date_key.UnsafeAppend(date);
+        geography_key.UnsafeAppend(1 + CounterRng::Below(keys[1], dims.num_geographies));
+        product_key.UnsafeAppend(product + 1);
+        customer_key.UnsafeAppend(1 + CounterRng::Below(keys[3], dims.num_customers));
+        quantity.UnsafeAppend(units);
+        unit_price.UnsafeAppend(price);
+        unit_cost.UnsafeAppend(cost);
+        gross_sales.UnsafeAppend(gross);
+        total_cost.UnsafeAppend(total);
+        profit.UnsafeAppend(Round2(gross - total));
+    }
+    std::vector<std::shared_ptr<arrow::Array>> columns;
+    for (arrow::ArrayBuilder* builder : std::initializer_list<arrow::ArrayBuilder*>{
+             &sales_key, &date_key, &geography_key, &product_key, &customer_key, &quantity, &unit_price,
+             &unit_cost, &gross_sales, &total_cost, &profit}) {
+        ARROW_ASSIGN_OR_RAISE(auto column, builder->Finish());
+        columns.push_back(std::move(column));
+    }
+    return arrow::RecordBatch::Make(FactSchema(), rows, std::move(columns));
+}
+
+// A slice's rows grouped by (year, month) partition, in row order
+arrow::Result<std::vector<std::pair<int, std::shared_ptr<arrow::RecordBatch>>>> SplitByPartition(
+    const FactDimensions& dims, const std::shared_ptr<arrow::RecordBatch>& batch) {
+    const auto& date_keys = static_cast<const arrow::Int64Array&>(*batch->GetColumnByName("date_key"));
+    std::map<int, std::vector<int64_t>> rows;
+    for (int64_t i = 0; i < batch->num_rows(); ++i) {
+        rows[dims.partition[date_keys.Value(i)]].push_back(i);
+    }
+    std::vector<std::pair<int, std::shared_ptr<arrow::RecordBatch>>> parts;
+    for (const auto& [partition, indices] : rows) {
+        arrow::Int64Builder builder(memory_pool());
+        ARROW_RETURN_NOT_OK(builder.AppendValues(indices));
+        ARROW_ASSIGN_OR_RAISE(auto index_array, builder.Finish());
+        ARROW_ASSIGN_OR_RAISE(auto taken, cp::Take(batch, index_array, cp::TakeOptions::Defaults(), exec_context()));
+        parts.emplace_back(partition, taken.record_batch());
+    }
+    return parts;
+}
+
+std::shared_ptr<parquet::WriterProperties> WriterProperties(int64_t row_group_rows) {
+    return parquet::WriterProperties::Builder()
+        .compression(parquet::Compression::SNAPPY)
+        ->max_row_group_length(row_group_rows)
+        ->build();
+}
+
+// Stores the Arrow schema, so strings read back as large_string like the
+// files pandas writes
+std::shared_ptr<parquet::ArrowWriterProperties> ArrowProperties() {
+    return parquet::ArrowWriterProperties::Builder().store_schema()->build();
+}
+
+arrow::Status WriteDimension(const arrow::Table& table, const std::string& path) {
+    ARROW_ASSIGN_OR_RAISE(auto file, arrow::io::FileOutputStream::Open(path));
+    ARROW_RETURN_NOT_OK(parquet::arrow::WriteTable(table, memory_pool(), file, std::max<int64_t>(1, table.num_rows()),
+                                                   WriterProperties(std::max<int64_t>(1, table.num_rows())),
+                                                   ArrowProperties()));
+    return file->Close();
+}
+
+// A fact file being written, row group by row group
+struct FactFile {
+    std::shared_ptr<arrow::io::FileOutputStream> sink;
+    std::unique_ptr<parquet::arrow::FileWriter> writer;
+};
+
+arrow::Result<FactFile> OpenFactFile(const fs::path& path, int64_t row_group_rows) {
+    std::error_code error;
+    fs::create_directories(path.parent_path(), error);
+    if (error) {
+        return arrow::Status::IOError("Cannot create ", path.parent_path().string(), ": ", error.message());
+    }
+    FactFile file;
+    ARROW_ASSIGN_OR_RAISE(file.sink, arrow::io::FileOutputStream::Open(path.string()));
+    ARROW_ASSIGN_OR_RAISE(file.writer, parquet::arrow::FileWriter::Open(*FactSchema(), memory_pool(), file.sink,
+                                                                        WriterProperties(row_group_rows),
+                                                                        ArrowProperties()));
+    return file;
+}
+
+}  // namespace
+
+CounterRng::CounterRng(uint64_t seed, uint32_t stream)
+    : key_{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}, stream_(stream) {}
+
+std::array<uint32_t, 4> CounterRng::operator()(uint64_t counter, uint32_t block) const {
+    constexpr uint32_t kMultiplier0 = 0xD2511F53, kMultiplier1 = 0xCD9E8D57;
+    constexpr uint32_t kWeyl0 = 0x9E3779B9, kWeyl1 = 0xBB67AE85;
+    std::array<uint32_t, 4> x = {static_cast<uint32_t>(counter), static_cast<uint32_t>(counter >> 32), block, stream_};
+    std::array<uint32_t, 2> key = key_;
+    for (int round = 0; round < 10; ++round) {
+        const uint64_t product0 = static_cast<uint64_t>(kMultiplier0) * x[0];
+        const uint64_t product1 = static_cast<uint64_t>(kMultiplier1) * x[2];
+        x = {static_cast<uint32_t>(product1 >> 32) ^ x[1] ^ key[0], static_cast<uint32_t>(product1),
+             static_cast<uint32_t>(product0 >> 32) ^ x[3] ^ key[1], static_cast<uint32_t>(product0)};
+        key[0] += kWeyl0;
+        key[1] += kWeyl1;
+    }
+    return x;
+}
+
+GeneratorOptions GeneratorOptions::FromEnvironment() {
+    GeneratorOptions options;
+    if (std::getenv("OLAP_SALES_RECORDS")) {
+        options.sales_records = std::max<int64_t>(0, std::atoll(std::getenv("OLAP_SALES_RECORDS")));
+    }
+    if (std::getenv("OLAP_ROW_GROUP_ROWS")) {
+        options.row_group_rows = std::max<int64_t>(1, std::atoll(std::getenv("OLAP_ROW_GROUP_ROWS")));
+    }
+    if (std::getenv("OLAP_EXEC_THREADS")) {
+        options.num_threads = std::max(0, std::atoi(std::getenv("OLAP_EXEC_THREADS")));
+    }
+    if (std::getenv("OLAP_SEED")) {
+        options.seed = std::strtoull(std::getenv("OLAP_SEED"), nullptr, 10);
+    }
+    const char* partition = std::getenv("OLAP_PARTITION_FACTS");
+    options.partition_facts = partition && std::string(partition) == "1";
+    return options;
+}
+
+arrow::Result<std::shared_ptr<arrow::Table>> GenerateTimeDimension() {
+    static const char* kMonthNames[] = {"January", "February", "March",     "April",   "May",      "June",
+                                        "July",    "August",   "September", "October", "November", "December"};
+    static const char* kDayNames[] = {"Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday", "Sunday"};
+    arrow::Int64Builder date_key(memory_pool()), is_weekend(memory_pool());
+    arrow::TimestampBuilder date(arrow::timestamp(arrow::TimeUnit::MICRO), memory_pool());
+    arrow::Int32Builder year(memory_pool()), quarter(memory_pool()), month(memory_pool()), day(memory_pool()),
+        day_of_week(memory_pool()), fiscal_year(memory_pool());
+    arrow::LargeStringBuilder month_name(memory_pool()), day_name(memory_pool());
+    arrow::UInt32Builder week_of_year(memory_pool());
+
+    const int64_t first = DaysFromCivil(2020, 1, 1);
+    const int64_t last = DaysFromCivil(2024, 12, 31);
+    for (int64_t days = first; days <= last; ++days) {
+        int y;
+        unsigned m, d;
+        CivilFromDays(days, y, m, d);
+        // 1970-01-01 was a Thursday; Monday is 1
+        const int weekday = static_cast<int>((days % 7 + 10) % 7) + 1;
+        const int day_of_year = static_cast<int>(days - DaysFromCivil(y, 1, 1)) + 1;
+        ARROW_RETURN_NOT_OK(date_key.Append(days - first));
+        ARROW_RETURN_NOT_OK(date.Append(days * kMicrosPerDay));
+        ARROW_RETURN_NOT_OK(year.Append(y));
+        ARROW_RETURN_NOT_OK(quarter.Append((m - 1) / 3 + 1));
+        ARROW_RETURN_NOT_OK(month.Append(m));
+        ARROW_RETURN_NOT_OK(month_name.Append(kMonthNames[m - 1]));
+        ARROW_RETURN_NOT_OK(day.Append(d));
+        ARROW_RETURN_NOT_OK(day_of_week.Append(weekday));
+        ARROW_RETURN_NOT_OK(day_name.Append(kDayNames[weekday - 1]));
+        ARROW_RETURN_NOT_OK(week_of_year.Append(IsoWeek(y, day_of_year, weekday)));
+        ARROW_RETURN_NOT_OK(is_weekend.Append(weekday >= 6 ? 1 : 0));
+        ARROW_RETURN_NOT_OK(fiscal_year.Append(m >= 4 ? y + 1 : y));
+    }
+    TableColumns columns;
+    ARROW_RETURN_NOT_OK(columns.Add("date_key", date_key));
+    ARROW_RETURN_NOT_OK(columns.Add("date", date));
+    ARROW_RETURN_NOT_OK(columns.Add("year", year));
+    ARROW_RETURN_NOT_OK(columns.Add("quarter", quarter));
+    ARROW_RETURN_NOT_OK(columns.Add("month", month));
+    ARROW_RETURN_NOT_OK(columns.Add("month_name", month_name));
+    ARROW_RETURN_NOT_OK(columns.Add("day", day));
+    ARROW_RETURN_NOT_OK(columns.Add("day_of_week", day_of_week));
+    ARROW_RETURN_NOT_OK(columns.Add("day_name", day_name));
+    ARROW_RETURN_NOT_OK(columns.Add("week_of_year", week_of_year));
+    ARROW_RETURN_NOT_OK(columns.Add("is_weekend", is_weekend));
+    ARROW_RETURN_NOT_OK(columns.Add("fiscal_year", fiscal_year));
+    return columns.Finish();
+}
+
+arrow::Result<std::shared_ptr<arrow::Table>> GenerateGeographyDimension() {
+    struct Country {
+        const char* region;
+        const char* country;
+        std::vector<const char*> cities;
+    };
+    static const std::vector<Country> kCountries = {
+        {"North America", "USA", {"New York", "Los Angeles", "Chicago", "Houston", "Phoenix"}},
+        {"North America", "Canada", {"Toronto", "Vancouver", "Montreal", "Calgary"}},
+        {"North America", "Mexico", {"Mexico City", "Guadalajara", "Monterrey"}},
+        {"Europe", "Germany", {"Berlin", "Munich", "Hamburg", "Frankfurt"}},
+        {"Europe", "France", {"Paris", "Lyon", "Marseille", "Toulouse"}},
+        {"Europe", "UK", {"London", "Manchester", "Birmingham", "Glasgow"}},
+        {"Europe", "Italy", {"Rome", "Milan", "Naples", "Turin"}},
+        {"Europe", "Spain", {"Madrid", "Barcelona", "Valencia", "Seville"}},
+        {"Asia Pacific", "China", {"Beijing", "Shanghai", "Guangzhou", "Shenzhen"}},
+        {"Asia Pacific", "Japan", {"Tokyo", "Osaka", "Nagoya", "Fukuoka"}},
+        {"Asia Pacific", "Australia", {"Sydney", "Melbourne", "Brisbane", "Perth"}},
+        {"Asia Pacific", "India", {"Mumbai", "Delhi", "Bangalore", "Chennai"}},
+        {"Asia Pacific", "South Korea", {"Seoul", "Busan", "Incheon"}},
+        {"Latin America", "Brazil", {"São Paulo", "Rio de Janeiro", "Brasília"}},
+        {"Latin America", "Argentina", {"Buenos Aires", "Córdoba", "Rosario"}},
+        {"Latin America", "Chile", {"Santiago", "Valparaíso", "Concepción"}},
+        {"Latin America", "Colombia", {"Bogotá", "Medellín", "Cali"}}};
+    arrow::Int64Builder geography_key(memory_pool());
+    arrow::LargeStringBuilder city(memory_pool()), country(memory_pool()), region(memory_pool());
+    int64_t key = 1;
+    for (const auto& entry : kCountries) {
+        for (const char* name : entry.cities) {
+            ARROW_RETURN_NOT_OK(geography_key.Append(key++));
+            ARROW_RETURN_NOT_OK(city.Append(name));
+            ARROW_RETURN_NOT_OK(country.Append(entry.country));
+            ARROW_RETURN_NOT_OK(region.Append(entry.region));
+        }
+    }
+    TableColumns columns;
+    ARROW_RETURN_NOT_OK(columns.Add("geography_key", geography_key));
+    ARROW_RETURN_NOT_OK(columns.Add("city", city));
+    ARROW_RETURN_NOT_OK(columns.Add("country", country));
+    ARROW_RETURN_NOT_OK(columns.Add("region", region));
+    return columns.Finish();
+}
+
+arrow::Result<std::shared_ptr<arrow::Table>> GenerateProductDimension(uint64_t seed) {
+    struct Subcategory {
+        const char* category;
+        const char* subcategory;
+        std::vector<std::string> products;
+    };
+    static const std::vector<Subcategory> kSubcategories = {
+        {"Electronics", "Computers", {"Laptop", "Desktop", "Tablet", "Monitor"}},
+        {"Electronics", "Mobile", {"Smartphone", "Feature Phone", "Accessories"}},
+        {"Electronics", "Audio", {"Headphones", "Speakers", "Microphone"}},
+        {"Clothing", "Men", {"Shirts", "Pants", "Shoes", "Accessories"}},
+        {"Clothing", "Women", {"Dresses", "Tops", "Shoes", "Accessories"}},
+        {"Clothing", "Kids", {"Clothing", "Shoes", "Toys"}},
+        {"Home & Garden", "Furniture", {"Chairs", "Tables", "Sofas", "Storage"}},
+        {"Home & Garden", "Kitchen", {"Appliances", "Cookware", "Utensils"}},
+        {"Home & Garden", "Garden", {"Tools", "Plants", "Outdoor Furniture"}}};
+    const CounterRng rng(seed, kProductStream);
+    arrow::Int64Builder product_key(memory_pool());
+    arrow::LargeStringBuilder sku(memory_pool()), product_name(memory_pool()), product_type(memory_pool()),
+        subcategory(memory_pool()), category(memory_pool());
+    arrow::DoubleBuilder unit_cost(memory_pool()), unit_price(memory_pool());
+    int64_t key = 1;
+    uint64_t product_index = 0;
+    for (const auto& entry : kSubcategories) {
+        for (const auto& product : entry.products) {
+            // 3-8 SKUs per product type, each with its own cost and price
+            const uint32_t skus = 3 + CounterRng::Below(rng(product_index++, 0)[0], 6);
+            for (uint32_t i = 0; i < skus; ++i, ++key) {
+                std::string prefix = product.substr(0, 3);
+                std::transform(prefix.begin(), prefix.end(), prefix.begin(), ::toupper);
+                char number[24];
+                std::snprintf(number, sizeof(number), "%04lld", static_cast<long long>(key));
+                const auto prices = rng(key, 1);
+                ARROW_RETURN_NOT_OK(product_key.Append(key));
+                ARROW_RETURN_NOT_OK(sku.Append(prefix + number));
+                ARROW_RETURN_NOT_OK(product_name.Append(product + " Model " + static_cast<char>('A' + i)));
+                ARROW_RETURN_NOT_OK(product_type.Append(product));
+                ARROW_RETURN_NOT_OK(subcategory.Append(entry.subcategory));
+                ARROW_RETURN_NOT_OK(category.Append(entry.category));
+                ARROW_RETURN_NOT_OK(unit_cost.Append(Round2(CounterRng::Uniform(prices[0], 10, 500))));
+                ARROW_RETURN_NOT_OK(unit_price.Append(Round2(CounterRng::Uniform(prices[1], 15, 750))));
+            }
+        }
+    }
+    TableColumns columns;
+    ARROW_RETURN_NOT_OK(columns.Add("product_key", product_key));
+    ARROW_RETURN_NOT_OK(columns.Add("sku", sku));
+    ARROW_RETURN_NOT_OK(columns.Add("product_name", product_name));
+    ARROW_RETURN_NOT_OK(columns.Add("product_type", product_type));
+    ARROW_RETURN_NOT_OK(columns.Add("subcategory", subcategory));
+    ARROW_RETURN_NOT_OK(columns.Add("category", category));
+    ARROW_RETURN_NOT_OK(columns.Add("unit_cost", unit_cost));
+    ARROW_RETURN_NOT_OK(columns.Add("unit_price", unit_price));
+    return columns.Finish();
+}
+
+arrow::Result<std::shared_ptr<arrow::Table>> GenerateCustomerDimension(uint64_t seed) {
+    static const char* kCustomerTypes[] = {"Individual", "Small Business", "Enterprise"};
+    const CounterRng rng(seed, kCustomerStream);
+    arrow::Int64Builder customer_key(memory_pool());
+    arrow::LargeStringBuilder customer_id(memory_pool()), customer_type(memory_pool());
+    arrow::TimestampBuilder registration_date(arrow::timestamp(arrow::TimeUnit::MICRO), memory_pool());
+    const int64_t first_registration = DaysFromCivil(2019, 1, 1);
+    for (int64_t key = 1; key <= 1000; ++key) {
+        const auto bits = rng(key);
+        char id[24];
+        std::snprintf(id, sizeof(id), "CUST%06lld", static_cast<long long>(key));
+        ARROW_RETURN_NOT_OK(customer_key.Append(key));
+        ARROW_RETURN_NOT_OK(customer_id.Append(id));
+        ARROW_RETURN_NOT_OK(customer_type.Append(kCustomerTypes[CounterRng::Below(bits[0], 3)]));
+        ARROW_RETURN_NOT_OK(
+            registration_date.Append((first_registration + CounterRng::Below(bits[1], 1826)) * kMicrosPerDay));
+    }
+    TableColumns columns;
+    ARROW_RETURN_NOT_OK(columns.Add("customer_key", customer_key));
+    ARROW_RETURN_NOT_OK(columns.Add("customer_id", customer_id));
+    ARROW_RETURN_NOT_OK(columns.Add("customer_type", customer_type));
+    ARROW_RETURN_NOT_OK(columns.Add("registration_date", registration_date));
+    return columns.Finish();
+}
+
+arrow::Result<GeneratorStats> GenerateStarSchema(const std::string& data_path, const GeneratorOptions& options) {
+    const fs::path root(data_path);
+    std::error_code error;
+    fs::create_directories(root, error);
+    if (error) {
+        return arrow::Status::IOError("Cannot create ", data_path, ": ", error.message());
+    }
+
+    ARROW_ASSIGN_OR_RAISE(auto time, GenerateTimeDimension());
+    ARROW_ASSIGN_OR_RAISE(auto geography, GenerateGeographyDimension());
+    ARROW_ASSIGN_OR_RAISE(auto product, GenerateProductDimension(options.seed));
+    ARROW_ASSIGN_OR_RAISE(auto customer, GenerateCustomerDimension(options.seed));
+    ARROW_RETURN_NOT_OK(WriteDimension(*time, (root / "dim_time.parquet").string()));
+    ARROW_RETURN_NOT_OK(WriteDimension(*geography, (root / "dim_geography.parquet").string()));
+    ARROW_RETURN_NOT_OK(WriteDimension(*product, (root / "dim_product.parquet").string()));
+    ARROW_RETURN_NOT_OK(WriteDimension(*customer, (root / "dim_customer.parquet").string()));
+    ARROW_ASSIGN_OR_RAISE(auto dims, MakeFactDimensions(*time, *geography, *product, *customer));
+
+    GeneratorStats stats;
+    stats.time_rows = time->num_rows();
+    stats.geography_rows = geography->num_rows();
+    stats.product_rows = product->num_rows();
+    stats.customer_rows = customer->num_rows();
+
+    // Only one form of fact_sales may exist, or the analyzers would read
+    // the stale one (they prefer the directory)
+    fs::remove_all(root / "fact_sales", error);
+    if (options.partition_facts) {
+        fs::remove(root / "fact_sales.parquet", error);
+    }
+
+    // Files by partition; -1 is the single fact_sales.parquet
+    std::map<int, FactFile> files;
+    const CounterRng rng(options.seed, kFactStream);
+    const int num_threads = options.num_threads > 0
+                                ? options.num_threads
+                                : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    const int64_t slice_rows = std::max<int64_t>(1, options.slice_rows);
+    for (int64_t group_start = 0; group_start < options.sales_records; group_start += options.row_group_rows) {
+        const int64_t group_rows = std::min(options.row_group_rows, options.sales_records - group_start);
+        const int64_t num_slices = (group_rows + slice_rows - 1) / slice_rows;
+        std::vector<std::vector<std::pair<int, std::shared_ptr<arrow::RecordBatch>>>> slices(num_slices);
+        std::vector<arrow::Status> statuses(num_slices);
+        std::atomic<int64_t> next{0};
+        auto work = [&]() {
+            for (int64_t s = next.fetch_add(1); s < num_slices; s = next.fetch_add(1)) {
+                const int64_t first_row = group_start + s * slice_rows;
+                auto batch = GenerateFactSlice(dims, rng, first_row,
+                                               std::min(slice_rows, group_start + group_rows - first_row));
+                if (!batch.ok()) {
+                    statuses[s] = batch.status();
+                } else if (!options.partition_facts) {
+                    slices[s].emplace_back(-1, *batch);
+                } else {
+                    auto parts = SplitByPartition(dims, *batch);
+                    statuses[s] = parts.status();
+                    if (parts.ok()) {
+                        slices[s] = std::move(*parts);
+                    }
+                }
+            }
+        };
+        std::vector<std::thread> workers;
+        for (int t = 0; t < std::min<int64_t>(num_threads, num_slices); ++t) {
+            workers.emplace_back(work);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        // Every file gets its share of the group as one row group, written
+        // column by column, so no file keeps a row group open (and buffered)
+        // across groups; batches stay in row order, so the files do not
+        // depend on thread timing
+        std::map<int, std::vector<std::shared_ptr<arrow::RecordBatch>>> group_batches;
+        for (int64_t s = 0; s < num_slices; ++s) {
+            ARROW_RETURN_NOT_OK(statuses[s]);
+            for (auto& [partition, batch] : slices[s]) {
+                group_batches[partition].push_back(std::move(batch));
+            }
+            slices[s].clear();
+        }
+        for (auto& [partition, batches] : group_batches) {
+            auto file = files.find(partition);
+            if (file == files.end()) {
+                const fs::path path = partition < 0 ? root / "fact_sales.parquet"
+                                                    : root / "fact_sales" / dims.partition_paths[partition] /
+                                                          "part-0.parquet";
+                ARROW_ASSIGN_OR_RAISE(auto opened, OpenFactFile(path, options.row_group_rows));
+                file = files.emplace(partition, std::move(opened)).first;
+            }
+            ARROW_ASSIGN_OR_RAISE(auto table, arrow::Table::FromRecordBatches(FactSchema(), batches));
+            ARROW_RETURN_NOT_OK(file->second.writer->WriteTable(*table, options.row_group_rows));
+            batches.clear();
+        }
+        stats.fact_rows += group_rows;
+    }
+    if (files.empty() && !options.partition_facts) {
+        ARROW_ASSIGN_OR_RAISE(auto opened, OpenFactFile(root / "fact_sales.parquet", options.row_group_rows));
+        files.emplace(-1, std::move(opened));
+    }
+    for (auto& [partition, file] : files) {
+        ARROW_RETURN_NOT_OK(file.writer->Close());
+        ARROW_RETURN_NOT_OK(file.sink->Close());
+        stats.fact_row_groups += file.writer->metadata()->num_row_groups();
+    }
+    stats.fact_files = static_cast<int64_t>(files.size());
+    return stats;
+}
+
+}  // namespace olap
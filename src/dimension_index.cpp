@@ -0,0 +1,146 @@
+#include "dimension_index.h"
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+namespace olap {
+
+namespace {
+
+uint64_t HashKey(int64_t key, int shift) {
+    return (static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL) >> shift;
+}
+
+}  // namespace
+
+arrow::Result<std::shared_ptr<DimensionIndex>> DimensionIndex::Make(const arrow::ChunkedArray& keys) {
+    std::shared_ptr<DimensionIndex> index(new DimensionIndex());
+    const int64_t num_rows = keys.length();
+
+    // Gather keys and their range in one pass
+    std::vector<int64_t> row_keys(num_rows);
+    std::vector<bool> valid(num_rows);
+    int64_t min_key = std::numeric_limits<int64_t>::max();
+    int64_t max_key = std::numeric_limits<int64_t>::min();
+    int64_t num_keys = 0;
+    int64_t base_row = 0;
+    for (const auto& chunk : keys.chunks()) {
+        ARROW_RETURN_NOT_OK(GatherIntegers(*chunk, row_keys.data() + base_row));
+        for (int64_t i = 0; i < chunk->length(); ++i) {
+            const int64_t row = base_row + i;
+            valid[row] = chunk->IsValid(i);
+            if (valid[row]) {
+                min_key = std::min(min_key, row_keys[row]);
+                max_key = std::max(max_key, row_keys[row]);
+                ++num_keys;
+            }
+        }
+        base_row += chunk->length();
+    }
+
+    index->num_keys_ = num_keys;
+    if (num_keys == 0) {
+        return index;
+    }
+    index->min_key_ = min_key;
+    index->max_key_ = max_key;
+
+    // Dense when the key range is not much larger than the key count. The
+    // span max - min is taken without the + 1, which wraps to 0 for keys
+    // spanning all of int64 (that range is sparse anyway).
+    const uint64_t span = static_cast<uint64_t>(max_key) - static_cast<uint64_t>(min_key);
+    index->dense_ = span < static_cast<uint64_t>(kDenseFactor * num_keys + kDenseSlack);
+
+    if (index->dense_) {
+        index->slot_rows_.assign(span + 1, kNoMatch);
+    } else {
+        int bits = 1;
+        while ((int64_t{1} << bits) < 2 * num_keys) {
+            ++bits;
+        }
+        index->shift_ = 64 - bits;
+        index->slot_rows_.assign(size_t{1} << bits, kNoMatch);
+        index->slot_keys_.assign(size_t{1} << bits, 0);
+    }
+
+    const uint64_t mask = index->slot_rows_.size() - 1;
+    for (int64_t row = 0; row < num_rows; ++row) {
+        if (!valid[row]) {
+            continue;
+        }
+        const int64_t key = row_keys[row];
+        int64_t slot;
+        if (index->dense_) {
+            slot = index->SlotOf(key);
+            if (slot < 0) {
+                return arrow::Status::IndexError("Dimension key ", key, " outside the indexed range");
+            }
+        } else {
+            slot = static_cast<int64_t>(HashKey(key, index->shift_));
+            while (index->slot_rows_[slot] != kNoMatch && index->slot_keys_[slot] != key) {
+                slot = static_cast<int64_t>((slot + 1) & mask);
+            }
+            index->slot_keys_[slot] = key;
+        }
+        if (index->slot_rows_[slot] != kNoMatch) {
+            return arrow::Status::KeyError("Duplicate dimension key ", key);
+        }
+        index->slot_rows_[slot] = row;
+    }
+    return index;
+}
+
+arrow::Result<std::shared_ptr<DimensionIndex>> DimensionIndex::Make(const arrow::Table& dimension,
+                                                                    const std::string& key_column) {
+    auto keys = dimension.GetColumnByName(key_column);
+    if (!keys) {
+        return arrow::Status::Invalid("Column '" + key_column + "' not found");
+    }
+    return Make(*keys);
+}
+
+int64_t DimensionIndex::SparseSlotOf(int64_t key) const {
+    if (slot_rows_.empty()) {
+        return -1;
+    }
+    const uint64_t mask = slot_rows_.size() - 1;
+    uint64_t slot = HashKey(key, shift_);
+    while (slot_rows_[slot] != kNoMatch) {
+        if (slot_keys_[slot] == key) {
+            return static_cast<int64_t>(slot);
+        }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+arrow::Status DimensionIndex::Probe(const arrow::Array& keys, int64_t base_row, JoinType join_type,
+                                    std::vector<int64_t>& left_rows,
+                                    std::vector<int64_t>& right_rows) const {
+    const int64_t length = keys.length();
+    left_rows.reserve(left_rows.size() + length);
+    right_rows.reserve(right_rows.size() + length);
+
+    return VisitIntegerValues(keys, [&](const auto* values) {
+        for (int64_t i = 0; i < length; ++i) {
+            int64_t row = keys.IsValid(i) ? RowOf(static_cast<int64_t>(values[i])) : kNoMatch;
+            if (row != kNoMatch || join_type == JoinType::kLeftOuter) {
+                left_rows.push_back(base_row + i);
+                right_rows.push_back(row);
+            }
+        }
+        return arrow::Status::OK();
+    });
+}
+
+std::string DimensionIndex::ToString() const {
+    std::ostringstream oss;
+    oss << num_keys_ << " keys, " << (dense_ ? "dense" : "sparse");
+    if (num_keys_ > 0) {
+        oss << " [" << min_key_ << ".." << max_key_ << "]";
+    }
+    oss << ", " << slot_rows_.size() << " slots";
+    return oss.str();
+}
+
+}  // namespace olap
@@ -0,0 +1,280 @@
+#include "distinct_count.h"
+#include "arrow_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace olap {
+
+namespace {
+
+constexpr int kBitmapWords = 65536 / 64;
+
+// Branch-free lower bound: keys arrive in random order, where the
+// mispredicted branches of std::lower_bound dominate the cost of an Add.
+size_t LowerBound(const std::vector<uint16_t>& array, uint16_t value) {
+    if (array.empty()) {
+        return 0;
+    }
+    const uint16_t* base = array.data();
+    size_t length = array.size();
+    while (length > 1) {
+        const size_t half = length / 2;
+        base = base[half] < value ? base + half : base;
+        length -= half;
+    }
+    return static_cast<size_t>(base - array.data()) + (*base < value);
+}
+
+// Ertl's sigma and tau series; both converge to double precision in a few
+// dozen iterations.
+double Sigma(double x) {
+    if (x == 1) {
+        return std::numeric_limits<double>::infinity();
+    }
+    double y = 1;
+    double z = x;
+    double previous;
+    do {
+        x *= x;
+        previous = z;
+        z += x * y;
+        y += y;
+    } while (z != previous);
+    return z;
+}
+
+double Tau(double x) {
+    if (x == 0 || x == 1) {
+        return 0;
+    }
+    double y = 1;
+    double z = 1 - x;
+    double previous;
+    do {
+        x = std::sqrt(x);
+        previous = z;
+        y *= 0.5;
+        z -= (1 - x) * (1 - x) * y;
+    } while (z != previous);
+    return z / 3;
+}
+
+}  // namespace
+
+RoaringBitmap::Container& RoaringBitmap::FindOrAddContainer(uint16_t key) {
+    if (last_ < keys_.size() && keys_[last_] == key) {
+        return containers_[last_];
+    }
+    auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+    last_ = static_cast<size_t>(it - keys_.begin());
+    if (it == keys_.end() || *it != key) {
+        keys_.insert(it, key);
+        containers_.insert(containers_.begin() + last_, Container());
+    }
+    return containers_[last_];
+}
+
+bool RoaringBitmap::AddToContainer(Container& container, uint16_t low) {
+    if (container.bits.empty()) {
+        auto it = container.array.begin() + LowerBound(container.array, low);
+        if (it != container.array.end() && *it == low) {
+            return false;
+        }
+        if (container.array.size() < static_cast<size_t>(kMaxArraySize)) {
+            container.array.insert(it, low);
+            ++container.cardinality;
+            return true;
+        }
+        // Past kMaxArraySize values the bitmap is the smaller container
+        container.bits.assign(kBitmapWords, 0);
+        for (uint16_t value : container.array) {
+            container.bits[value >> 6] |= uint64_t{1} << (value & 63);
+        }
+        container.array.clear();
+        container.array.shrink_to_fit();
+    }
+    uint64_t& word = container.bits[low >> 6];
+    const uint64_t mask = uint64_t{1} << (low & 63);
+    if (word & mask) {
+        return false;
+    }
+    word |= mask;
+    ++container.cardinality;
+    return true;
+}
+
+void RoaringBitmap::Add(uint32_t value) {
+    Container& container = FindOrAddContainer(static_cast<uint16_t>(value >> 16));
+    if (AddToContainer(container, static_cast<uint16_t>(value & 0xFFFF))) {
+        ++cardinality_;
+    }
+}
+
+void RoaringBitmap::Merge(const RoaringBitmap& other) {
+    for (size_t c = 0; c < other.keys_.size(); ++c) {
+        const Container& source = other.containers_[c];
+        Container& target = FindOrAddContainer(other.keys_[c]);
+        cardinality_ -= target.cardinality;
+        if (source.bits.empty()) {
+            for (uint16_t low : source.array) {
+                AddToContainer(target, low);
+            }
+        } else {
+            if (target.bits.empty()) {
+                target.bits.assign(kBitmapWords, 0);
+                for (uint16_t value : target.array) {
+                    target.bits[value >> 6] |= uint64_t{1} << (value & 63);
+                }
+                target.array.clear();
+                target.array.shrink_to_fit();
+            }
+            target.cardinality = 0;
+            for (int word = 0; word < kBitmapWords; ++word) {
+                target.bits[word] |= source.bits[word];
+                target.cardinality += __builtin_popcountll(target.bits[word]);
+            }
+        }
+        cardinality_ += target.cardinality;
+    }
+}
+
+bool RoaringBitmap::Contains(uint32_t value) const {
+    auto it = std::lower_bound(keys_.begin(), keys_.end(), static_cast<uint16_t>(value >> 16));
+    if (it == keys_.end() || *it != static_cast<uint16_t>(value >> 16)) {
+        return false;
+    }
+    const Container& container = containers_[it - keys_.begin()];
+    const uint16_t low = static_cast<uint16_t>(value & 0xFFFF);
+    if (container.bits.empty()) {
+        return std::binary_search(container.array.begin(), container.array.end(), low);
+    }
+    return (container.bits[low >> 6] >> (low & 63)) & 1;
+}
+
+int64_t RoaringBitmap::memory_bytes() const {
+    int64_t bytes = static_cast<int64_t>(keys_.capacity() * sizeof(uint16_t) +
+                                         containers_.capacity() * sizeof(Container));
+    for (const auto& container : containers_) {
+        bytes += static_cast<int64_t>(container.array.capacity() * sizeof(uint16_t) +
+                                      container.bits.capacity() * sizeof(uint64_t));
+    }
+    return bytes;
+}
+
+HyperLogLog::HyperLogLog(int precision)
+    : precision_(std::clamp(precision, 4, 18)), registers_(size_t{1} << precision_, 0) {}
+
+uint64_t HyperLogLog::Hash(int64_t value) {
+    // MurmurHash3 finalizer: a bijection that spreads sequential keys
+    uint64_t key = static_cast<uint64_t>(value);
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+    key *= 0xC4CEB9FE1A85EC53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+void HyperLogLog::AddHash(uint64_t hash) {
+    const size_t index = hash >> (64 - precision_);
+    const uint64_t rest = hash << precision_;
+    const int max_rank = 64 - precision_ + 1;
+    const uint8_t rank = static_cast<uint8_t>(rest == 0 ? max_rank : std::min(__builtin_clzll(rest) + 1, max_rank));
+    registers_[index] = std::max(registers_[index], rank);
+}
+
+void HyperLogLog::Merge(const HyperLogLog& other) {
+    for (size_t i = 0; i < registers_.size(); ++i) {
+        registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+}
+
+double HyperLogLog::Estimate() const {
+    const int q = 64 - precision_;
+    const double m = static_cast<double>(registers_.size());
+    std::vector<int64_t> histogram(q + 2, 0);
+    for (uint8_t rank : registers_) {
+        ++histogram[rank];
+    }
+    double z = m * Tau(1 - histogram[q + 1] / m);
+    for (int k = q; k >= 1; --k) {
+        z = 0.5 * (z + histogram[k]);
+    }
+    z += m * Sigma(histogram[0] / m);
+    return m / (2 * std::log(2.0)) * m / z;
+}
+
+DistinctCounter::DistinctCounter(bool approximate, int precision)
+    : approximate_(approximate), precision_(precision) {}
+
+void DistinctCounter::SwitchToSketch() {
+    sketch_ = std::make_unique<HyperLogLog>(precision_);
+    bitmap_.ForEach([&](uint32_t value) { sketch_->Add(value); });
+    bitmap_ = RoaringBitmap();
+}
+
+arrow::Status DistinctCounter::Add(int64_t value) {
+    if (sketch_) {
+        sketch_->Add(value);
+        return arrow::Status::OK();
+    }
+    if (value < 0 || value > std::numeric_limits<uint32_t>::max()) {
+        if (!approximate_) {
+            return arrow::Status::CapacityError("Exact distinct count needs keys in [0, 2^32), got ", value);
+        }
+        SwitchToSketch();
+        sketch_->Add(value);
+        return arrow::Status::OK();
+    }
+    bitmap_.Add(static_cast<uint32_t>(value));
+    // Array containers hold two bytes per value: past half as many values
+    // as the sketch has registers, the sketch is the smaller of the two
+    if (approximate_ && bitmap_.cardinality() > (int64_t{1} << precision_) / 2) {
+        SwitchToSketch();
+    }
+    return arrow::Status::OK();
+}
+
+arrow::Status DistinctCounter::Add(const arrow::Array& values) {
+    return VisitIntegerValues(values, [&](const auto* data) {
+        for (int64_t i = 0; i < values.length(); ++i) {
+            if (values.IsValid(i)) {
+                ARROW_RETURN_NOT_OK(Add(static_cast<int64_t>(data[i])));
+            }
+        }
+        return arrow::Status::OK();
+    });
+}
+
+arrow::Status DistinctCounter::Merge(const DistinctCounter& other) {
+    if (other.approximate_ != approximate_ || other.precision_ != precision_) {
+        return arrow::Status::Invalid("Cannot merge distinct counters of different modes");
+    }
+    if (!sketch_ && !other.sketch_) {
+        bitmap_.Merge(other.bitmap_);
+        if (approximate_ && bitmap_.cardinality() > (int64_t{1} << precision_) / 2) {
+            SwitchToSketch();
+        }
+        return arrow::Status::OK();
+    }
+    if (!sketch_) {
+        SwitchToSketch();
+    }
+    if (other.sketch_) {
+        sketch_->Merge(*other.sketch_);
+    } else {
+        other.bitmap_.ForEach([&](uint32_t value) { sketch_->Add(value); });
+    }
+    return arrow::Status::OK();
+}
+
+int64_t DistinctCounter::Count() const {
+    return sketch_ ? std::llround(sketch_->Estimate()) : bitmap_.cardinality();
+}
+
+int64_t DistinctCounter::memory_bytes() const {
+    return sketch_ ? sketch_->memory_bytes() : bitmap_.memory_bytes();
+}
+
+}  // namespace olap
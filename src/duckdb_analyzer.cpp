@@ -1,13 +1,21 @@
 #include "duckdb_analyzer.h"
+#include "cube_layout.h"
+#include "perf_counters.h"
+#include "trace.h"
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
 #include <cstdlib>  // for std::getenv
+#include <filesystem>
 
 DuckDBOLAPAnalyzer::DuckDBOLAPAnalyzer() {
     // Initialize DuckDB
     db_ = std::make_unique<duckdb::DuckDB>(nullptr);
     conn_ = std::make_unique<duckdb::Connection>(*db_);
     
+    const char* use_cube = std::getenv("OLAP_USE_CUBE");
+    use_cube_ = !use_cube || std::string(use_cube) != "0";
+    
     ConfigureDatabase();
 }
 
@@ -19,15 +27,50 @@ void DuckDBOLAPAnalyzer::ConfigureDatabase() {
 }
 
 std::unique_ptr<duckdb::MaterializedQueryResult> DuckDBOLAPAnalyzer::ExecuteQuery(const std::string& query) {
+    // DuckDB decodes, joins and aggregates inside the query; its stages are
+    // only visible through DuckDB's own profiler
+    olap::TraceSpan span(olap::kStageQuery, "DuckDB query");
+    if (span.active()) {
+        span.SetDetail(query);
+    }
     return conn_->Query(query);
 }
 
+std::unique_ptr<duckdb::MaterializedQueryResult> DuckDBOLAPAnalyzer::ExecutePrepared(
+    const std::string& name, const std::string& query, duckdb::vector<duckdb::Value> parameters) {
+    olap::TraceSpan span(olap::kStageQuery, "DuckDB prepared query");
+    if (span.active()) {
+        span.SetDetail(name);
+    }
+    auto cached = statements_.find(name);
+    if (cached == statements_.end() || cached->second.query != query) {
+        auto statement = conn_->Prepare(query);
+        if (statement->HasError()) {
+            // Running the SQL directly reports the same error as a result
+            return conn_->Query(query);
+        }
+        cached = statements_.insert_or_assign(name, PreparedQuery{query, std::move(statement)}).first;
+    }
+    // Not streamed: every caller reads the whole result
+    auto result = cached->second.statement->Execute(parameters, false);
+    return duckdb::unique_ptr_cast<duckdb::QueryResult, duckdb::MaterializedQueryResult>(std::move(result));
+}
+
 bool DuckDBOLAPAnalyzer::HasError(std::unique_ptr<duckdb::MaterializedQueryResult>& result) {
     return result->HasError();
 }
 
+int64_t DuckDBOLAPAnalyzer::CountFactRows() {
+    auto count = ExecuteQuery("SELECT COUNT(*) FROM fact_sales");
+    return HasError(count) ? -1 : std::stoll(count->GetValue(0, 0).ToString());
+}
+
 void DuckDBOLAPAnalyzer::PrintQueryResult(std::unique_ptr<duckdb::MaterializedQueryResult> result,
                                          const std::string& title) {
+    olap::TraceSpan span(olap::kStageFormat, "PrintQueryResult");
+    if (span.active()) {
+        span.SetDetail(title);
+    }
     std::cout << "\n" << title << "\n";
     std::cout << std::string(title.length(), '=') << "\n";
     
@@ -59,6 +102,7 @@ void DuckDBOLAPAnalyzer::PrintQueryResult(std::unique_ptr<duckdb::MaterializedQu
 
 bool DuckDBOLAPAnalyzer::RegisterParquetTables() {
     std::cout << "Registering Parquet tables in DuckDB...\n";
+    olap::TraceSpan trace(olap::kStageLoad, "RegisterParquetTables");
     
     // Check if data directory exists
     std::string data_path = "olap_data";
@@ -77,6 +121,22 @@ bool DuckDBOLAPAnalyzer::RegisterParquetTables() {
     
     for (const auto& [table_name, file_path] : queries) {
         std::string query = "CREATE VIEW " + table_name + " AS SELECT * FROM '" + file_path + "'";
+        if (table_name == "fact_sales" && std::filesystem::is_directory(data_path + "/fact_sales")) {
+            // Partitioned dataset: key=value directories become columns, and
+            // filters on them skip whole directories; files scan in parallel
+            query = "CREATE VIEW fact_sales AS SELECT * FROM read_parquet('" + data_path +
+                    "/fact_sales/**/*.parquet', hive_partitioning = true)";
+            olap::FactYears years;
+            std::string error;
+            if (!olap::FactYearsFromEnvironment(years, error)) {
+                std::cerr << error << std::endl;
+                return false;
+            }
+            if (!years.all) {
+                query += " WHERE year BETWEEN " + std::to_string(years.first) + " AND " + std::to_string(years.last);
+            }
+            std::cout << "Partitioned fact_sales dataset under " << data_path << "/fact_sales\n";
+        }
         auto result = ExecuteQuery(query);
         if (HasError(result)) {
             std::cerr << "Failed to register table " << table_name << ": " << result->GetError() << std::endl;
@@ -85,10 +145,57 @@ bool DuckDBOLAPAnalyzer::RegisterParquetTables() {
         }
     }
     
+    // The cube serves rollups only while its source fingerprint matches
+    // the files (and year window) registered above
+    const std::string cube_path = data_path + "/" + olap::kCubeFileName;
+    if (use_cube_ && std::filesystem::exists(cube_path)) {
+        auto fingerprint = ExecuteQuery("SELECT decode(value) FROM parquet_kv_metadata('" + cube_path +
+                                        "') WHERE decode(key) = '" + olap::kCubeFingerprintKey + "'");
+        cube_fresh_ = !HasError(fingerprint) && fingerprint->RowCount() > 0 &&
+                      fingerprint->GetValue(0, 0).ToString() == olap::CubeSourceFingerprint(data_path);
+        if (cube_fresh_) {
+            auto result = ExecuteQuery("CREATE VIEW sales_cube AS SELECT * FROM '" + cube_path + "'");
+            if (HasError(result)) {
+                std::cerr << "Failed to register " << cube_path << ": " << result->GetError() << std::endl;
+                return false;
+            }
+            std::cout << "Rollups served from " << olap::kCubeFileName << "\n";
+        } else {
+            std::cout << olap::kCubeFileName << " is stale (rebuild with olap_cube); rollups scan fact_sales\n";
+        }
+    }
+    
     std::cout << "Tables registered successfully!\n";
     return true;
 }
 
+std::string DuckDBOLAPAnalyzer::RollupSource(const std::vector<std::string>& levels) const {
+    const std::vector<std::string>* grouping_set = olap::FindGroupingSet(levels);
+    if (cube_fresh_ && grouping_set) {
+        // Null levels hold facts without a dimension row, which the joins
+        // below would drop
+        std::string known;
+        for (const auto& level : levels) {
+            known += " AND " + level + " IS NOT NULL";
+        }
+        return "(SELECT * FROM sales_cube WHERE " + std::string(olap::kGroupingSetColumn) + " = '" +
+               olap::GroupingSetName(*grouping_set) + "'" + known + ") s";
+    }
+    std::string columns;
+    std::string joins;
+    for (const auto& level : levels) {
+        const olap::CubeHierarchy* hierarchy = olap::FindHierarchy(level);
+        columns += hierarchy->table + "." + level + ", ";
+        const std::string join = " JOIN " + hierarchy->table + " ON fact_sales." + hierarchy->key + " = " +
+                                 hierarchy->table + "." + hierarchy->key;
+        if (joins.find(join) == std::string::npos) {
+            joins += join;
+        }
+    }
+    return "(SELECT " + columns + "fact_sales.gross_sales, fact_sales.profit, fact_sales.quantity, " +
+           "1 AS " + olap::kRecordsColumn + " FROM fact_sales" + joins + ") s";
+}
+
 void DuckDBOLAPAnalyzer::PrintDataInfo() {
     std::cout << "\nData registered successfully!\n";
     
@@ -109,42 +216,41 @@ void DuckDBOLAPAnalyzer::PrintDataInfo() {
 }
 
 bool DuckDBOLAPAnalyzer::AnalyzeSalesByTime() {
+    olap::TraceSpan trace(olap::kStageAnalysis, "Time Analysis");
     std::cout << "\nSALES ANALYSIS BY TIME (DuckDB C++)\n";
     std::cout << "====================================\n";
     
     // Sales by year
-    auto yearly_sales = ExecuteQuery(R"(
+    auto yearly_sales = ExecutePrepared("yearly_sales", R"(
         SELECT 
-            t.year,
+            s.year,
             ROUND(SUM(s.gross_sales), 2) as gross_sales,
             ROUND(SUM(s.profit), 2) as profit,
             SUM(s.quantity) as quantity
-        FROM fact_sales s
-        JOIN dim_time t ON s.date_key = t.date_key
-        GROUP BY t.year
-        ORDER BY t.year
+        FROM )" + RollupSource({"year"}) + R"(
+        GROUP BY s.year
+        ORDER BY s.year
     )");
     
     PrintQueryResult(std::move(yearly_sales), "Sales by Year");
     
     // Sales by quarter (last 8 quarters)
-    auto quarterly_sales = ExecuteQuery(R"(
+    auto quarterly_sales = ExecutePrepared("quarterly_sales", R"(
         SELECT 
-            t.year,
-            t.quarter,
+            s.year,
+            s.quarter,
             ROUND(SUM(s.gross_sales), 2) as gross_sales,
             ROUND(SUM(s.profit), 2) as profit
-        FROM fact_sales s
-        JOIN dim_time t ON s.date_key = t.date_key
-        GROUP BY t.year, t.quarter
-        ORDER BY t.year, t.quarter
+        FROM )" + RollupSource({"year", "quarter"}) + R"(
+        GROUP BY s.year, s.quarter
+        ORDER BY s.year, s.quarter
         LIMIT 8
     )");
     
     PrintQueryResult(std::move(quarterly_sales), "Sales by Quarter (last 8 quarters)");
     
     // Weekend vs Weekday analysis
-    auto weekend_analysis = ExecuteQuery(R"(
+    auto weekend_analysis = ExecutePrepared("weekend_analysis", R"(
         SELECT 
             CASE WHEN t.is_weekend = 1 THEN 'Weekend' ELSE 'Weekday' END as day_type,
             ROUND(SUM(s.gross_sales), 2) as total_sales,
@@ -163,33 +269,32 @@ bool DuckDBOLAPAnalyzer::AnalyzeSalesByTime() {
 }
 
 bool DuckDBOLAPAnalyzer::AnalyzeSalesByGeography() {
+    olap::TraceSpan trace(olap::kStageAnalysis, "Geography Analysis");
     std::cout << "\n\nSALES ANALYSIS BY GEOGRAPHY (DuckDB C++)\n";
     std::cout << "=========================================\n";
     
     // Sales by region
-    auto regional_sales = ExecuteQuery(R"(
+    auto regional_sales = ExecutePrepared("regional_sales", R"(
         SELECT 
-            g.region,
+            s.region,
             ROUND(SUM(s.gross_sales), 2) as gross_sales,
             ROUND(SUM(s.profit), 2) as profit,
             SUM(s.quantity) as quantity
-        FROM fact_sales s
-        JOIN dim_geography g ON s.geography_key = g.geography_key
-        GROUP BY g.region
+        FROM )" + RollupSource({"region"}) + R"(
+        GROUP BY s.region
         ORDER BY SUM(s.gross_sales) DESC
     )");
     
     PrintQueryResult(std::move(regional_sales), "Sales by Region");
     
     // Top 10 countries
-    auto country_sales = ExecuteQuery(R"(
+    auto country_sales = ExecutePrepared("country_sales", R"(
         SELECT 
-            g.country,
+            s.country,
             ROUND(SUM(s.gross_sales), 2) as gross_sales,
             ROUND(SUM(s.profit), 2) as profit
-        FROM fact_sales s
-        JOIN dim_geography g ON s.geography_key = g.geography_key
-        GROUP BY g.country
+        FROM )" + RollupSource({"country"}) + R"(
+        GROUP BY s.country
         ORDER BY SUM(s.gross_sales) DESC
         LIMIT 10
     )");
@@ -200,39 +305,38 @@ bool DuckDBOLAPAnalyzer::AnalyzeSalesByGeography() {
 }
 
 bool DuckDBOLAPAnalyzer::AnalyzeSalesByProduct() {
+    olap::TraceSpan trace(olap::kStageAnalysis, "Product Analysis");
     std::cout << "\n\nSALES ANALYSIS BY PRODUCT (DuckDB C++)\n";
     std::cout << "======================================\n";
     
     // Sales by category
-    auto category_sales = ExecuteQuery(R"(
+    auto category_sales = ExecutePrepared("category_sales", R"(
         SELECT 
-            p.category,
+            s.category,
             ROUND(SUM(s.gross_sales), 2) as gross_sales,
             ROUND(SUM(s.profit), 2) as profit,
             SUM(s.quantity) as quantity
-        FROM fact_sales s
-        JOIN dim_product p ON s.product_key = p.product_key
-        GROUP BY p.category
+        FROM )" + RollupSource({"category"}) + R"(
+        GROUP BY s.category
         ORDER BY SUM(s.gross_sales) DESC
     )");
     
     PrintQueryResult(std::move(category_sales), "Sales by Category");
     
     // Profit margin by category
-    auto profit_margin = ExecuteQuery(R"(
+    auto profit_margin = ExecutePrepared("profit_margin", R"(
         SELECT 
-            p.category,
+            s.category,
             ROUND(SUM(s.profit) / SUM(s.gross_sales) * 100, 2) as profit_margin_pct
-        FROM fact_sales s
-        JOIN dim_product p ON s.product_key = p.product_key
-        GROUP BY p.category
+        FROM )" + RollupSource({"category"}) + R"(
+        GROUP BY s.category
         ORDER BY SUM(s.profit) / SUM(s.gross_sales) DESC
     )");
     
     PrintQueryResult(std::move(profit_margin), "Profit Margin by Category (%)");
     
     // Top 10 products
-    auto product_sales = ExecuteQuery(R"(
+    auto product_sales = ExecutePrepared("product_sales", R"(
         SELECT 
             p.product_name,
             ROUND(SUM(s.gross_sales), 2) as gross_sales,
@@ -250,11 +354,12 @@ bool DuckDBOLAPAnalyzer::AnalyzeSalesByProduct() {
 }
 
 bool DuckDBOLAPAnalyzer::AnalyzeCustomerSegments() {
+    olap::TraceSpan trace(olap::kStageAnalysis, "Customer Analysis");
     std::cout << "\n\nCUSTOMER SEGMENT ANALYSIS (DuckDB C++)\n";
     std::cout << "======================================\n";
     
     // Sales by customer type
-    auto customer_sales = ExecuteQuery(R"(
+    auto customer_sales = ExecutePrepared("customer_sales", R"(
         SELECT 
             c.customer_type,
             ROUND(SUM(s.gross_sales), 2) as total_sales,
@@ -274,30 +379,28 @@ bool DuckDBOLAPAnalyzer::AnalyzeCustomerSegments() {
 }
 
 bool DuckDBOLAPAnalyzer::MultidimensionalAnalysis() {
+    olap::TraceSpan trace(olap::kStageAnalysis, "Multidimensional Analysis");
     std::cout << "\n\nMULTIDIMENSIONAL ANALYSIS (DuckDB C++)\n";
     std::cout << "======================================\n";
     
     // Sales by Region and Category
-    auto region_category = ExecuteQuery(R"(
+    auto region_category = ExecutePrepared("region_category", R"(
         SELECT 
-            g.region,
-            p.category,
+            s.region,
+            s.category,
             ROUND(SUM(s.gross_sales), 2) as gross_sales
-        FROM fact_sales s
-        JOIN dim_geography g ON s.geography_key = g.geography_key
-        JOIN dim_product p ON s.product_key = p.product_key
-        GROUP BY g.region, p.category
-        ORDER BY g.region, SUM(s.gross_sales) DESC
+        FROM )" + RollupSource({"region", "category"}) + R"(
+        GROUP BY s.region, s.category
+        ORDER BY s.region, SUM(s.gross_sales) DESC
     )");
     
     PrintQueryResult(std::move(region_category), "Sales by Region and Product Category");
     
     // Get top region for monthly trend
-    auto top_region_result = ExecuteQuery(R"(
-        SELECT g.region
-        FROM fact_sales s
-        JOIN dim_geography g ON s.geography_key = g.geography_key
-        GROUP BY g.region
+    auto top_region_result = ExecutePrepared("top_region", R"(
+        SELECT s.region
+        FROM )" + RollupSource({"region"}) + R"(
+        GROUP BY s.region
         ORDER BY SUM(s.gross_sales) DESC
         LIMIT 1
     )");
@@ -305,22 +408,18 @@ bool DuckDBOLAPAnalyzer::MultidimensionalAnalysis() {
     if (!HasError(top_region_result) && top_region_result->RowCount() > 0) {
         std::string top_region = top_region_result->GetValue(0, 0).ToString();
         
-        // Monthly trends for top region
-        std::string monthly_query = R"(
+        // Monthly trends for top region, bound as a parameter
+        auto monthly_trend = ExecutePrepared("monthly_trend", R"(
             SELECT 
-                t.year,
-                t.month,
+                s.year,
+                s.month,
                 ROUND(SUM(s.gross_sales), 2) as gross_sales
-            FROM fact_sales s
-            JOIN dim_time t ON s.date_key = t.date_key
-            JOIN dim_geography g ON s.geography_key = g.geography_key
-            WHERE g.region = ')" + top_region + R"('
-            GROUP BY t.year, t.month
-            ORDER BY t.year, t.month
+            FROM )" + RollupSource({"year", "month", "region"}) + R"(
+            WHERE s.region = $1
+            GROUP BY s.year, s.month
+            ORDER BY s.year, s.month
             LIMIT 12
-        )";
-        
-        auto monthly_trend = ExecuteQuery(monthly_query);
+        )", {duckdb::Value(top_region)});
         PrintQueryResult(std::move(monthly_trend), 
                         "Monthly Sales Trend for " + top_region + " (last 12 months)");
     }
@@ -329,6 +428,7 @@ bool DuckDBOLAPAnalyzer::MultidimensionalAnalysis() {
 }
 
 bool DuckDBOLAPAnalyzer::DemonstratePerformanceAdvantages() {
+    olap::TraceSpan trace(olap::kStageAnalysis, "Performance Demonstration");
     std::cout << "\n\nDUCKDB PERFORMANCE ADVANTAGES\n";
     std::cout << "==============================\n";
     
@@ -374,13 +474,27 @@ bool DuckDBOLAPAnalyzer::RunAllAnalyses() {
         
         PrintDataInfo();
         
+        // Hardware counters of each analysis, over all threads (OLAP_PERF_COUNTERS=1)
+        const int64_t fact_rows = olap::PerfCountersEnabled() ? std::max<int64_t>(0, CountFactRows()) : 0;
+        auto counted = [&](const char* name, bool (DuckDBOLAPAnalyzer::*analysis)()) {
+            olap::PerfCounterScope counters;
+            (this->*analysis)();
+            if (counters.enabled()) {
+                std::cout << "Hardware counters (" << name << "): " << counters.stats().ToString(fact_rows) << "\n";
+            }
+        };
+        
         // Run all analyses
-        AnalyzeSalesByTime();
-        AnalyzeSalesByGeography();
-        AnalyzeSalesByProduct();
-        AnalyzeCustomerSegments();
-        MultidimensionalAnalysis();
+        counted("time", &DuckDBOLAPAnalyzer::AnalyzeSalesByTime);
+        counted("geography", &DuckDBOLAPAnalyzer::AnalyzeSalesByGeography);
+        counted("product", &DuckDBOLAPAnalyzer::AnalyzeSalesByProduct);
+        counted("customer", &DuckDBOLAPAnalyzer::AnalyzeCustomerSegments);
+        counted("multidimensional", &DuckDBOLAPAnalyzer::MultidimensionalAnalysis);
         DemonstratePerformanceAdvantages();
+        if (!olap::FinishTrace(std::cout)) {
+            std::cerr << "Cannot write the trace to " << std::getenv("OLAP_TRACE") << std::endl;
+            return false;
+        }
         
         std::cout << "\n" << std::string(50, '=') << "\n";
         std::cout << "DuckDB C++ analysis complete!\n";
@@ -0,0 +1,311 @@
+#include "fused_aggregate.h"
+#include "arrow_kernels.h"
+#include "memory_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+namespace olap {
+
+namespace {
+
+bool IsNumeric(const arrow::DataType& type) {
+    return type.id() == arrow::Type::DOUBLE || type.id() == arrow::Type::INT32 ||
+           type.id() == arrow::Type::INT64;
+}
+
+// Validity bitmap of array, or null when it has no nulls.
+const uint8_t* ValidityOf(const arrow::Array& array) {
+    return array.null_count() > 0 ? array.null_bitmap_data() : nullptr;
+}
+
+// Independent accumulators per loop so additions do not serialize on one
+// register; the compiler keeps them in vector lanes.
+constexpr int kLanes = 4;
+
+template <typename Sum, typename T>
+Sum SumDense(const T* values, int64_t begin, int64_t end) {
+    Sum lanes[kLanes] = {};
+    int64_t i = begin;
+    for (; i + kLanes <= end; i += kLanes) {
+        for (int lane = 0; lane < kLanes; ++lane) {
+            lanes[lane] += values[i + lane];
+        }
+    }
+    for (; i < end; ++i) {
+        lanes[0] += values[i];
+    }
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+template <typename T>
+double SquaredDeviationsDense(const T* values, int64_t begin, int64_t end, double mean) {
+    double lanes[kLanes] = {};
+    int64_t i = begin;
+    for (; i + kLanes <= end; i += kLanes) {
+        for (int lane = 0; lane < kLanes; ++lane) {
+            const double deviation = static_cast<double>(values[i + lane]) - mean;
+            lanes[lane] += deviation * deviation;
+        }
+    }
+    for (; i < end; ++i) {
+        const double deviation = static_cast<double>(values[i]) - mean;
+        lanes[0] += deviation * deviation;
+    }
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+// Folds the extremes of values[begin, end) (non-empty) into min and max.
+template <typename T>
+void MinMaxDense(const T* values, int64_t begin, int64_t end, double& min, double& max) {
+    T lo = values[begin], hi = values[begin];
+    for (int64_t i = begin + 1; i < end; ++i) {
+        lo = values[i] < lo ? values[i] : lo;
+        hi = values[i] > hi ? values[i] : hi;
+    }
+    min = std::min(min, static_cast<double>(lo));
+    max = std::max(max, static_cast<double>(hi));
+}
+
+template <typename N, typename D>
+double RatioSumDense(const N* numerators, const D* denominators, int64_t begin, int64_t end) {
+    double lanes[kLanes] = {};
+    int64_t i = begin;
+    for (; i + kLanes <= end; i += kLanes) {
+        for (int lane = 0; lane < kLanes; ++lane) {
+            lanes[lane] += static_cast<double>(numerators[i + lane]) /
+                           static_cast<double>(denominators[i + lane]);
+        }
+    }
+    for (; i < end; ++i) {
+        lanes[0] += static_cast<double>(numerators[i]) / static_cast<double>(denominators[i]);
+    }
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+}  // namespace
+
+int FusedAggregator::AddColumn(const arrow::Schema& schema, const std::string& name, bool min_max,
+                               bool moments) {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (columns_[i].name == name) {
+            columns_[i].min_max |= min_max;
+            columns_[i].moments |= moments;
+            return static_cast<int>(i);
+        }
+    }
+    ColumnState column;
+    column.name = name;
+    column.integral = arrow::is_integer(schema.GetFieldByName(name)->type()->id());
+    column.min_max = min_max;
+    column.moments = moments;
+    column.min = std::numeric_limits<double>::infinity();
+    column.max = -std::numeric_limits<double>::infinity();
+    columns_.push_back(column);
+    return static_cast<int>(columns_.size()) - 1;
+}
+
+arrow::Result<std::unique_ptr<FusedAggregator>> FusedAggregator::Make(const arrow::Schema& schema,
+                                                                      std::vector<AggregateSpec> specs) {
+    std::unique_ptr<FusedAggregator> aggregator(new FusedAggregator());
+    for (auto& spec : specs) {
+        std::vector<std::string> inputs = {spec.column};
+        if (spec.kind == AggregateKind::kRatioMean) {
+            inputs.push_back(spec.denominator);
+        }
+        for (const auto& name : inputs) {
+            auto field = schema.GetFieldByName(name);
+            if (!field) {
+                return arrow::Status::Invalid("Column '" + name + "' not found");
+            }
+            if (!IsNumeric(*field->type())) {
+                return arrow::Status::TypeError("Aggregate '", spec.name, "' needs a numeric column, '",
+                                                name, "' is ", field->type()->ToString());
+            }
+        }
+
+        int state;
+        if (spec.kind == AggregateKind::kRatioMean) {
+            RatioState ratio;
+            ratio.numerator = aggregator->AddColumn(schema, spec.column, false, false);
+            ratio.denominator = aggregator->AddColumn(schema, spec.denominator, false, false);
+            aggregator->ratios_.push_back(ratio);
+            state = static_cast<int>(aggregator->ratios_.size()) - 1;
+        } else {
+            const bool min_max = spec.kind == AggregateKind::kMin || spec.kind == AggregateKind::kMax;
+            const bool moments = spec.kind == AggregateKind::kVariance || spec.kind == AggregateKind::kStddev;
+            state = aggregator->AddColumn(schema, spec.column, min_max, moments);
+        }
+        aggregator->outputs_.push_back({std::move(spec), state});
+    }
+    return aggregator;
+}
+
+arrow::Status FusedAggregator::Consume(const arrow::RecordBatch& batch) {
+    // Resolve every input once per batch
+    std::vector<const arrow::Array*> arrays;
+    for (const auto& column : columns_) {
+        auto array = batch.GetColumnByName(column.name);
+        if (!array) {
+            return arrow::Status::Invalid("Column '" + column.name + "' not in batch");
+        }
+        arrays.push_back(array.get());
+    }
+
+    for (int64_t begin = 0; begin < batch.num_rows(); begin += kTileRows) {
+        const int64_t end = std::min(batch.num_rows(), begin + kTileRows);
+
+        for (size_t c = 0; c < columns_.size(); ++c) {
+            ColumnState& state = columns_[c];
+            const arrow::Array& array = *arrays[c];
+            const uint8_t* validity = ValidityOf(array);
+            ARROW_RETURN_NOT_OK(VisitNumericValues(array, [&](const auto* values) {
+                using T = std::decay_t<decltype(*values)>;
+                using Sum = std::conditional_t<std::is_integral_v<T>, int64_t, double>;
+                Sum sum = 0;
+                if (validity == nullptr) {
+                    sum = SumDense<Sum>(values, begin, end);
+                    if (state.moments) {
+                        // The tile's own moments (a second pass over L1),
+                        // merged into the running ones
+                        const double tile_mean = static_cast<double>(sum) / static_cast<double>(end - begin);
+                        MergeMoments(state.count, state.mean, state.m2, end - begin, tile_mean,
+                                     SquaredDeviationsDense(values, begin, end, tile_mean));
+                    }
+                    state.count += end - begin;
+                    if (state.min_max) {
+                        MinMaxDense(values, begin, end, state.min, state.max);
+                    }
+                } else {
+                    for (int64_t i = begin; i < end; ++i) {
+                        if (!arrow::bit_util::GetBit(validity, array.offset() + i)) {
+                            continue;
+                        }
+                        const double value = static_cast<double>(values[i]);
+                        sum += values[i];
+                        ++state.count;
+                        if (state.moments) {
+                            const double delta = value - state.mean;
+                            state.mean += delta / static_cast<double>(state.count);
+                            state.m2 += delta * (value - state.mean);
+                        }
+                        state.min = value < state.min ? value : state.min;
+                        state.max = value > state.max ? value : state.max;
+                    }
+                }
+                if constexpr (std::is_integral_v<Sum>) {
+                    state.integer_sum += sum;
+                } else {
+                    state.sum += sum;
+                }
+                return arrow::Status::OK();
+            }));
+        }
+
+        for (auto& ratio : ratios_) {
+            const arrow::Array& numerator = *arrays[ratio.numerator];
+            const arrow::Array& denominator = *arrays[ratio.denominator];
+            const uint8_t* numerator_validity = ValidityOf(numerator);
+            const uint8_t* denominator_validity = ValidityOf(denominator);
+            ARROW_RETURN_NOT_OK(VisitNumericValues(numerator, [&](const auto* numerators) {
+                return VisitNumericValues(denominator, [&](const auto* denominators) {
+                    if (numerator_validity == nullptr && denominator_validity == nullptr) {
+                        ratio.sum += RatioSumDense(numerators, denominators, begin, end);
+                        ratio.count += end - begin;
+                        return arrow::Status::OK();
+                    }
+                    for (int64_t i = begin; i < end; ++i) {
+                        if ((numerator_validity == nullptr ||
+                             arrow::bit_util::GetBit(numerator_validity, numerator.offset() + i)) &&
+                            (denominator_validity == nullptr ||
+                             arrow::bit_util::GetBit(denominator_validity, denominator.offset() + i))) {
+                            ratio.sum += static_cast<double>(numerators[i]) /
+                                         static_cast<double>(denominators[i]);
+                            ++ratio.count;
+                        }
+                    }
+                    return arrow::Status::OK();
+                });
+            }));
+        }
+    }
+    return arrow::Status::OK();
+}
+
+double FusedAggregator::OutputValue(const Output& output) const {
+    const AggregateKind kind = output.spec.kind;
+    if (kind == AggregateKind::kRatioMean) {
+        const RatioState& ratio = ratios_[output.state];
+        return ratio.count == 0 ? std::numeric_limits<double>::quiet_NaN() : ratio.sum / ratio.count;
+    }
+    const ColumnState& column = columns_[output.state];
+    if (kind == AggregateKind::kCount) {
+        return static_cast<double>(column.count);
+    }
+    if (column.count == 0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    const double sum = column.integral ? static_cast<double>(column.integer_sum) : column.sum;
+    switch (kind) {
+        case AggregateKind::kSum:
+            return sum;
+        case AggregateKind::kMin:
+            return column.min;
+        case AggregateKind::kMax:
+            return column.max;
+        case AggregateKind::kVariance:
+            return Variance(column.m2, column.count);
+        case AggregateKind::kStddev:
+            return std::sqrt(Variance(column.m2, column.count));
+        default:
+            return sum / column.count;
+    }
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> FusedAggregator::Finish() const {
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    std::vector<std::shared_ptr<arrow::Array>> arrays;
+    for (const auto& output : outputs_) {
+        const AggregateKind kind = output.spec.kind;
+        std::shared_ptr<arrow::Array> array;
+        if (kind == AggregateKind::kCount) {
+            arrow::Int64Builder builder(memory_pool());
+            ARROW_RETURN_NOT_OK(builder.Append(columns_[output.state].count));
+            ARROW_ASSIGN_OR_RAISE(array, builder.Finish());
+        } else if ((kind == AggregateKind::kSum || kind == AggregateKind::kMin || kind == AggregateKind::kMax) &&
+                   columns_[output.state].integral) {
+            const ColumnState& column = columns_[output.state];
+            arrow::Int64Builder builder(memory_pool());
+            if (column.count == 0) {
+                ARROW_RETURN_NOT_OK(builder.AppendNull());
+            } else if (kind == AggregateKind::kSum) {
+                ARROW_RETURN_NOT_OK(builder.Append(column.integer_sum));
+            } else {
+                ARROW_RETURN_NOT_OK(builder.Append(static_cast<int64_t>(OutputValue(output))));
+            }
+            ARROW_ASSIGN_OR_RAISE(array, builder.Finish());
+        } else {
+            arrow::DoubleBuilder builder(memory_pool());
+            const double value = OutputValue(output);
+            const int64_t count = kind == AggregateKind::kRatioMean ? ratios_[output.state].count
+                                                                    : columns_[output.state].count;
+            ARROW_RETURN_NOT_OK(count == 0 ? builder.AppendNull() : builder.Append(value));
+            ARROW_ASSIGN_OR_RAISE(array, builder.Finish());
+        }
+        fields.push_back(arrow::field(output.spec.name, array->type()));
+        arrays.push_back(array);
+    }
+    return arrow::RecordBatch::Make(arrow::schema(fields), 1, arrays);
+}
+
+double FusedAggregator::Value(const std::string& name) const {
+    for (const auto& output : outputs_) {
+        if (output.spec.name == name) {
+            return OutputValue(output);
+        }
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+}  // namespace olap
@@ -0,0 +1,721 @@
+#include "hash_aggregator.h"
+#include "arrow_kernels.h"
+#include "memory_pool.h"
+#include <arrow/compute/api.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace olap {
+
+namespace {
+
+// Number of bits needed to represent every value in [0, max_value].
+int BitsFor(uint64_t max_value) {
+    int bits = 1;
+    while (bits < 64 && (max_value >> bits) != 0) {
+        ++bits;
+    }
+    return bits;
+}
+
+uint64_t MixKey(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+    key *= 0xC4CEB9FE1A85EC53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+bool IsStringType(const arrow::DataType& type) {
+    return type.id() == arrow::Type::STRING || type.id() == arrow::Type::LARGE_STRING;
+}
+
+}  // namespace
+
+arrow::Result<std::unique_ptr<HashAggregator>> HashAggregator::Make(
+    const arrow::Table& table,
+    const std::vector<std::string>& group_columns,
+    const std::vector<std::string>& measure_columns) {
+
+    std::unique_ptr<HashAggregator> aggregator(new HashAggregator());
+    for (const auto& name : group_columns) {
+        auto column = table.GetColumnByName(name);
+        if (!column) {
+            return arrow::Status::Invalid("Group column '" + name + "' not found");
+        }
+        KeyColumn key;
+        key.name = name;
+        key.type = column->type();
+
+        if (IsStringType(*key.type) || IsStringDictionary(*key.type)) {
+            key.is_string = true;
+            key.dictionary_array = IsStringDictionary(*key.type);
+        } else if (arrow::is_integer(key.type->id())) {
+            // Key range from one pass over the column
+            int64_t min = std::numeric_limits<int64_t>::max();
+            int64_t max = std::numeric_limits<int64_t>::min();
+            for (const auto& chunk : column->chunks()) {
+                ARROW_RETURN_NOT_OK(VisitIntegerValues(*chunk, [&](const auto* values) {
+                    for (int64_t i = 0; i < chunk->length(); ++i) {
+                        if (chunk->IsValid(i)) {
+                            min = std::min<int64_t>(min, values[i]);
+                            max = std::max<int64_t>(max, values[i]);
+                        }
+                    }
+                    return arrow::Status::OK();
+                }));
+            }
+            key.ranged = true;
+            key.min = min > max ? 0 : min;
+            key.max_code = min > max ? 0 : static_cast<uint64_t>(max) - static_cast<uint64_t>(min) + 1;
+        } else {
+            return arrow::Status::TypeError("Unsupported group column type for '", name, "': ",
+                                            key.type->ToString());
+        }
+        aggregator->keys_.push_back(std::move(key));
+    }
+
+    ARROW_RETURN_NOT_OK(aggregator->Init(*table.schema(), measure_columns));
+    return aggregator;
+}
+
+arrow::Result<std::unique_ptr<HashAggregator>> HashAggregator::Make(
+    const arrow::Schema& schema,
+    const std::vector<std::string>& group_columns,
+    const std::vector<std::string>& measure_columns) {
+
+    std::unique_ptr<HashAggregator> aggregator(new HashAggregator());
+    for (const auto& name : group_columns) {
+        auto field = schema.GetFieldByName(name);
+        if (!field) {
+            return arrow::Status::Invalid("Group column '" + name + "' not found");
+        }
+        KeyColumn key;
+        key.name = name;
+        key.type = field->type();
+        key.is_string = IsStringType(*key.type) || IsStringDictionary(*key.type);
+        key.dictionary_array = IsStringDictionary(*key.type);
+        if (!key.is_string && !arrow::is_integer(key.type->id())) {
+            return arrow::Status::TypeError("Unsupported group column type for '", name, "': ",
+                                            key.type->ToString());
+        }
+        aggregator->keys_.push_back(std::move(key));
+    }
+
+    ARROW_RETURN_NOT_OK(aggregator->Init(schema, measure_columns));
+    return aggregator;
+}
+
+arrow::Status HashAggregator::Init(const arrow::Schema& schema,
+                                   const std::vector<std::string>& measure_columns) {
+    for (const auto& name : measure_columns) {
+        auto field = schema.GetFieldByName(name);
+        if (!field) {
+            return arrow::Status::Invalid("Measure column '" + name + "' not found");
+        }
+        MeasureColumn measure;
+        measure.name = name;
+        measure.integral = arrow::is_integer(field->type()->id());
+        measures_.push_back(std::move(measure));
+    }
+
+    // Assign bit ranges: ranged integer keys take exactly what their range
+    // needs, dictionary-encoded keys split the remainder of the 64-bit key.
+    int ranged_bits = 0;
+    int num_dictionary_keys = 0;
+    for (const auto& key : keys_) {
+        if (key.dictionary_encoded()) {
+            ++num_dictionary_keys;
+        } else {
+            ranged_bits += BitsFor(key.max_code);
+        }
+    }
+    int dictionary_bits = 0;
+    if (num_dictionary_keys > 0) {
+        dictionary_bits = std::min(32, (64 - ranged_bits) / num_dictionary_keys);
+    }
+    packed_ = ranged_bits <= 64 && (num_dictionary_keys == 0 || dictionary_bits >= kMinDictionaryBits);
+
+    if (packed_) {
+        int shift = 0;
+        for (auto& key : keys_) {
+            int bits = key.dictionary_encoded() ? dictionary_bits : BitsFor(key.max_code);
+            key.shift = shift;
+            if (key.dictionary_encoded()) {
+                key.max_code = (uint64_t{1} << bits) - 1;
+            }
+            shift += bits;
+        }
+        direct_ = num_dictionary_keys == 0 && shift <= kDirectAddressBits;
+        if (direct_) {
+            direct_groups_.assign(size_t{1} << shift, kNoGroup);
+        } else {
+            slot_keys_.assign(1024, 0);
+            slot_groups_.assign(1024, kNoGroup);
+        }
+    } else {
+        for (auto& key : keys_) {
+            if (key.dictionary_encoded()) {
+                key.max_code = std::numeric_limits<uint32_t>::max();
+            }
+        }
+    }
+    return arrow::Status::OK();
+}
+
+arrow::Status HashAggregator::AddQuantiles(const std::string& measure, std::vector<double> quantiles,
+                                           double compression) {
+    if (num_groups_ > 0) {
+        return arrow::Status::Invalid("AddQuantiles must precede Consume");
+    }
+    for (double q : quantiles) {
+        if (!(q >= 0 && q <= 1)) {
+            return arrow::Status::Invalid("Quantile ", q, " outside [0, 1]");
+        }
+    }
+    for (auto& column : measures_) {
+        if (column.name == measure) {
+            column.quantiles = std::move(quantiles);
+            column.compression = compression;
+            return arrow::Status::OK();
+        }
+    }
+    return arrow::Status::Invalid("Measure column '" + measure + "' not found");
+}
+
+arrow::Status HashAggregator::AddDistinctCount(const std::string& column, bool approximate) {
+    if (num_groups_ > 0) {
+        return arrow::Status::Invalid("AddDistinctCount must precede Consume");
+    }
+    DistinctColumn distinct;
+    distinct.name = column;
+    distinct.approximate = approximate;
+    distincts_.push_back(std::move(distinct));
+    return arrow::Status::OK();
+}
+
+uint64_t HashAggregator::StringCode(KeyColumn& key, std::string_view value) {
+    auto it = key.codes.find(value);
+    if (it == key.codes.end()) {
+        uint64_t code = key.dictionary.size() + 1;
+        key.dictionary.emplace_back(value);
+        it = key.codes.emplace(key.dictionary.back(), code).first;
+    }
+    return it->second;
+}
+
+uint64_t HashAggregator::IntegerCode(KeyColumn& key, int64_t value) {
+    auto it = key.int_codes.find(value);
+    if (it == key.int_codes.end()) {
+        uint64_t code = key.int_dictionary.size() + 1;
+        key.int_dictionary.push_back(value);
+        it = key.int_codes.emplace(value, code).first;
+    }
+    return it->second;
+}
+
+arrow::Result<uint64_t> HashAggregator::TranslateCode(const KeyColumn& from, uint64_t code, KeyColumn& key) {
+    if (code == 0) {
+        return 0;
+    }
+    if (key.is_string) {
+        return StringCode(key, from.dictionary[code - 1]);
+    }
+    const int64_t value = from.ranged ? from.min + static_cast<int64_t>(code - 1) : from.int_dictionary[code - 1];
+    if (!key.ranged) {
+        return IntegerCode(key, value);
+    }
+    const uint64_t translated = static_cast<uint64_t>(value - key.min) + 1;
+    if (translated == 0 || translated > key.max_code) {
+        return arrow::Status::CapacityError("Value outside the known range of group column '", key.name, "'");
+    }
+    return translated;
+}
+
+arrow::Status HashAggregator::EncodeColumn(const arrow::Array& array, KeyColumn& key,
+                                           int64_t stride, uint64_t* out) {
+    const int64_t length = array.length();
+    for (int64_t i = 0; i < length; ++i) {
+        out[i * stride] = 0;
+    }
+
+    if (key.dictionary_array) {
+        // Codes of the dictionary entries, resolved once per dictionary;
+        // Take and slices share the dictionary, so it rarely changes
+        const auto& encoded = static_cast<const arrow::DictionaryArray&>(array);
+        if (key.entries != array.data()->dictionary) {
+            const arrow::Array& dictionary = *encoded.dictionary();
+            key.entry_codes.assign(dictionary.length(), 0);
+            ARROW_RETURN_NOT_OK(VisitStringValues(dictionary, [&](int64_t i, std::string_view value) {
+                key.entry_codes[i] = StringCode(key, value);
+            }));
+            key.entries = array.data()->dictionary;
+        }
+        const uint64_t* entry_codes = key.entry_codes.data();
+        const auto& indices = *encoded.indices();
+        return VisitIntegerValues(indices, [&](const auto* values) {
+            for (int64_t i = 0; i < length; ++i) {
+                if (indices.IsValid(i)) {
+                    out[i * stride] = entry_codes[values[i]];
+                }
+            }
+            return arrow::Status::OK();
+        });
+    }
+
+    if (key.is_string) {
+        return VisitStringValues(array, [&](int64_t i, std::string_view value) {
+            out[i * stride] = StringCode(key, value);
+        });
+    }
+
+    if (!key.ranged) {
+        return VisitIntegerValues(array, [&](const auto* values) {
+            for (int64_t i = 0; i < length; ++i) {
+                if (array.IsValid(i)) {
+                    out[i * stride] = IntegerCode(key, static_cast<int64_t>(values[i]));
+                }
+            }
+            return arrow::Status::OK();
+        });
+    }
+
+    return VisitIntegerValues(array, [&](const auto* values) {
+        for (int64_t i = 0; i < length; ++i) {
+            if (array.IsValid(i)) {
+                uint64_t code = static_cast<uint64_t>(static_cast<int64_t>(values[i]) - key.min) + 1;
+                if (code == 0 || code > key.max_code) {
+                    return arrow::Status::CapacityError("Value outside the known range of group column '",
+                                                        key.name, "'");
+                }
+                out[i * stride] = code;
+            }
+        }
+        return arrow::Status::OK();
+    });
+}
+
+int32_t HashAggregator::AddGroup(const uint64_t* key_codes) {
+    group_codes_.insert(group_codes_.end(), key_codes, key_codes + keys_.size());
+    for (auto& measure : measures_) {
+        if (measure.integral) {
+            measure.integer_sum.push_back(0);
+        } else {
+            measure.sum.push_back(0.0);
+        }
+        measure.count.push_back(0);
+        measure.min.push_back(std::numeric_limits<double>::infinity());
+        measure.max.push_back(-std::numeric_limits<double>::infinity());
+        measure.mean.push_back(0.0);
+        measure.m2.push_back(0.0);
+        if (!measure.quantiles.empty()) {
+            measure.digests.emplace_back(measure.compression);
+        }
+    }
+    for (auto& distinct : distincts_) {
+        distinct.counters.emplace_back(distinct.approximate);
+    }
+    return static_cast<int32_t>(num_groups_++);
+}
+
+void HashAggregator::GrowHashTable() {
+    std::vector<uint64_t> old_keys = std::move(slot_keys_);
+    std::vector<int32_t> old_groups = std::move(slot_groups_);
+    slot_keys_.assign(old_keys.size() * 2, 0);
+    slot_groups_.assign(old_groups.size() * 2, kNoGroup);
+    const uint64_t mask = slot_keys_.size() - 1;
+    for (size_t i = 0; i < old_keys.size(); ++i) {
+        if (old_groups[i] == kNoGroup) {
+            continue;
+        }
+        uint64_t slot = MixKey(old_keys[i]) & mask;
+        while (slot_groups_[slot] != kNoGroup) {
+            slot = (slot + 1) & mask;
+        }
+        slot_keys_[slot] = old_keys[i];
+        slot_groups_[slot] = old_groups[i];
+    }
+}
+
+int32_t HashAggregator::FindOrAddGroup(uint64_t packed_key, const uint64_t* key_codes) {
+    if (direct_) {
+        int32_t& group = direct_groups_[packed_key];
+        if (group == kNoGroup) {
+            group = AddGroup(key_codes);
+        }
+        return group;
+    }
+
+    const uint64_t mask = slot_keys_.size() - 1;
+    uint64_t slot = MixKey(packed_key) & mask;
+    while (slot_groups_[slot] != kNoGroup) {
+        if (slot_keys_[slot] == packed_key) {
+            return slot_groups_[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    int32_t group = AddGroup(key_codes);
+    slot_keys_[slot] = packed_key;
+    slot_groups_[slot] = group;
+    if (2 * num_groups_ > static_cast<int64_t>(slot_keys_.size())) {
+        GrowHashTable();
+    }
+    return group;
+}
+
+int32_t HashAggregator::FindOrAddWideGroup(const uint64_t* key_codes) {
+    std::string tuple(reinterpret_cast<const char*>(key_codes), keys_.size() * sizeof(uint64_t));
+    auto it = wide_groups_.find(tuple);
+    if (it != wide_groups_.end()) {
+        return it->second;
+    }
+    int32_t group = AddGroup(key_codes);
+    wide_groups_.emplace(std::move(tuple), group);
+    return group;
+}
+
+void HashAggregator::IndexPackedGroups() {
+    size_t slots = 1024;
+    while (slots < 2 * static_cast<size_t>(num_groups_) + 1) {
+        slots *= 2;
+    }
+    slot_keys_.assign(slots, 0);
+    slot_groups_.assign(slots, kNoGroup);
+    const uint64_t mask = slots - 1;
+    for (int64_t g = 0; g < num_groups_; ++g) {
+        const uint64_t packed_key = PackKey(group_codes_.data() + g * keys_.size());
+        uint64_t slot = MixKey(packed_key) & mask;
+        while (slot_groups_[slot] != kNoGroup) {
+            slot = (slot + 1) & mask;
+        }
+        slot_keys_[slot] = packed_key;
+        slot_groups_[slot] = static_cast<int32_t>(g);
+    }
+}
+
+void HashAggregator::FitKeys() {
+    if (!packed_) {
+        return;
+    }
+    bool fits = true;
+    for (const auto& key : keys_) {
+        if (key.dictionary_encoded()) {
+            fits = fits && (key.is_string ? key.dictionary.size() : key.int_dictionary.size()) <= key.max_code;
+        }
+    }
+    if (fits) {
+        return;
+    }
+
+    // Room for twice each dictionary's current codes, plus an even share of
+    // the spare bits, capped like Init at 32 bits per key
+    int ranged_bits = 0;
+    int needed_bits = 0;
+    int num_dictionary_keys = 0;
+    std::vector<int> bits(keys_.size());
+    for (size_t k = 0; k < keys_.size(); ++k) {
+        const KeyColumn& key = keys_[k];
+        if (key.dictionary_encoded()) {
+            const uint64_t size = key.is_string ? key.dictionary.size() : key.int_dictionary.size();
+            bits[k] = BitsFor(2 * size + 1);
+            needed_bits += bits[k];
+            ++num_dictionary_keys;
+        } else {
+            bits[k] = BitsFor(key.max_code);
+            ranged_bits += bits[k];
+        }
+    }
+    bool repack = ranged_bits + needed_bits <= 64;
+    for (size_t k = 0; repack && k < keys_.size(); ++k) {
+        repack = !keys_[k].dictionary_encoded() || bits[k] <= 32;
+    }
+
+    if (repack) {
+        const int spare = (64 - ranged_bits - needed_bits) / num_dictionary_keys;
+        int shift = 0;
+        for (size_t k = 0; k < keys_.size(); ++k) {
+            KeyColumn& key = keys_[k];
+            if (key.dictionary_encoded()) {
+                bits[k] = std::min(32, bits[k] + spare);
+                key.max_code = (uint64_t{1} << bits[k]) - 1;
+            }
+            key.shift = shift;
+            shift += bits[k];
+        }
+        IndexPackedGroups();
+        return;
+    }
+
+    // Hash the full code tuple of every group from now on
+    packed_ = false;
+    direct_ = false;
+    slot_keys_.clear();
+    slot_groups_.clear();
+    for (auto& key : keys_) {
+        if (key.dictionary_encoded()) {
+            key.max_code = std::numeric_limits<uint64_t>::max();
+        }
+    }
+    for (int64_t g = 0; g < num_groups_; ++g) {
+        const uint64_t* codes = group_codes_.data() + g * keys_.size();
+        wide_groups_.emplace(std::string(reinterpret_cast<const char*>(codes), keys_.size() * sizeof(uint64_t)),
+                             static_cast<int32_t>(g));
+    }
+}
+
+uint64_t HashAggregator::PackKey(const uint64_t* key_codes) const {
+    uint64_t packed_key = 0;
+    for (size_t k = 0; k < keys_.size(); ++k) {
+        packed_key |= key_codes[k] << keys_[k].shift;
+    }
+    return packed_key;
+}
+
+arrow::Status HashAggregator::Consume(const arrow::RecordBatch& batch) {
+    const int64_t num_rows = batch.num_rows();
+    const int64_t num_keys = static_cast<int64_t>(keys_.size());
+
+    // Per-column codes, row-major
+    key_codes_.resize(num_rows * num_keys);
+    for (int64_t k = 0; k < num_keys; ++k) {
+        auto column = batch.GetColumnByName(keys_[k].name);
+        if (!column) {
+            return arrow::Status::Invalid("Group column '" + keys_[k].name + "' not in batch");
+        }
+        ARROW_RETURN_NOT_OK(EncodeColumn(*column, keys_[k], num_keys, key_codes_.data() + k));
+    }
+    FitKeys();
+
+    // Resolve group ids
+    group_ids_.resize(num_rows);
+    for (int64_t i = 0; i < num_rows; ++i) {
+        const uint64_t* row_codes = key_codes_.data() + i * num_keys;
+        if (packed_) {
+            group_ids_[i] = FindOrAddGroup(PackKey(row_codes), row_codes);
+        } else {
+            group_ids_[i] = FindOrAddWideGroup(row_codes);
+        }
+    }
+
+    // Update measure accumulators
+    for (auto& measure : measures_) {
+        auto column = batch.GetColumnByName(measure.name);
+        if (!column) {
+            return arrow::Status::Invalid("Measure column '" + measure.name + "' not in batch");
+        }
+        ARROW_RETURN_NOT_OK(AccumulateByGroup(*column, group_ids_.data(), measure.sum.data(),
+                                              measure.integer_sum.data(), measure.count.data(), measure.min.data(),
+                                              measure.max.data(), measure.mean.data(), measure.m2.data()));
+        if (!measure.quantiles.empty()) {
+            const uint8_t* validity = column->null_count() > 0 ? column->null_bitmap_data() : nullptr;
+            ARROW_RETURN_NOT_OK(VisitNumericValues(*column, [&](const auto* values) {
+                for (int64_t i = 0; i < num_rows; ++i) {
+                    if (validity == nullptr || arrow::bit_util::GetBit(validity, column->offset() + i)) {
+                        measure.digests[group_ids_[i]].Add(static_cast<double>(values[i]));
+                    }
+                }
+                return arrow::Status::OK();
+            }));
+        }
+    }
+
+    for (auto& distinct : distincts_) {
+        auto column = batch.GetColumnByName(distinct.name);
+        if (!column) {
+            return arrow::Status::Invalid("Distinct column '" + distinct.name + "' not in batch");
+        }
+        const uint8_t* validity = column->null_count() > 0 ? column->null_bitmap_data() : nullptr;
+        ARROW_RETURN_NOT_OK(VisitIntegerValues(*column, [&](const auto* values) {
+            for (int64_t i = 0; i < num_rows; ++i) {
+                if (validity == nullptr || arrow::bit_util::GetBit(validity, column->offset() + i)) {
+                    ARROW_RETURN_NOT_OK(distinct.counters[group_ids_[i]].Add(static_cast<int64_t>(values[i])));
+                }
+            }
+            return arrow::Status::OK();
+        }));
+    }
+    return arrow::Status::OK();
+}
+
+arrow::Status HashAggregator::Merge(const HashAggregator& other) {
+    const size_t num_keys = keys_.size();
+    bool compatible = other.keys_.size() == num_keys && other.measures_.size() == measures_.size() &&
+                      other.distincts_.size() == distincts_.size();
+    for (size_t k = 0; compatible && k < num_keys; ++k) {
+        compatible = other.keys_[k].name == keys_[k].name && other.keys_[k].is_string == keys_[k].is_string;
+    }
+    for (size_t m = 0; compatible && m < measures_.size(); ++m) {
+        compatible = other.measures_[m].name == measures_[m].name &&
+                     other.measures_[m].quantiles == measures_[m].quantiles;
+    }
+    for (size_t d = 0; compatible && d < distincts_.size(); ++d) {
+        compatible = other.distincts_[d].name == distincts_[d].name;
+    }
+    if (!compatible) {
+        return arrow::Status::Invalid("Cannot merge aggregators over different columns");
+    }
+
+    key_codes_.resize(num_keys);
+    for (int64_t g = 0; g < other.num_groups_; ++g) {
+        const uint64_t* other_codes = other.group_codes_.data() + g * num_keys;
+        for (size_t k = 0; k < num_keys; ++k) {
+            ARROW_ASSIGN_OR_RAISE(key_codes_[k], TranslateCode(other.keys_[k], other_codes[k], keys_[k]));
+        }
+        FitKeys();
+        const int32_t group = packed_ ? FindOrAddGroup(PackKey(key_codes_.data()), key_codes_.data())
+                                      : FindOrAddWideGroup(key_codes_.data());
+
+        for (size_t m = 0; m < measures_.size(); ++m) {
+            MeasureColumn& measure = measures_[m];
+            const MeasureColumn& partial = other.measures_[m];
+            if (measure.integral) {
+                measure.integer_sum[group] += partial.integer_sum[g];
+            } else {
+                measure.sum[group] += partial.sum[g];
+            }
+            MergeMoments(measure.count[group], measure.mean[group], measure.m2[group],
+                         partial.count[g], partial.mean[g], partial.m2[g]);
+            measure.count[group] += partial.count[g];
+            measure.min[group] = std::min(measure.min[group], partial.min[g]);
+            measure.max[group] = std::max(measure.max[group], partial.max[g]);
+            if (!measure.quantiles.empty()) {
+                measure.digests[group].Merge(partial.digests[g]);
+            }
+        }
+        for (size_t d = 0; d < distincts_.size(); ++d) {
+            ARROW_RETURN_NOT_OK(distincts_[d].counters[group].Merge(other.distincts_[d].counters[g]));
+        }
+    }
+    return arrow::Status::OK();
+}
+
+arrow::Result<std::shared_ptr<arrow::Table>> HashAggregator::Finish() const {
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    std::vector<std::shared_ptr<arrow::Array>> columns;
+    const size_t num_keys = keys_.size();
+
+    for (size_t k = 0; k < num_keys; ++k) {
+        const KeyColumn& key = keys_[k];
+        std::shared_ptr<arrow::Array> array;
+        if (key.dictionary_array) {
+            arrow::StringBuilder values(memory_pool());
+            for (const auto& value : key.dictionary) {
+                ARROW_RETURN_NOT_OK(values.Append(value));
+            }
+            arrow::Int32Builder indices(memory_pool());
+            for (int64_t g = 0; g < num_groups_; ++g) {
+                uint64_t code = group_codes_[g * num_keys + k];
+                ARROW_RETURN_NOT_OK(code == 0 ? indices.AppendNull()
+                                              : indices.Append(static_cast<int32_t>(code - 1)));
+            }
+            ARROW_ASSIGN_OR_RAISE(auto dictionary, values.Finish());
+            ARROW_ASSIGN_OR_RAISE(auto codes, indices.Finish());
+            ARROW_ASSIGN_OR_RAISE(array, arrow::DictionaryArray::FromArrays(
+                                             arrow::dictionary(arrow::int32(), arrow::utf8()), codes, dictionary));
+        } else if (key.is_string) {
+            arrow::StringBuilder builder(memory_pool());
+            for (int64_t g = 0; g < num_groups_; ++g) {
+                uint64_t code = group_codes_[g * num_keys + k];
+                ARROW_RETURN_NOT_OK(code == 0 ? builder.AppendNull()
+                                              : builder.Append(key.dictionary[code - 1]));
+            }
+            ARROW_ASSIGN_OR_RAISE(array, builder.Finish());
+        } else {
+            arrow::Int64Builder builder(memory_pool());
+            for (int64_t g = 0; g < num_groups_; ++g) {
+                uint64_t code = group_codes_[g * num_keys + k];
+                if (code == 0) {
+                    ARROW_RETURN_NOT_OK(builder.AppendNull());
+                } else {
+                    ARROW_RETURN_NOT_OK(builder.Append(key.ranged ? key.min + static_cast<int64_t>(code - 1)
+                                                                  : key.int_dictionary[code - 1]));
+                }
+            }
+            ARROW_ASSIGN_OR_RAISE(array, builder.Finish());
+            ARROW_ASSIGN_OR_RAISE(auto cast, arrow::compute::Cast(array, key.type, arrow::compute::CastOptions::Safe(),
+                                                                        exec_context()));
+            array = cast.make_array();
+        }
+        fields.push_back(arrow::field(key.name, array->type()));
+        columns.push_back(array);
+    }
+
+    for (const auto& measure : measures_) {
+        auto value_type = measure.integral ? arrow::int64() : arrow::float64();
+        std::unique_ptr<arrow::ArrayBuilder> sum, min, max;
+        ARROW_RETURN_NOT_OK(arrow::MakeBuilder(memory_pool(), value_type, &sum));
+        ARROW_RETURN_NOT_OK(arrow::MakeBuilder(memory_pool(), value_type, &min));
+        ARROW_RETURN_NOT_OK(arrow::MakeBuilder(memory_pool(), value_type, &max));
+        arrow::Int64Builder count(memory_pool());
+        arrow::DoubleBuilder mean(memory_pool()), variance(memory_pool()), stddev(memory_pool());
+
+        auto append = [&](arrow::ArrayBuilder& builder, double value) {
+            if (measure.integral) {
+                return static_cast<arrow::Int64Builder&>(builder).Append(static_cast<int64_t>(value));
+            }
+            return static_cast<arrow::DoubleBuilder&>(builder).Append(value);
+        };
+
+        for (int64_t g = 0; g < num_groups_; ++g) {
+            ARROW_RETURN_NOT_OK(count.Append(measure.count[g]));
+            if (measure.count[g] == 0) {
+                ARROW_RETURN_NOT_OK(sum->AppendNull());
+                ARROW_RETURN_NOT_OK(min->AppendNull());
+                ARROW_RETURN_NOT_OK(max->AppendNull());
+                ARROW_RETURN_NOT_OK(mean.AppendNull());
+                ARROW_RETURN_NOT_OK(variance.AppendNull());
+                ARROW_RETURN_NOT_OK(stddev.AppendNull());
+                continue;
+            }
+            const double group_sum =
+                measure.integral ? static_cast<double>(measure.integer_sum[g]) : measure.sum[g];
+            if (measure.integral) {
+                ARROW_RETURN_NOT_OK(static_cast<arrow::Int64Builder&>(*sum).Append(measure.integer_sum[g]));
+            } else {
+                ARROW_RETURN_NOT_OK(append(*sum, group_sum));
+            }
+            ARROW_RETURN_NOT_OK(append(*min, measure.min[g]));
+            ARROW_RETURN_NOT_OK(append(*max, measure.max[g]));
+            ARROW_RETURN_NOT_OK(mean.Append(group_sum / measure.count[g]));
+            const double group_variance = Variance(measure.m2[g], measure.count[g]);
+            ARROW_RETURN_NOT_OK(variance.Append(group_variance));
+            ARROW_RETURN_NOT_OK(stddev.Append(std::sqrt(group_variance)));
+        }
+
+        std::vector<std::pair<std::string, arrow::ArrayBuilder*>> outputs = {
+            {"_sum", sum.get()}, {"_count", &count}, {"_min", min.get()}, {"_max", max.get()},
+            {"_mean", &mean}, {"_variance", &variance}, {"_stddev", &stddev}};
+        for (auto& [suffix, builder] : outputs) {
+            ARROW_ASSIGN_OR_RAISE(auto array, builder->Finish());
+            fields.push_back(arrow::field(measure.name + suffix, array->type()));
+            columns.push_back(array);
+        }
+
+        for (double q : measure.quantiles) {
+            arrow::DoubleBuilder quantile(memory_pool());
+            for (int64_t g = 0; g < num_groups_; ++g) {
+                ARROW_RETURN_NOT_OK(measure.count[g] == 0 ? quantile.AppendNull()
+                                                          : quantile.Append(measure.digests[g].Quantile(q)));
+            }
+            ARROW_ASSIGN_OR_RAISE(auto array, quantile.Finish());
+            fields.push_back(arrow::field(measure.name + "_" + PercentileName(q), array->type()));
+            columns.push_back(array);
+        }
+    }
+
+    for (const auto& distinct : distincts_) {
+        arrow::Int64Builder builder(memory_pool());
+        for (int64_t g = 0; g < num_groups_; ++g) {
+            ARROW_RETURN_NOT_OK(builder.Append(distinct.counters[g].Count()));
+        }
+        ARROW_ASSIGN_OR_RAISE(auto array, builder.Finish());
+        fields.push_back(arrow::field(distinct.name + "_distinct", array->type()));
+        columns.push_back(array);
+    }
+
+    return arrow::Table::Make(arrow::schema(fields), columns, num_groups_);
+}
+
+}  // namespace olap
@@ -0,0 +1,89 @@
+#include "hash_join.h"
+#include "arrow_kernels.h"
+#include <algorithm>
+#include <array>
+
+namespace olap {
+
+arrow::Status JoinHashTable::Build(const arrow::ChunkedArray& keys) {
+    const int64_t num_rows = keys.length();
+    keys_.assign(num_rows, 0);
+    next_.assign(num_rows, kNoMatch);
+    std::vector<bool> valid(num_rows, true);
+
+    int64_t base_row = 0;
+    for (const auto& chunk : keys.chunks()) {
+        ARROW_RETURN_NOT_OK(GatherIntegers(*chunk, keys_.data() + base_row));
+        for (int64_t i = 0; i < chunk->length(); ++i) {
+            valid[base_row + i] = chunk->IsValid(i);
+        }
+        base_row += chunk->length();
+    }
+
+    // Power-of-two bucket count with a load factor of at most 0.5
+    int bits = 1;
+    while ((int64_t{1} << bits) < 2 * num_rows) {
+        ++bits;
+    }
+    shift_ = 64 - bits;
+    heads_.assign(size_t{1} << bits, kNoMatch);
+    unique_keys_ = true;
+
+    // Insert back to front so that each chain lists rows in build order
+    for (int64_t row = num_rows - 1; row >= 0; --row) {
+        if (!valid[row]) {
+            continue;
+        }
+        uint64_t bucket = Bucket(keys_[row]);
+        for (int64_t other = heads_[bucket]; other != kNoMatch && unique_keys_; other = next_[other]) {
+            unique_keys_ = keys_[other] != keys_[row];
+        }
+        next_[row] = heads_[bucket];
+        heads_[bucket] = row;
+    }
+    return arrow::Status::OK();
+}
+
+arrow::Status JoinHashTable::Probe(const arrow::Array& keys, int64_t base_row, JoinType join_type,
+                                   std::vector<int64_t>& left_rows,
+                                   std::vector<int64_t>& right_rows) const {
+    const int64_t length = keys.length();
+    const uint8_t* validity = keys.null_count() > 0 ? keys.null_bitmap_data() : nullptr;
+    const int64_t offset = keys.offset();
+    left_rows.reserve(left_rows.size() + length);
+    right_rows.reserve(right_rows.size() + length);
+
+    return VisitIntegerValues(keys, [&](const auto* values) {
+        std::array<int64_t, kProbeBatch> probe_keys;
+        std::array<uint64_t, kProbeBatch> buckets;
+
+        for (int64_t start = 0; start < length; start += kProbeBatch) {
+            const int64_t batch = std::min(kProbeBatch, length - start);
+            for (int64_t j = 0; j < batch; ++j) {
+                probe_keys[j] = static_cast<int64_t>(values[start + j]);
+                buckets[j] = Bucket(probe_keys[j]);
+            }
+
+            for (int64_t j = 0; j < batch; ++j) {
+                const int64_t row = start + j;
+                bool matched = false;
+                if (validity == nullptr || arrow::bit_util::GetBit(validity, offset + row)) {
+                    for (int64_t other = heads_[buckets[j]]; other != kNoMatch; other = next_[other]) {
+                        if (keys_[other] == probe_keys[j]) {
+                            left_rows.push_back(base_row + row);
+                            right_rows.push_back(other);
+                            matched = true;
+                        }
+                    }
+                }
+                if (!matched && join_type == JoinType::kLeftOuter) {
+                    left_rows.push_back(base_row + row);
+                    right_rows.push_back(kNoMatch);
+                }
+            }
+        }
+        return arrow::Status::OK();
+    });
+}
+
+}  // namespace olap
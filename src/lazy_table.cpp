@@ -0,0 +1,70 @@
+#include "lazy_table.h"
+#include <arrow/util/byte_size.h>
+#include <algorithm>
+
+namespace olap {
+
+arrow::Result<std::shared_ptr<LazyTable>> LazyTable::Open(const std::string& path,
+                                                          const LoadOptions& options) {
+    std::shared_ptr<LazyTable> table(new LazyTable());
+    ARROW_ASSIGN_OR_RAISE(table->source_, ParquetSource::Open(path, options));
+    return table;
+}
+
+arrow::Result<std::shared_ptr<LazyTable>> LazyTable::Open(std::shared_ptr<PartitionedDataset> dataset) {
+    std::shared_ptr<LazyTable> table(new LazyTable());
+    table->dataset_ = std::move(dataset);
+    return table;
+}
+
+arrow::Result<std::shared_ptr<arrow::Table>> LazyTable::ReadColumns(const std::vector<std::string>& columns) const {
+    return source_ ? source_->ReadTable(columns) : dataset_->ReadTable(columns);
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatchReader>> LazyTable::ReadBatches(
+    const std::vector<std::string>& columns, int64_t batch_rows) const {
+    return source_ ? source_->ReadBatches(columns, batch_rows) : dataset_->ReadBatches(columns, batch_rows);
+}
+
+arrow::Result<std::shared_ptr<arrow::ChunkedArray>> LazyTable::Column(const std::string& name) {
+    ARROW_ASSIGN_OR_RAISE(auto table, Select({name}));
+    return table->column(0);
+}
+
+arrow::Result<std::shared_ptr<arrow::Table>> LazyTable::Select(const std::vector<std::string>& columns) {
+    std::vector<std::string> missing;
+    for (const auto& name : columns) {
+        if (!columns_.count(name) && std::find(missing.begin(), missing.end(), name) == missing.end()) {
+            missing.push_back(name);
+        }
+    }
+    if (!missing.empty()) {
+        ARROW_ASSIGN_OR_RAISE(auto loaded, ReadColumns(missing));
+        for (int i = 0; i < loaded->num_columns(); ++i) {
+            columns_[missing[i]] = loaded->column(i);
+        }
+    }
+
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    std::vector<std::shared_ptr<arrow::ChunkedArray>> arrays;
+    for (const auto& name : columns) {
+        fields.push_back(schema()->GetFieldByName(name));
+        arrays.push_back(columns_.at(name));
+    }
+    return arrow::Table::Make(arrow::schema(fields), arrays, num_rows());
+}
+
+std::shared_ptr<arrow::ChunkedArray> LazyTable::LoadedColumn(const std::string& name) const {
+    auto it = columns_.find(name);
+    return it == columns_.end() ? nullptr : it->second;
+}
+
+int64_t LazyTable::loaded_bytes() const {
+    int64_t bytes = 0;
+    for (const auto& [name, column] : columns_) {
+        bytes += arrow::util::TotalBufferSize(*column);
+    }
+    return bytes;
+}
+
+}  // namespace olap
@@ -0,0 +1,49 @@
+#include "data_generator.h"
+#include "memory_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+/**
+ * Generates the OLAP star schema of generate_olap_data.py natively, with
+ * the fact table streamed to Parquet row group by row group.
+ *
+ * Usage: olap_datagen [data_dir]
+ *   data_dir defaults to $OLAP_DATA_PATH, then "olap_data". The number of
+ *   sales records, row group size, threads, seed and partitioning come from
+ *   GeneratorOptions::FromEnvironment.
+ */
+int main(int argc, char** argv) {
+    std::string data_path = "olap_data";
+    if (argc > 1) {
+        data_path = argv[1];
+    } else if (std::getenv("OLAP_DATA_PATH")) {
+        data_path = std::getenv("OLAP_DATA_PATH");
+    }
+    const auto options = olap::GeneratorOptions::FromEnvironment();
+
+    std::cout << "Generating " << options.sales_records << " sales records into " << data_path
+              << (options.partition_facts ? " (partitioned by year and month)" : "") << "...\n";
+    auto start_time = std::chrono::high_resolution_clock::now();
+    olap::AllocationScope allocations;
+    auto stats = olap::GenerateStarSchema(data_path, options);
+    if (!stats.ok()) {
+        std::cerr << "Data generation failed: " << stats.status().ToString() << std::endl;
+        return 1;
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - start_time);
+
+    std::cout << "Time dimension: " << stats->time_rows << " records\n";
+    std::cout << "Geography dimension: " << stats->geography_rows << " records\n";
+    std::cout << "Product dimension: " << stats->product_rows << " records\n";
+    std::cout << "Customer dimension: " << stats->customer_rows << " records\n";
+    std::cout << "Sales fact table: " << stats->fact_rows << " records in " << stats->fact_files << " file(s), "
+              << stats->fact_row_groups << " row group(s)\n";
+    std::cout << "Generated in " << duration.count() << " milliseconds ("
+              << static_cast<int64_t>(stats->fact_rows * 1000.0 / std::max<int64_t>(1, duration.count()))
+              << " rows/sec)\n";
+    std::cout << "Arrow memory: " << allocations.stats().ToString() << "\n";
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include "memory_pool.h"
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <sys/resource.h>
+
+namespace olap {
+
+namespace {
+
+std::string FormatBytes(int64_t bytes) {
+    static const char* kUnits[] = {"B", "KB", "MB", "GB", "TB"};
+    double value = static_cast<double>(bytes);
+    int unit = 0;
+    while (std::abs(value) >= 1024 && unit < 4) {
+        value /= 1024;
+        ++unit;
+    }
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(unit == 0 ? 0 : 1) << value << " " << kUnits[unit];
+    return out.str();
+}
+
+}  // namespace
+
+void TrackingMemoryPool::Grow(int64_t bytes) {
+    const int64_t held = bytes_allocated_.fetch_add(bytes) + bytes;
+    int64_t peak = max_memory_.load();
+    while (held > peak && !max_memory_.compare_exchange_weak(peak, held)) {
+    }
+}
+
+arrow::Status TrackingMemoryPool::Allocate(int64_t size, int64_t alignment, uint8_t** out) {
+    ARROW_RETURN_NOT_OK(backend_.load()->Allocate(size, alignment, out));
+    Grow(size);
+    total_bytes_allocated_.fetch_add(size);
+    num_allocations_.fetch_add(1);
+    return arrow::Status::OK();
+}
+
+arrow::Status TrackingMemoryPool::Reallocate(int64_t old_size, int64_t new_size, int64_t alignment,
+                                             uint8_t** ptr) {
+    ARROW_RETURN_NOT_OK(backend_.load()->Reallocate(old_size, new_size, alignment, ptr));
+    Grow(new_size - old_size);
+    if (new_size > old_size) {
+        total_bytes_allocated_.fetch_add(new_size - old_size);
+        num_allocations_.fetch_add(1);
+    }
+    return arrow::Status::OK();
+}
+
+void TrackingMemoryPool::Free(uint8_t* buffer, int64_t size, int64_t alignment) {
+    backend_.load()->Free(buffer, size, alignment);
+    bytes_allocated_.fetch_sub(size);
+}
+
+arrow::Status TrackingMemoryPool::SetBackend(arrow::MemoryPool* backend) {
+    if (backend == backend_.load()) {
+        return arrow::Status::OK();
+    }
+    if (bytes_allocated() != 0) {
+        return arrow::Status::Invalid("Cannot switch to ", backend->backend_name(), " with ",
+                                      FormatBytes(bytes_allocated()), " allocated from ", backend_name());
+    }
+    backend_.store(backend);
+    return arrow::Status::OK();
+}
+
+arrow::Result<arrow::MemoryPool*> MemoryPoolBackend(const std::string& name) {
+    if (name == "default") {
+        return arrow::default_memory_pool();
+    }
+    if (name == "system") {
+        return arrow::system_memory_pool();
+    }
+    arrow::MemoryPool* pool = nullptr;
+    if (name == "jemalloc") {
+        ARROW_RETURN_NOT_OK(arrow::jemalloc_memory_pool(&pool));
+        return pool;
+    }
+    if (name == "mimalloc") {
+        ARROW_RETURN_NOT_OK(arrow::mimalloc_memory_pool(&pool));
+        return pool;
+    }
+    return arrow::Status::Invalid("Unknown memory pool '", name, "' (system, jemalloc, mimalloc or default)");
+}
+
+TrackingMemoryPool* memory_pool() {
+    static TrackingMemoryPool pool(arrow::default_memory_pool());
+    return &pool;
+}
+
+arrow::Status SelectMemoryPool(const std::string& name) {
+    ARROW_ASSIGN_OR_RAISE(auto backend, MemoryPoolBackend(name));
+    return memory_pool()->SetBackend(backend);
+}
+
+arrow::compute::ExecContext* exec_context() {
+    static arrow::compute::ExecContext context(memory_pool());
+    return &context;
+}
+
+std::string PeakResidentSize() {
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return "unknown";
+    }
+#ifdef __APPLE__
+    return FormatBytes(usage.ru_maxrss);  // bytes
+#else
+    return FormatBytes(static_cast<int64_t>(usage.ru_maxrss) * 1024);  // kilobytes
+#endif
+}
+
+std::string AllocationStats::ToString() const {
+    return FormatBytes(bytes_allocated) + " in " + std::to_string(allocations) + " allocations, peak " +
+           FormatBytes(peak_bytes) + " (" + backend + ")";
+}
+
+AllocationScope::AllocationScope()
+    : start_bytes_held_(memory_pool()->bytes_allocated()),
+      start_total_bytes_(memory_pool()->total_bytes_allocated()),
+      start_allocations_(memory_pool()->num_allocations()) {
+    memory_pool()->ResetPeak();
+}
+
+AllocationStats AllocationScope::stats() const {
+    const TrackingMemoryPool* pool = memory_pool();
+    AllocationStats stats;
+    stats.bytes_allocated = pool->total_bytes_allocated() - start_total_bytes_;
+    stats.peak_bytes = pool->max_memory() - start_bytes_held_;
+    stats.allocations = pool->num_allocations() - start_allocations_;
+    stats.backend = pool->backend_name();
+    return stats;
+}
+
+}  // namespace olap
@@ -0,0 +1,103 @@
+#include "morsel_executor.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace olap {
+
+MorselExecutor::MorselExecutor(int num_threads, int64_t morsel_rows)
+    : num_threads_(num_threads > 0 ? num_threads
+                                   : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))),
+      morsel_rows_(std::max<int64_t>(1, morsel_rows)) {}
+
+MorselExecutor MorselExecutor::FromEnvironment() {
+    int threads = 0;
+    int64_t morsel_rows = kDefaultMorselRows;
+    if (std::getenv("OLAP_EXEC_THREADS")) {
+        threads = std::max(0, std::atoi(std::getenv("OLAP_EXEC_THREADS")));
+    }
+    if (std::getenv("OLAP_MORSEL_ROWS")) {
+        morsel_rows = std::atoll(std::getenv("OLAP_MORSEL_ROWS"));
+    }
+    return MorselExecutor(threads, morsel_rows);
+}
+
+arrow::Status MorselExecutor::Run(const arrow::Table& table, const MorselFn& fn) const {
+    // Slicing is zero-copy, so the whole morsel list is built up front
+    arrow::TableBatchReader reader(table);
+    reader.set_chunksize(morsel_rows_);
+    ARROW_ASSIGN_OR_RAISE(auto morsels, reader.ToRecordBatches());
+
+    std::atomic<size_t> next{0};
+    return RunWorkers([&]() -> arrow::Result<std::shared_ptr<arrow::RecordBatch>> {
+        const size_t index = next.fetch_add(1, std::memory_order_relaxed);
+        return index < morsels.size() ? morsels[index] : nullptr;
+    }, fn);
+}
+
+arrow::Status MorselExecutor::Run(arrow::RecordBatchReader& reader, const MorselFn& fn) const {
+    std::mutex mutex;
+    std::shared_ptr<arrow::RecordBatch> batch;
+    int64_t offset = 0;
+    bool exhausted = false;
+    return RunWorkers([&]() -> arrow::Result<std::shared_ptr<arrow::RecordBatch>> {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (!exhausted && (!batch || offset >= batch->num_rows())) {
+            ARROW_RETURN_NOT_OK(reader.ReadNext(&batch));
+            offset = 0;
+            exhausted = batch == nullptr;
+        }
+        if (exhausted) {
+            return nullptr;
+        }
+        auto morsel = batch->Slice(offset, morsel_rows_);
+        offset += morsel->num_rows();
+        return morsel;
+    }, fn);
+}
+
+arrow::Status MorselExecutor::RunWorkers(
+    const std::function<arrow::Result<std::shared_ptr<arrow::RecordBatch>>()>& next_morsel,
+    const MorselFn& fn) const {
+
+    std::atomic<bool> failed{false};
+    std::vector<arrow::Status> statuses(num_threads_);
+    auto work = [&](int worker) {
+        while (!failed.load(std::memory_order_relaxed)) {
+            auto morsel = next_morsel();
+            arrow::Status status = morsel.ok() ? arrow::Status::OK() : morsel.status();
+            if (status.ok() && *morsel == nullptr) {
+                return;
+            }
+            if (status.ok()) {
+                status = fn(worker, **morsel);
+            }
+            if (!status.ok()) {
+                statuses[worker] = status;
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+        }
+    };
+
+    if (num_threads_ == 1) {
+        work(0);
+    } else {
+        std::vector<std::thread> threads;
+        for (int worker = 0; worker < num_threads_; ++worker) {
+            threads.emplace_back(work, worker);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    for (const auto& status : statuses) {
+        ARROW_RETURN_NOT_OK(status);
+    }
+    return arrow::Status::OK();
+}
+
+}  // namespace olap
@@ -0,0 +1,443 @@
+#include "arrow_analyzer.h"
+#include "perf_counters.h"
+#ifdef OLAP_BENCH_DUCKDB
+#include "duckdb_analyzer.h"
+#endif
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Cross-engine benchmark suite: every analysis of ArrowOLAPAnalyzer and
+ * DuckDBOLAPAnalyzer, timed with Google Benchmark at each scale factor.
+ *
+ * Usage: olap_bench [--scales=1M,10M,100M,1B] [--data_root=DIR] [benchmark flags]
+ *   The data of scale factor S lives in <data_root>/sf<S> (e.g. sf10M),
+ *   generated with OLAP_SALES_RECORDS=<rows> olap_datagen <data_root>/sf<S>;
+ *   missing scale factors are skipped. data_root defaults to
+ *   $OLAP_BENCH_DATA, then "olap_bench_data".
+ *
+ * Each benchmark is one analysis on one engine and scale factor, named
+ * <engine>/<analysis>/<scale>, plus <engine>/load/<scale> for opening the
+ * tables and <engine>/cold/<scale> for opening them and running every
+ * analysis once on the fresh analyzer. The Arrow engine decodes fact
+ * columns on first use and caches them (unless OLAP_ARROW_STREAMING=1), so
+ * arrow/load only reads Parquet footers and the decoding shows up in
+ * arrow/cold; the run's context records that mode and OLAP_USE_CUBE.
+ * Unless given on the command line, runs warm up for 1 second,
+ * repeat 10 times, report the mean, median and stddev of the repetitions,
+ * and write them as JSON to olap_bench.json. Every run also reports
+ * p99_ms, the 99th percentile of its own iterations' wall times (the
+ * repetition statistics only see each run's mean). Tables are loaded once
+ * per engine and scale factor, outside the timed loops, and only one
+ * engine's tables are resident at a time; the analyses' own output is
+ * discarded while they run.
+ *
+ * With OLAP_PERF_COUNTERS=1 every run also reports hardware counters over
+ * its timed iterations (see perf_counters.h): cycles and instructions per
+ * iteration, IPC, and LLC and branch misses per fact row. Fact rows, in
+ * these and in items_per_second and fact_rows, are those the engine
+ * actually opened (after any OLAP_FACT_YEARS filter), not the nominal rows
+ * of the scale factor.
+ */
+
+namespace {
+
+struct ScaleFactor {
+    std::string name;  // e.g. 10M
+    int64_t rows;
+    std::string data_path;
+};
+
+const std::vector<std::pair<std::string, int64_t>> kScaleFactors = {
+    {"1M", 1000000}, {"10M", 10000000}, {"100M", 100000000}, {"1B", 1000000000}};
+
+// Defaults for flags not given on the command line
+const std::vector<std::string> kDefaultFlags = {
+    "--benchmark_min_warmup_time=1",
+    "--benchmark_repetitions=10",
+    "--benchmark_out=olap_bench.json",
+    "--benchmark_out_format=json",
+};
+
+// Sends std::cout to a null stream for the scope's lifetime
+class MuteOutput {
+public:
+    MuteOutput() : saved_(std::cout.rdbuf(nullptr)) {}
+    ~MuteOutput() { std::cout.rdbuf(saved_); }
+
+private:
+    std::streambuf* saved_;
+};
+
+// Nearest-rank 99th percentile
+double Percentile99(const std::vector<double>& values) {
+    std::vector<double> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+    const size_t rank = static_cast<size_t>(std::ceil(0.99 * sorted.size()));
+    return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+// Wall time of each iteration of a run, reported as the run's p99_ms
+class IterationTimes {
+public:
+    void Start() { start_ = std::chrono::steady_clock::now(); }
+    void Stop() {
+        times_.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count());
+    }
+    void Report(benchmark::State& state) const {
+        if (!times_.empty()) {
+            state.counters["p99_ms"] = Percentile99(times_);
+        }
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+    std::vector<double> times_;
+};
+
+// Adds the hardware counters of a run's iterations to its counters, or
+// labels the run with why they are unavailable
+void ReportPerfCounters(benchmark::State& state, const olap::PerfCounterScope& counters, int64_t rows) {
+    if (!counters.enabled()) {
+        return;
+    }
+    const olap::PerfCounterStats stats = counters.stats();
+    if (!stats.available) {
+        state.SetLabel("perf counters " + stats.ToString(rows));
+        return;
+    }
+    const double iterations = static_cast<double>(state.iterations());
+    const double fact_rows = iterations * rows;
+    if (stats.cycles >= 0) {
+        state.counters["cycles"] = stats.cycles / iterations;
+    }
+    if (stats.instructions >= 0) {
+        state.counters["instructions"] = stats.instructions / iterations;
+    }
+    if (stats.cycles > 0 && stats.instructions >= 0) {
+        state.counters["IPC"] = stats.ipc();
+    }
+    if (stats.llc_misses >= 0) {
+        state.counters["llc_misses_per_row"] = stats.llc_misses / fact_rows;
+    }
+    if (stats.branch_misses >= 0) {
+        state.counters["branch_misses_per_row"] = stats.branch_misses / fact_rows;
+    }
+}
+
+// Frees the analyzer of whichever LoadedAnalyzer loaded last, if it still
+// holds one
+std::function<void()> release_resident;
+
+void ReleaseResident() {
+    if (release_resident) {
+        auto release = std::move(release_resident);
+        release_resident = nullptr;
+        release();
+    }
+}
+
+// One engine's loaded analyzer, kept for the benchmarks of a scale factor.
+// Loading one (and each load benchmark) first releases whatever analyzer is
+// resident, of this engine or another, so only the tables being measured
+// are held and the Arrow memory pool can switch backends (OLAP_MEMORY_POOL)
+// for every load.
+template <typename Analyzer>
+class LoadedAnalyzer {
+public:
+    using Loader = std::function<std::string(Analyzer&)>;  // error message, or empty
+    using RowCounter = std::function<int64_t(Analyzer&)>;  // fact rows of a loaded analyzer
+
+    LoadedAnalyzer(Loader load, RowCounter count_rows)
+        : load_(std::move(load)), count_rows_(std::move(count_rows)) {}
+
+    // The analyzer for scale, loading it first if needed; null on error
+    Analyzer* Get(const ScaleFactor& scale, std::string& error) {
+        if (scale.name != scale_) {
+            ReleaseResident();
+            setenv("OLAP_DATA_PATH", scale.data_path.c_str(), 1);
+            MuteOutput mute;
+            auto analyzer = std::make_unique<Analyzer>();
+            error = load_(*analyzer);
+            if (!error.empty()) {
+                return nullptr;
+            }
+            rows_ = count_rows_(*analyzer);
+            analyzer_ = std::move(analyzer);
+            scale_ = scale.name;
+            release_resident = [this] {
+                analyzer_.reset();
+                scale_.clear();
+            };
+        }
+        return analyzer_.get();
+    }
+
+    std::string Load(Analyzer& analyzer) const { return load_(analyzer); }
+    int64_t CountRows(Analyzer& analyzer) const { return count_rows_(analyzer); }
+
+    // Fact rows of the analyzer last returned by Get
+    int64_t rows() const { return rows_; }
+
+private:
+    Loader load_;
+    RowCounter count_rows_;
+    std::unique_ptr<Analyzer> analyzer_;
+    std::string scale_;
+    int64_t rows_ = 0;
+};
+
+template <typename Analyzer>
+struct Analysis {
+    std::string name;
+    std::function<std::string(Analyzer&)> run;  // error message, or empty
+};
+
+// Registers <engine>/load/<scale>, <engine>/cold/<scale> and
+// <engine>/<analysis>/<scale> for every analysis and scale factor.
+// Analyzers loaded inside a timed loop count their fact rows with the
+// timer paused.
+template <typename Analyzer>
+void RegisterEngine(const std::string& engine, const std::vector<ScaleFactor>& scales,
+                    std::shared_ptr<LoadedAnalyzer<Analyzer>> loaded,
+                    const std::vector<Analysis<Analyzer>>& analyses) {
+    const auto configure = [](benchmark::internal::Benchmark* bench) {
+        bench->Unit(benchmark::kMillisecond)->UseRealTime();
+    };
+    for (const auto& scale : scales) {
+        configure(benchmark::RegisterBenchmark(
+            (engine + "/load/" + scale.name).c_str(), [loaded, scale](benchmark::State& state) {
+                ReleaseResident();
+                setenv("OLAP_DATA_PATH", scale.data_path.c_str(), 1);
+                IterationTimes times;
+                olap::PerfCounterScope counters;
+                int64_t rows = 0;
+                for (auto _ : state) {
+                    MuteOutput mute;
+                    times.Start();
+                    Analyzer analyzer;
+                    const std::string error = loaded->Load(analyzer);
+                    if (!error.empty()) {
+                        state.SkipWithError(error.c_str());
+                        break;
+                    }
+                    times.Stop();
+                    if (rows == 0) {
+                        state.PauseTiming();
+                        rows = loaded->CountRows(analyzer);
+                        state.ResumeTiming();
+                    }
+                }
+                ReportPerfCounters(state, counters, rows);
+                times.Report(state);
+                state.counters["fact_rows"] = static_cast<double>(rows);
+            }));
+        configure(benchmark::RegisterBenchmark(
+            (engine + "/cold/" + scale.name).c_str(), [loaded, scale, analyses](benchmark::State& state) {
+                ReleaseResident();
+                setenv("OLAP_DATA_PATH", scale.data_path.c_str(), 1);
+                IterationTimes times;
+                olap::PerfCounterScope counters;
+                int64_t rows = 0;
+                for (auto _ : state) {
+                    MuteOutput mute;
+                    times.Start();
+                    Analyzer analyzer;
+                    std::string error = loaded->Load(analyzer);
+                    for (const auto& analysis : analyses) {
+                        if (error.empty()) {
+                            error = analysis.run(analyzer);
+                        }
+                    }
+                    if (!error.empty()) {
+                        state.SkipWithError(error.c_str());
+                        break;
+                    }
+                    times.Stop();
+                    if (rows == 0) {
+                        state.PauseTiming();
+                        rows = loaded->CountRows(analyzer);
+                        state.ResumeTiming();
+                    }
+                }
+                ReportPerfCounters(state, counters, rows);
+                times.Report(state);
+                state.SetItemsProcessed(state.iterations() * rows);
+                state.counters["fact_rows"] = static_cast<double>(rows);
+            }));
+        for (const auto& analysis : analyses) {
+            configure(benchmark::RegisterBenchmark(
+                (engine + "/" + analysis.name + "/" + scale.name).c_str(),
+                [loaded, scale, analysis](benchmark::State& state) {
+                    std::string error;
+                    Analyzer* analyzer = loaded->Get(scale, error);
+                    if (!analyzer) {
+                        state.SkipWithError(error.c_str());
+                        return;
+                    }
+                    IterationTimes times;
+                    olap::PerfCounterScope counters;
+                    for (auto _ : state) {
+                        MuteOutput mute;
+                        times.Start();
+                        error = analysis.run(*analyzer);
+                        if (!error.empty()) {
+                            state.SkipWithError(error.c_str());
+                            break;
+                        }
+                        times.Stop();
+                    }
+                    ReportPerfCounters(state, counters, loaded->rows());
+                    times.Report(state);
+                    state.SetItemsProcessed(state.iterations() * loaded->rows());
+                    state.counters["fact_rows"] = static_cast<double>(loaded->rows());
+                }));
+        }
+    }
+}
+
+std::string ArrowError(const arrow::Status& status) {
+    return status.ok() ? "" : status.ToString();
+}
+
+void RegisterArrow(const std::vector<ScaleFactor>& scales) {
+    using Run = arrow::Status (ArrowOLAPAnalyzer::*)();
+    const std::vector<std::pair<std::string, Run>> methods = {
+        {"time", &ArrowOLAPAnalyzer::AnalyzeSalesByTime},
+        {"geography", &ArrowOLAPAnalyzer::AnalyzeSalesByGeography},
+        {"product", &ArrowOLAPAnalyzer::AnalyzeSalesByProduct},
+        {"customer", &ArrowOLAPAnalyzer::AnalyzeCustomerSegments},
+        {"multidimensional", &ArrowOLAPAnalyzer::MultidimensionalAnalysis},
+    };
+    std::vector<Analysis<ArrowOLAPAnalyzer>> analyses;
+    for (const auto& [name, method] : methods) {
+        Run run = method;
+        analyses.push_back({name, [run](ArrowOLAPAnalyzer& analyzer) { return ArrowError((analyzer.*run)()); }});
+    }
+    auto loaded = std::make_shared<LoadedAnalyzer<ArrowOLAPAnalyzer>>(
+        [](ArrowOLAPAnalyzer& analyzer) { return ArrowError(analyzer.LoadAllTables()); },
+        [](ArrowOLAPAnalyzer& analyzer) { return analyzer.num_fact_rows(); });
+    RegisterEngine("arrow", scales, loaded, analyses);
+}
+
+#ifdef OLAP_BENCH_DUCKDB
+void RegisterDuckDB(const std::vector<ScaleFactor>& scales) {
+    using Run = bool (DuckDBOLAPAnalyzer::*)();
+    const std::vector<std::pair<std::string, Run>> methods = {
+        {"time", &DuckDBOLAPAnalyzer::AnalyzeSalesByTime},
+        {"geography", &DuckDBOLAPAnalyzer::AnalyzeSalesByGeography},
+        {"product", &DuckDBOLAPAnalyzer::AnalyzeSalesByProduct},
+        {"customer", &DuckDBOLAPAnalyzer::AnalyzeCustomerSegments},
+        {"multidimensional", &DuckDBOLAPAnalyzer::MultidimensionalAnalysis},
+    };
+    std::vector<Analysis<DuckDBOLAPAnalyzer>> analyses;
+    for (const auto& [name, method] : methods) {
+        Run run = method;
+        const std::string error = name + " analysis failed";
+        analyses.push_back(
+            {name, [run, error](DuckDBOLAPAnalyzer& analyzer) { return (analyzer.*run)() ? "" : error; }});
+    }
+    auto loaded = std::make_shared<LoadedAnalyzer<DuckDBOLAPAnalyzer>>(
+        [](DuckDBOLAPAnalyzer& analyzer) {
+            return analyzer.RegisterParquetTables() ? std::string()
+                                                    : std::string("registering Parquet tables failed");
+        },
+        [](DuckDBOLAPAnalyzer& analyzer) { return std::max<int64_t>(0, analyzer.CountFactRows()); });
+    RegisterEngine("duckdb", scales, loaded, analyses);
+}
+#endif
+
+// Scale factors named in a comma-separated list whose data directory exists
+std::vector<ScaleFactor> FindScaleFactors(const std::string& names, const std::string& data_root) {
+    std::vector<ScaleFactor> scales;
+    std::stringstream list(names);
+    std::string name;
+    while (std::getline(list, name, ',')) {
+        auto known = std::find_if(kScaleFactors.begin(), kScaleFactors.end(),
+                                  [&](const auto& scale) { return scale.first == name; });
+        if (known == kScaleFactors.end()) {
+            std::cerr << "Unknown scale factor '" << name << "' (expected 1M, 10M, 100M or 1B)\n";
+            continue;
+        }
+        const std::string data_path = data_root + "/sf" + name;
+        if (!std::filesystem::is_directory(data_path)) {
+            std::cerr << "Skipping scale factor " << name << ": no data in " << data_path << "\n";
+            continue;
+        }
+        scales.push_back({name, known->second, data_path});
+    }
+    return scales;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string scale_names = "1M,10M,100M,1B";
+    std::string data_root = std::getenv("OLAP_BENCH_DATA") ? std::getenv("OLAP_BENCH_DATA") : "olap_bench_data";
+    std::vector<std::string> args = {argv[0]};
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--scales=", 0) == 0) {
+            scale_names = arg.substr(9);
+        } else if (arg.rfind("--data_root=", 0) == 0) {
+            data_root = arg.substr(12);
+        } else {
+            args.push_back(arg);
+        }
+    }
+    for (const auto& flag : kDefaultFlags) {
+        const std::string prefix = flag.substr(0, flag.find('=') + 1);
+        if (std::none_of(args.begin(), args.end(), [&](const std::string& arg) { return arg.rfind(prefix, 0) == 0; })) {
+            args.push_back(flag);
+        }
+    }
+
+    const std::vector<ScaleFactor> scales = FindScaleFactors(scale_names, data_root);
+    if (scales.empty()) {
+        std::cerr << "No benchmark data under " << data_root << "; generate it with\n"
+                  << "  OLAP_SALES_RECORDS=1000000 olap_datagen " << data_root << "/sf1M\n";
+        return 1;
+    }
+    RegisterArrow(scales);
+#ifdef OLAP_BENCH_DUCKDB
+    RegisterDuckDB(scales);
+#endif
+
+    std::vector<char*> benchmark_argv;
+    for (auto& arg : args) {
+        benchmark_argv.push_back(arg.data());
+    }
+    int benchmark_argc = static_cast<int>(benchmark_argv.size());
+    benchmark::Initialize(&benchmark_argc, benchmark_argv.data());
+    if (benchmark::ReportUnrecognizedArguments(benchmark_argc, benchmark_argv.data())) {
+        return 1;
+    }
+    std::string names;
+    for (const auto& scale : scales) {
+        names += (names.empty() ? "" : ",") + scale.name;
+    }
+    benchmark::AddCustomContext("olap_data_root", data_root);
+    benchmark::AddCustomContext("olap_scale_factors", names);
+    // Mirrors how the analyzers read these, so results from different modes
+    // are not compared by accident
+    const char* streaming = std::getenv("OLAP_ARROW_STREAMING");
+    const char* use_cube = std::getenv("OLAP_USE_CUBE");
+    benchmark::AddCustomContext("olap_arrow_fact_columns", streaming && std::string(streaming) == "1"
+                                                               ? "streamed per analysis"
+                                                               : "decoded on first use, cached");
+    benchmark::AddCustomContext("olap_use_cube", !use_cube || std::string(use_cube) != "0" ? "1" : "0");
+    benchmark::RunSpecifiedBenchmarks();
+    ReleaseResident();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,274 @@
+#include "parquet_source.h"
+#include "memory_pool.h"
+#include "trace.h"
+#include <arrow/array/array_dict.h>
+#include <arrow/io/file.h>
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <thread>
+
+namespace olap {
+
+namespace {
+
+arrow::Result<std::shared_ptr<arrow::io::RandomAccessFile>> OpenInput(const std::string& path,
+                                                                      const LoadOptions& options) {
+    if (options.memory_map) {
+        ARROW_ASSIGN_OR_RAISE(auto file, arrow::io::MemoryMappedFile::Open(path, arrow::io::FileMode::READ));
+        return std::static_pointer_cast<arrow::io::RandomAccessFile>(file);
+    }
+    ARROW_ASSIGN_OR_RAISE(auto file, arrow::io::ReadableFile::Open(path));
+    return std::static_pointer_cast<arrow::io::RandomAccessFile>(file);
+}
+
+// Reader over an already opened input; positional reads (ReadAt) of both
+// input kinds are thread-safe, so several readers may share one input.
+// Passing the footer metadata of an earlier reader skips parsing it again.
+arrow::Result<std::unique_ptr<parquet::arrow::FileReader>> OpenReader(
+    const std::shared_ptr<arrow::io::RandomAccessFile>& file, const LoadOptions& options,
+    bool use_threads, std::shared_ptr<parquet::FileMetaData> metadata = nullptr) {
+    parquet::ArrowReaderProperties properties;
+    properties.set_use_threads(use_threads);
+    properties.set_pre_buffer(options.pre_buffer);
+    properties.set_cache_options(options.cache_options);
+
+    parquet::arrow::FileReaderBuilder builder;
+    ARROW_RETURN_NOT_OK(builder.Open(file, parquet::ReaderProperties(memory_pool()), std::move(metadata)));
+    if (options.read_dictionary) {
+        const parquet::SchemaDescriptor* schema = builder.raw_reader()->metadata()->schema();
+        for (int i = 0; i < schema->num_columns(); ++i) {
+            if (schema->Column(i)->logical_type()->is_string()) {
+                properties.set_read_dictionary(i, true);
+            }
+        }
+    }
+    builder.memory_pool(memory_pool())->properties(properties);
+    std::unique_ptr<parquet::arrow::FileReader> reader;
+    ARROW_RETURN_NOT_OK(builder.Build(&reader));
+    return reader;
+}
+
+// Forwards to the wrapped reader, timing each batch
+class TracedBatchReader : public arrow::RecordBatchReader {
+public:
+    TracedBatchReader(std::shared_ptr<arrow::RecordBatchReader> reader, const char* name)
+        : reader_(std::move(reader)), name_(name) {}
+
+    std::shared_ptr<arrow::Schema> schema() const override { return reader_->schema(); }
+
+    arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch>* batch) override {
+        TraceSpan span(kStageDecode, name_);
+        return reader_->ReadNext(batch);
+    }
+
+    arrow::Status Close() override { return reader_->Close(); }
+
+private:
+    std::shared_ptr<arrow::RecordBatchReader> reader_;
+    const char* name_;
+};
+
+// Column names for span details
+std::string JoinNames(const std::vector<std::string>& names) {
+    std::string joined;
+    for (const auto& name : names) {
+        joined += (joined.empty() ? "" : ", ") + name;
+    }
+    return joined;
+}
+
+}  // namespace
+
+std::shared_ptr<arrow::RecordBatchReader> TraceBatches(std::shared_ptr<arrow::RecordBatchReader> reader,
+                                                       const char* name) {
+    if (!TracingEnabled()) {
+        return reader;
+    }
+    return std::make_shared<TracedBatchReader>(std::move(reader), name);
+}
+
+int LoadOptions::num_threads() const {
+    if (threads > 0) {
+        return threads;
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+LoadOptions LoadOptions::FromEnvironment() {
+    LoadOptions options;
+    if (std::getenv("OLAP_READ_THREADS")) {
+        options.threads = std::max(0, std::atoi(std::getenv("OLAP_READ_THREADS")));
+    }
+    if (std::getenv("OLAP_PRE_BUFFER")) {
+        options.pre_buffer = std::string(std::getenv("OLAP_PRE_BUFFER")) != "0";
+    }
+    if (std::getenv("OLAP_HOLE_SIZE_LIMIT")) {
+        options.cache_options.hole_size_limit = std::atoll(std::getenv("OLAP_HOLE_SIZE_LIMIT"));
+    }
+    if (std::getenv("OLAP_RANGE_SIZE_LIMIT")) {
+        options.cache_options.range_size_limit = std::atoll(std::getenv("OLAP_RANGE_SIZE_LIMIT"));
+    }
+    if (std::getenv("OLAP_MEMORY_MAP")) {
+        options.memory_map = std::string(std::getenv("OLAP_MEMORY_MAP")) == "1";
+    }
+    if (std::getenv("OLAP_READ_DICTIONARY")) {
+        options.read_dictionary = std::string(std::getenv("OLAP_READ_DICTIONARY")) != "0";
+    }
+    return options;
+}
+
+arrow::Result<std::shared_ptr<ParquetSource>> ParquetSource::Open(const std::string& path,
+                                                                  const LoadOptions& options) {
+    std::shared_ptr<ParquetSource> source(new ParquetSource());
+    source->path_ = path;
+    source->options_ = options;
+
+    ARROW_ASSIGN_OR_RAISE(source->file_, OpenInput(path, options));
+    ARROW_ASSIGN_OR_RAISE(source->reader_, OpenReader(source->file_, options, options.num_threads() > 1));
+    ARROW_RETURN_NOT_OK(source->reader_->GetSchema(&source->schema_));
+    for (int row_group : options.row_groups) {
+        if (row_group < 0 || row_group >= source->num_row_groups()) {
+            return arrow::Status::IndexError("Row group ", row_group, " out of range for ", path);
+        }
+    }
+    return source;
+}
+
+int64_t ParquetSource::num_rows() const {
+    auto metadata = reader_->parquet_reader()->metadata();
+    if (options_.row_groups.empty()) {
+        return metadata->num_rows();
+    }
+    int64_t rows = 0;
+    for (int row_group : options_.row_groups) {
+        rows += metadata->RowGroup(row_group)->num_rows();
+    }
+    return rows;
+}
+
+int ParquetSource::num_row_groups() const {
+    return reader_->num_row_groups();
+}
+
+int64_t ParquetSource::row_group_num_rows(int row_group) const {
+    return reader_->parquet_reader()->metadata()->RowGroup(row_group)->num_rows();
+}
+
+std::vector<int> ParquetSource::SelectedRowGroups() const {
+    if (!options_.row_groups.empty()) {
+        return options_.row_groups;
+    }
+    std::vector<int> row_groups(num_row_groups());
+    std::iota(row_groups.begin(), row_groups.end(), 0);
+    return row_groups;
+}
+
+arrow::Result<std::vector<int>> ParquetSource::ColumnIndices(const std::vector<std::string>& columns) const {
+    std::vector<int> indices;
+    if (columns.empty()) {
+        indices.resize(schema_->num_fields());
+        std::iota(indices.begin(), indices.end(), 0);
+        return indices;
+    }
+    for (const auto& name : columns) {
+        int index = schema_->GetFieldIndex(name);
+        if (index < 0) {
+            return arrow::Status::Invalid("Column '" + name + "' not found in " + path_);
+        }
+        indices.push_back(index);
+    }
+    return indices;
+}
+
+arrow::Result<std::vector<int>> ParquetSource::PruneRowGroups(const std::vector<ColumnPredicate>& predicates,
+                                                              PruneStats* stats) const {
+    return olap::PruneRowGroups(*reader_->parquet_reader(), SelectedRowGroups(), predicates, stats);
+}
+
+arrow::Result<std::shared_ptr<arrow::Table>> ParquetSource::ReadTable(const std::vector<std::string>& columns) {
+    return ReadRowGroups(SelectedRowGroups(), columns);
+}
+
+arrow::Result<std::shared_ptr<arrow::Table>> ParquetSource::ReadRowGroups(const std::vector<int>& row_groups,
+                                                                          const std::vector<std::string>& columns) {
+    ARROW_ASSIGN_OR_RAISE(auto indices, ColumnIndices(columns));
+    if (row_groups.empty()) {
+        // No row group survived; an empty table of the projected columns
+        std::vector<std::shared_ptr<arrow::Field>> fields;
+        for (int index : indices) {
+            fields.push_back(schema_->field(index));
+        }
+        return arrow::Table::MakeEmpty(arrow::schema(fields));
+    }
+
+    TraceSpan span(kStageDecode, "ParquetSource::ReadRowGroups");
+    if (span.active()) {
+        span.SetDetail(path_ + ": " + JoinNames(columns) + " (" + std::to_string(row_groups.size()) + " row groups)");
+    }
+    const int workers = std::min<int>(options_.num_threads(), static_cast<int>(row_groups.size()));
+    if (workers <= 1) {
+        ARROW_ASSIGN_OR_RAISE(auto table, reader_->ReadRowGroups(row_groups, indices));
+        return UnifyDictionaries(table);
+    }
+
+    // Parallel row-group decoding: every worker opens its own reader over
+    // the shared input (the pre-buffer cache is per reader) and decodes a
+    // contiguous run of row groups; the runs are stitched back together in
+    // file order, zero-copy.
+    std::vector<std::shared_ptr<arrow::Table>> parts(workers);
+    std::vector<arrow::Status> statuses(workers);
+    std::vector<std::thread> threads;
+    for (int worker = 0; worker < workers; ++worker) {
+        threads.emplace_back([&, worker] {
+            TraceSpan worker_span(kStageDecode, "decode row groups");
+            const size_t begin = row_groups.size() * worker / workers;
+            const size_t end = row_groups.size() * (worker + 1) / workers;
+            std::vector<int> assigned(row_groups.begin() + begin, row_groups.begin() + end);
+            auto reader = OpenReader(file_, options_, false, reader_->parquet_reader()->metadata());
+            if (!reader.ok()) {
+                statuses[worker] = reader.status();
+                return;
+            }
+            auto part = (*reader)->ReadRowGroups(assigned, indices);
+            if (part.ok()) {
+                parts[worker] = std::move(*part);
+            }
+            statuses[worker] = part.status();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& status : statuses) {
+        ARROW_RETURN_NOT_OK(status);
+    }
+    ARROW_ASSIGN_OR_RAISE(auto table, arrow::ConcatenateTables(parts, arrow::ConcatenateTablesOptions::Defaults(), memory_pool()));
+    return UnifyDictionaries(table);
+}
+
+arrow::Result<std::shared_ptr<arrow::Table>> ParquetSource::UnifyDictionaries(
+    const std::shared_ptr<arrow::Table>& table) const {
+    // Each row group (and each decoding thread) brings its own dictionary
+    if (!options_.read_dictionary) {
+        return table;
+    }
+    TraceSpan span(kStageDecode, "unify dictionaries");
+    return arrow::DictionaryUnifier::UnifyTable(*table, memory_pool());
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatchReader>> ParquetSource::ReadBatches(
+    const std::vector<std::string>& columns, int64_t batch_rows) {
+    return ReadRowGroupBatches(SelectedRowGroups(), columns, batch_rows);
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatchReader>> ParquetSource::ReadRowGroupBatches(
+    const std::vector<int>& row_groups, const std::vector<std::string>& columns, int64_t batch_rows) {
+
+    ARROW_ASSIGN_OR_RAISE(auto indices, ColumnIndices(columns));
+    reader_->set_batch_size(batch_rows);
+    ARROW_ASSIGN_OR_RAISE(auto reader, reader_->GetRecordBatchReader(row_groups, indices));
+    return TraceBatches(std::shared_ptr<arrow::RecordBatchReader>(std::move(reader)), "ParquetSource batch");
+}
+
+}  // namespace olap
@@ -0,0 +1,138 @@
+#include "partitioned_dataset.h"
+#include "arrow_kernels.h"
+#include "cube_layout.h"
+#include "memory_pool.h"
+#include "trace.h"
+#include <arrow/filesystem/localfs.h>
+#include <parquet/arrow/reader.h>
+#include <parquet/properties.h>
+#include <cstdlib>
+#include <filesystem>
+
+namespace olap {
+
+namespace ds = arrow::dataset;
+namespace cp = arrow::compute;
+
+namespace {
+
+arrow::Result<int> CountFragments(ds::Dataset& dataset, const cp::Expression& filter) {
+    ARROW_ASSIGN_OR_RAISE(auto fragments, dataset.GetFragments(filter));
+    int count = 0;
+    for (auto fragment : fragments) {
+        ARROW_RETURN_NOT_OK(fragment.status());
+        ++count;
+    }
+    return count;
+}
+
+}  // namespace
+
+arrow::Result<std::shared_ptr<PartitionedDataset>> PartitionedDataset::Open(const std::string& directory,
+                                                                            const LoadOptions& options) {
+    std::shared_ptr<PartitionedDataset> dataset(new PartitionedDataset());
+    dataset->directory_ = directory;
+    dataset->options_ = options;
+
+    arrow::fs::LocalFileSystemOptions filesystem_options;
+    filesystem_options.use_mmap = options.memory_map;
+    auto filesystem = std::make_shared<arrow::fs::LocalFileSystem>(filesystem_options);
+    arrow::fs::FileSelector selector;
+    selector.base_dir = std::filesystem::absolute(directory).string();
+    selector.recursive = true;
+
+    auto format = std::make_shared<ds::ParquetFileFormat>();
+    auto scan_options = std::make_shared<ds::ParquetFragmentScanOptions>();
+    scan_options->arrow_reader_properties->set_pre_buffer(options.pre_buffer);
+    scan_options->arrow_reader_properties->set_cache_options(options.cache_options);
+    format->default_fragment_scan_options = scan_options;
+
+    ds::FileSystemFactoryOptions factory_options;
+    factory_options.partitioning = ds::HivePartitioning::MakeFactory();
+    ARROW_ASSIGN_OR_RAISE(auto factory, ds::FileSystemDatasetFactory::Make(filesystem, selector, format,
+                                                                           factory_options));
+    ARROW_ASSIGN_OR_RAISE(dataset->dataset_, factory->Finish());
+    dataset->schema_ = dataset->dataset_->schema();
+    ARROW_ASSIGN_OR_RAISE(dataset->num_files_, CountFragments(*dataset->dataset_, cp::literal(true)));
+    if (dataset->num_files_ == 0) {
+        return arrow::Status::IOError("No Parquet files under ", directory);
+    }
+    ARROW_RETURN_NOT_OK(dataset->SetFilter(cp::literal(true)));
+    return dataset;
+}
+
+arrow::Result<cp::Expression> PartitionedDataset::FilterFromEnvironment() {
+    FactYears years;
+    std::string error;
+    if (!FactYearsFromEnvironment(years, error)) {
+        return arrow::Status::Invalid(error);
+    }
+    if (years.all) {
+        return cp::literal(true);
+    }
+    return cp::and_(cp::greater_equal(cp::field_ref("year"), cp::literal(static_cast<int32_t>(years.first))),
+                    cp::less_equal(cp::field_ref("year"), cp::literal(static_cast<int32_t>(years.last))));
+}
+
+arrow::Status PartitionedDataset::SetFilter(cp::Expression filter) {
+    ARROW_ASSIGN_OR_RAISE(auto bound, filter.Bind(*schema_));
+    ARROW_ASSIGN_OR_RAISE(num_selected_files_, CountFragments(*dataset_, bound));
+    filter_ = std::move(filter);
+    // Row counts come from the file footers where the filter allows it
+    ARROW_ASSIGN_OR_RAISE(auto scanner, MakeScanner({}, kDefaultBatchRows, cp::literal(true)));
+    ARROW_ASSIGN_OR_RAISE(num_rows_, scanner->CountRows());
+    return arrow::Status::OK();
+}
+
+arrow::Result<int> PartitionedDataset::CountFiles(const cp::Expression& predicate) const {
+    ARROW_ASSIGN_OR_RAISE(auto bound, cp::and_(filter_, predicate).Bind(*schema_));
+    return CountFragments(*dataset_, bound);
+}
+
+arrow::Result<PartitionedDataset::RowGroupCounts> PartitionedDataset::CountRowGroups(
+    const cp::Expression& predicate) const {
+    ARROW_ASSIGN_OR_RAISE(auto bound, cp::and_(filter_, predicate).Bind(*schema_));
+    ARROW_ASSIGN_OR_RAISE(auto fragments, dataset_->GetFragments(bound));
+    RowGroupCounts counts;
+    for (auto fragment : fragments) {
+        ARROW_RETURN_NOT_OK(fragment.status());
+        auto parquet = std::dynamic_pointer_cast<ds::ParquetFileFragment>(*fragment);
+        if (!parquet) {
+            continue;
+        }
+        ARROW_RETURN_NOT_OK(parquet->EnsureCompleteMetadata());
+        counts.row_groups += parquet->metadata()->num_row_groups();
+        ARROW_ASSIGN_OR_RAISE(auto matching, parquet->SplitByRowGroup(bound));
+        counts.matching += static_cast<int>(matching.size());
+    }
+    return counts;
+}
+
+arrow::Result<std::shared_ptr<ds::Scanner>> PartitionedDataset::MakeScanner(
+    const std::vector<std::string>& columns, int64_t batch_rows, const cp::Expression& predicate) const {
+    ARROW_ASSIGN_OR_RAISE(auto builder, dataset_->NewScan());
+    if (!columns.empty()) {
+        ARROW_RETURN_NOT_OK(builder->Project(columns));
+    }
+    ARROW_RETURN_NOT_OK(builder->Filter(cp::and_(filter_, predicate)));
+    ARROW_RETURN_NOT_OK(builder->BatchSize(batch_rows));
+    ARROW_RETURN_NOT_OK(builder->UseThreads(options_.num_threads() > 1));
+    ARROW_RETURN_NOT_OK(builder->Pool(memory_pool()));
+    return builder->Finish();
+}
+
+arrow::Result<std::shared_ptr<arrow::Table>> PartitionedDataset::ReadTable(const std::vector<std::string>& columns,
+                                                                           const cp::Expression& predicate) const {
+    TraceSpan span(kStageDecode, "PartitionedDataset::ReadTable");
+    ARROW_ASSIGN_OR_RAISE(auto scanner, MakeScanner(columns, kDefaultBatchRows, predicate));
+    return scanner->ToTable();
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatchReader>> PartitionedDataset::ReadBatches(
+    const std::vector<std::string>& columns, int64_t batch_rows, const cp::Expression& predicate) const {
+    ARROW_ASSIGN_OR_RAISE(auto scanner, MakeScanner(columns, batch_rows, predicate));
+    ARROW_ASSIGN_OR_RAISE(auto reader, scanner->ToRecordBatchReader());
+    return TraceBatches(std::move(reader), "dataset batch");
+}
+
+}  // namespace olap
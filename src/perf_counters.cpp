@@ -0,0 +1,204 @@
+#include "perf_counters.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace olap {
+
+namespace {
+
+#ifdef __linux__
+// In the order of PerfCounterStats; the first one opened leads each group
+constexpr uint64_t kEventConfigs[] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                      PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+int OpenEvent(pid_t tid, uint64_t config, int group_fd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    // The leader starts disabled and enables the whole group at once
+    attr.disabled = group_fd == -1;
+    attr.inherit = 1;
+    // User space only, which perf_event_paranoid 2 (the common default) allows
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, group_fd, PERF_FLAG_FD_CLOEXEC));
+}
+
+std::string OpenError(int error) {
+    std::string message = std::string("perf_event_open: ") + std::strerror(error);
+    if (error == EACCES || error == EPERM) {
+        std::ifstream paranoid("/proc/sys/kernel/perf_event_paranoid");
+        int level = 0;
+        if (paranoid >> level) {
+            message += " (kernel.perf_event_paranoid is " + std::to_string(level) + "; counting needs 2 or lower)";
+        }
+    } else if (error == ENOENT || error == EOPNOTSUPP) {
+        message += " (no hardware counters, e.g. a VM without a virtual PMU)";
+    }
+    return message;
+}
+
+// The calling thread first, so the events it supports decide for all
+std::vector<pid_t> ProcessThreads() {
+    const pid_t self = static_cast<pid_t>(syscall(SYS_gettid));
+    std::vector<pid_t> threads = {self};
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator("/proc/self/task", error)) {
+        const pid_t tid = static_cast<pid_t>(std::atoi(entry.path().filename().c_str()));
+        if (tid > 0 && tid != self) {
+            threads.push_back(tid);
+        }
+    }
+    return threads;
+}
+#endif
+
+// e.g. 2.13G
+std::string FormatCount(int64_t count) {
+    static const char* kUnits[] = {"", "K", "M", "G", "T"};
+    double value = static_cast<double>(count);
+    int unit = 0;
+    while (value >= 1000 && unit < 4) {
+        value /= 1000;
+        ++unit;
+    }
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(unit == 0 ? 0 : 2) << value << kUnits[unit];
+    return out.str();
+}
+
+}  // namespace
+
+bool PerfCountersEnabled() {
+    const char* enabled = std::getenv("OLAP_PERF_COUNTERS");
+    return enabled && std::string(enabled) == "1";
+}
+
+double PerfCounterStats::ipc() const {
+    return cycles > 0 && instructions >= 0 ? static_cast<double>(instructions) / cycles : 0;
+}
+
+std::string PerfCounterStats::ToString(int64_t rows) const {
+    if (!available) {
+        return "unavailable (" + error + ")";
+    }
+    std::ostringstream out;
+    out << std::fixed;
+    if (cycles > 0 && instructions >= 0) {
+        out << "IPC " << std::setprecision(2) << ipc() << " over " << FormatCount(cycles) << " cycles";
+    } else {
+        out << "IPC n/a";
+    }
+    const auto per_row = [&](int64_t count) {
+        std::ostringstream value;
+        if (count < 0 || rows <= 0) {
+            value << "n/a";
+        } else {
+            value << std::fixed << std::setprecision(3) << static_cast<double>(count) / rows;
+        }
+        return value.str();
+    };
+    out << "; per row: " << per_row(llc_misses) << " LLC misses, " << per_row(branch_misses) << " branch misses";
+    return out.str();
+}
+
+PerfCounterScope::PerfCounterScope() : enabled_(PerfCountersEnabled()) {
+    if (!enabled_) {
+        return;
+    }
+#ifdef __linux__
+    bool first = true;
+    for (pid_t tid : ProcessThreads()) {
+        std::array<int, kEvents> fds;
+        fds.fill(-1);
+        int leader = -1;
+        int first_error = 0;
+        for (int event = 0; event < kEvents; ++event) {
+            if (!first && !supported_[event]) {
+                continue;
+            }
+            const int fd = OpenEvent(tid, kEventConfigs[event], leader);
+            if (fd < 0) {
+                first_error = first_error ? first_error : errno;
+                continue;
+            }
+            supported_[event] = true;
+            leader = leader < 0 ? fd : leader;
+            fds[event] = fd;
+        }
+        if (leader < 0) {
+            // A thread that exited since it was listed is simply skipped
+            if (first) {
+                error_ = OpenError(first_error);
+                return;
+            }
+            continue;
+        }
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        fds_.push_back(fds);
+        first = false;
+    }
+#else
+    error_ = "perf events need Linux";
+#endif
+}
+
+PerfCounterScope::~PerfCounterScope() {
+#ifdef __linux__
+    for (const auto& fds : fds_) {
+        for (int fd : fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+#endif
+}
+
+PerfCounterStats PerfCounterScope::stats() const {
+    PerfCounterStats stats;
+    if (fds_.empty()) {
+        stats.error = enabled_ ? error_ : "OLAP_PERF_COUNTERS is not set";
+        return stats;
+    }
+    stats.available = true;
+    std::array<int64_t, kEvents> totals;
+    for (int event = 0; event < kEvents; ++event) {
+        totals[event] = supported_[event] ? 0 : -1;
+    }
+#ifdef __linux__
+    for (const auto& fds : fds_) {
+        for (int event = 0; event < kEvents; ++event) {
+            // value, time enabled, time running
+            uint64_t values[3];
+            if (fds[event] < 0 || read(fds[event], values, sizeof(values)) != sizeof(values) || values[2] == 0) {
+                continue;
+            }
+            // Scale up for the share of time the PMU was multiplexed away
+            totals[event] += static_cast<int64_t>(static_cast<double>(values[0]) * values[1] / values[2]);
+        }
+    }
+#endif
+    stats.cycles = totals[0];
+    stats.instructions = totals[1];
+    stats.llc_misses = totals[2];
+    stats.branch_misses = totals[3];
+    return stats;
+}
+
+}  // namespace olap
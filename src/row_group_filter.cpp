@@ -0,0 +1,182 @@
+#include "row_group_filter.h"
+#include <parquet/exception.h>
+#include <parquet/metadata.h>
+#include <parquet/page_index.h>
+#include <parquet/statistics.h>
+#include <algorithm>
+#include <memory>
+
+namespace olap {
+
+namespace {
+
+// Column chunk min/max as doubles, if the chunk has statistics.
+template <typename DType>
+bool TypedMinMax(const parquet::Statistics& statistics, double& min, double& max) {
+    const auto& typed = static_cast<const parquet::TypedStatistics<DType>&>(statistics);
+    min = static_cast<double>(typed.min());
+    max = static_cast<double>(typed.max());
+    return true;
+}
+
+bool ChunkMinMax(const parquet::ColumnChunkMetaData& chunk, double& min, double& max) {
+    auto statistics = chunk.statistics();
+    if (!statistics || !statistics->HasMinMax()) {
+        return false;
+    }
+    switch (statistics->physical_type()) {
+        case parquet::Type::INT32:
+            return TypedMinMax<parquet::Int32Type>(*statistics, min, max);
+        case parquet::Type::INT64:
+            return TypedMinMax<parquet::Int64Type>(*statistics, min, max);
+        case parquet::Type::FLOAT:
+            return TypedMinMax<parquet::FloatType>(*statistics, min, max);
+        case parquet::Type::DOUBLE:
+            return TypedMinMax<parquet::DoubleType>(*statistics, min, max);
+        default:
+            return false;
+    }
+}
+
+// True when some page of the column index may match; pages holding only
+// nulls never do.
+template <typename DType>
+bool TypedPagesMayMatch(const parquet::ColumnIndex& index, const ColumnPredicate& predicate) {
+    const auto& typed = static_cast<const parquet::TypedColumnIndex<DType>&>(index);
+    const auto& mins = typed.min_values();
+    const auto& maxs = typed.max_values();
+    for (int32_t page : typed.non_null_page_indices()) {
+        if (predicate.MayMatch(static_cast<double>(mins[page]), static_cast<double>(maxs[page]))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PagesMayMatch(const parquet::ColumnIndex& index, parquet::Type::type physical_type,
+                   const ColumnPredicate& predicate) {
+    switch (physical_type) {
+        case parquet::Type::INT32:
+            return TypedPagesMayMatch<parquet::Int32Type>(index, predicate);
+        case parquet::Type::INT64:
+            return TypedPagesMayMatch<parquet::Int64Type>(index, predicate);
+        case parquet::Type::FLOAT:
+            return TypedPagesMayMatch<parquet::FloatType>(index, predicate);
+        case parquet::Type::DOUBLE:
+            return TypedPagesMayMatch<parquet::DoubleType>(index, predicate);
+        default:
+            return true;
+    }
+}
+
+}  // namespace
+
+bool ColumnPredicate::MayMatch(double min, double max) const {
+    switch (op) {
+        case CompareOp::kEqual:
+            return min <= value && value <= max;
+        case CompareOp::kLess:
+            return min < value;
+        case CompareOp::kLessEqual:
+            return min <= value;
+        case CompareOp::kGreater:
+            return max > value;
+        case CompareOp::kGreaterEqual:
+            return max >= value;
+    }
+    return true;
+}
+
+arrow::compute::Expression ColumnPredicate::ToExpression() const {
+    namespace cp = arrow::compute;
+    auto field = cp::field_ref(column);
+    auto literal = cp::literal(value);
+    switch (op) {
+        case CompareOp::kEqual:
+            return cp::equal(field, literal);
+        case CompareOp::kLess:
+            return cp::less(field, literal);
+        case CompareOp::kLessEqual:
+            return cp::less_equal(field, literal);
+        case CompareOp::kGreater:
+            return cp::greater(field, literal);
+        case CompareOp::kGreaterEqual:
+            break;
+    }
+    return cp::greater_equal(field, literal);
+}
+
+arrow::Result<std::vector<int>> PruneRowGroups(parquet::ParquetFileReader& reader,
+                                               const std::vector<int>& candidates,
+                                               const std::vector<ColumnPredicate>& predicates,
+                                               PruneStats* stats) {
+    auto metadata = reader.metadata();
+    const parquet::SchemaDescriptor* schema = metadata->schema();
+
+    // Leaf column of every predicate; min/max pruning needs a signed sort
+    // order, which rules out unsigned integers stored as signed physical types
+    std::vector<int> leaves;
+    for (const auto& predicate : predicates) {
+        int leaf = schema->ColumnIndex(predicate.column);
+        if (leaf < 0) {
+            return arrow::Status::Invalid("Column '" + predicate.column + "' not found");
+        }
+        if (schema->Column(leaf)->sort_order() != parquet::SortOrder::SIGNED) {
+            leaf = -1;
+        }
+        leaves.push_back(leaf);
+    }
+
+    PruneStats counts;
+    std::vector<int> selected;
+    BEGIN_PARQUET_CATCH_EXCEPTIONS
+    std::shared_ptr<parquet::PageIndexReader> page_index;
+    bool page_index_loaded = false;
+
+    for (int row_group : candidates) {
+        ++counts.row_groups;
+        auto group = metadata->RowGroup(row_group);
+        bool by_statistics = false, by_page_index = false;
+
+        for (size_t p = 0; p < predicates.size() && !by_statistics && !by_page_index; ++p) {
+            if (leaves[p] < 0) {
+                continue;
+            }
+            auto chunk = group->ColumnChunk(leaves[p]);
+            double min, max;
+            if (ChunkMinMax(*chunk, min, max) && !predicates[p].MayMatch(min, max)) {
+                by_statistics = true;
+                break;
+            }
+
+            // Pages are finer than the chunk: an equality can fall in a gap
+            // between pages, and the chunk may lack statistics altogether
+            if (!page_index_loaded) {
+                page_index = reader.GetPageIndexReader();
+                page_index_loaded = true;
+            }
+            auto group_index = page_index ? page_index->RowGroup(row_group) : nullptr;
+            auto column_index = group_index ? group_index->GetColumnIndex(leaves[p]) : nullptr;
+            if (column_index &&
+                !PagesMayMatch(*column_index, schema->Column(leaves[p])->physical_type(), predicates[p])) {
+                by_page_index = true;
+            }
+        }
+
+        if (by_statistics) {
+            ++counts.skipped_by_statistics;
+        } else if (by_page_index) {
+            ++counts.skipped_by_page_index;
+        } else {
+            selected.push_back(row_group);
+        }
+    }
+    END_PARQUET_CATCH_EXCEPTIONS
+
+    if (stats) {
+        *stats = counts;
+    }
+    return selected;
+}
+
+}  // namespace olap
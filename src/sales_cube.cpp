@@ -0,0 +1,257 @@
+#include "sales_cube.h"
+#include "arrow_kernels.h"
+#include "dimension_index.h"
+#include "hash_aggregator.h"
+#include "lazy_table.h"
+#include "memory_pool.h"
+#include "trace.h"
+#include <arrow/array/concatenate.h>
+#include <arrow/compute/api.h>
+#include <arrow/io/file.h>
+#include <arrow/util/key_value_metadata.h>
+#include <parquet/arrow/writer.h>
+#include <filesystem>
+
+namespace olap {
+
+namespace {
+
+namespace cp = arrow::compute;
+
+// A hierarchy's key index and level columns, in dimension row order
+struct CubeDimension {
+    const CubeHierarchy* hierarchy;
+    std::shared_ptr<DimensionIndex> index;
+    std::vector<std::shared_ptr<arrow::Array>> levels;
+};
+
+// Left outer join of a fact batch with one dimension: every fact row plus
+// the hierarchy's level columns, null where the key has no dimension row.
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> JoinLevels(const arrow::RecordBatch& facts,
+                                                              const CubeDimension& dimension) {
+    std::vector<int64_t> left_rows, right_rows;
+    ARROW_RETURN_NOT_OK(dimension.index->Probe(*facts.GetColumnByName(dimension.hierarchy->key), 0,
+                                               JoinType::kLeftOuter, left_rows, right_rows));
+    if (static_cast<int64_t>(left_rows.size()) != facts.num_rows()) {
+        return arrow::Status::Invalid("Dimension ", dimension.hierarchy->table, " has duplicate keys");
+    }
+    // Each fact row matches at most one dimension row, so the fact rows
+    // keep their order and only the levels are gathered
+    arrow::Int64Builder right_indices(memory_pool());
+    ARROW_RETURN_NOT_OK(right_indices.Reserve(facts.num_rows()));
+    for (int64_t row : right_rows) {
+        if (row == kNoMatch) {
+            right_indices.UnsafeAppendNull();
+        } else {
+            right_indices.UnsafeAppend(row);
+        }
+    }
+    ARROW_ASSIGN_OR_RAISE(auto right, right_indices.Finish());
+    const auto take_options = cp::TakeOptions::Defaults();
+    auto batch = arrow::RecordBatch::Make(facts.schema(), facts.num_rows(), facts.columns());
+    for (size_t l = 0; l < dimension.levels.size(); ++l) {
+        ARROW_ASSIGN_OR_RAISE(auto values, cp::Take(dimension.levels[l], right, take_options, exec_context()));
+        ARROW_ASSIGN_OR_RAISE(batch, batch->AddColumn(batch->num_columns(), dimension.hierarchy->levels[l],
+                                                      values.make_array()));
+    }
+    return batch;
+}
+
+}  // namespace
+
+arrow::Result<std::shared_ptr<SalesCube>> SalesCube::Build(const std::string& data_path,
+                                                           const LoadOptions& options) {
+    // Fingerprinted before any file is opened: should a file change during
+    // the build, the cube then carries the old fingerprint and reads as
+    // stale, rather than stamping old aggregates with the new files' one
+    std::shared_ptr<SalesCube> cube(new SalesCube());
+    cube->fingerprint_ = CubeSourceFingerprint(data_path);
+    std::vector<CubeDimension> dimensions;
+    std::vector<std::shared_ptr<arrow::Field>> level_fields;
+    std::vector<std::string> fact_columns = CubeMeasures();
+    for (const auto& hierarchy : CubeHierarchies()) {
+        std::vector<std::string> columns = {hierarchy.key};
+        columns.insert(columns.end(), hierarchy.levels.begin(), hierarchy.levels.end());
+        ARROW_ASSIGN_OR_RAISE(auto source, ParquetSource::Open(data_path + "/" + hierarchy.table + ".parquet"));
+        ARROW_ASSIGN_OR_RAISE(auto table, source->ReadTable(columns));
+        CubeDimension dimension{&hierarchy, nullptr, {}};
+        ARROW_ASSIGN_OR_RAISE(dimension.index, DimensionIndex::Make(*table, hierarchy.key));
+        for (const auto& level : hierarchy.levels) {
+            ARROW_ASSIGN_OR_RAISE(auto values, arrow::Concatenate(table->GetColumnByName(level)->chunks(),
+                                                                  memory_pool()));
+            level_fields.push_back(arrow::field(level, values->type()));
+            dimension.levels.push_back(std::move(values));
+        }
+        fact_columns.push_back(hierarchy.key);
+        dimensions.push_back(std::move(dimension));
+    }
+
+    std::shared_ptr<LazyTable> facts;
+    const std::string fact_directory = data_path + "/fact_sales";
+    if (std::filesystem::is_directory(fact_directory)) {
+        ARROW_ASSIGN_OR_RAISE(auto dataset, PartitionedDataset::Open(fact_directory, options));
+        ARROW_ASSIGN_OR_RAISE(auto filter, PartitionedDataset::FilterFromEnvironment());
+        ARROW_RETURN_NOT_OK(dataset->SetFilter(filter));
+        ARROW_ASSIGN_OR_RAISE(facts, LazyTable::Open(dataset));
+    } else {
+        ARROW_ASSIGN_OR_RAISE(facts, LazyTable::Open(data_path + "/fact_sales.parquet", options));
+    }
+    ARROW_ASSIGN_OR_RAISE(auto reader, facts->ReadBatches(fact_columns, kDefaultBatchRows));
+
+    // The joined batch schema: fact columns, every hierarchy's levels, then
+    // records, a column of ones whose sums count rows (the measures' counts
+    // skip their nulls)
+    arrow::SchemaBuilder joined_schema;
+    ARROW_RETURN_NOT_OK(joined_schema.AddSchema(reader->schema()));
+    ARROW_RETURN_NOT_OK(joined_schema.AddFields(level_fields));
+    ARROW_RETURN_NOT_OK(joined_schema.AddField(arrow::field(kRecordsColumn, arrow::int64(), false)));
+    ARROW_ASSIGN_OR_RAISE(auto schema, joined_schema.Finish());
+    std::vector<std::string> measures = CubeMeasures();
+    measures.push_back(kRecordsColumn);
+    std::vector<std::unique_ptr<HashAggregator>> aggregators;
+    for (const auto& set : CubeGroupingSets()) {
+        ARROW_ASSIGN_OR_RAISE(auto aggregator, HashAggregator::Make(*schema, set, measures));
+        aggregators.push_back(std::move(aggregator));
+    }
+    std::shared_ptr<arrow::Array> ones;
+    while (true) {
+        ARROW_ASSIGN_OR_RAISE(auto batch, reader->Next());
+        if (!batch) {
+            break;
+        }
+        for (const auto& dimension : dimensions) {
+            ARROW_ASSIGN_OR_RAISE(batch, JoinLevels(*batch, dimension));
+        }
+        if (!ones || ones->length() < batch->num_rows()) {
+            ARROW_ASSIGN_OR_RAISE(ones, arrow::MakeArrayFromScalar(arrow::Int64Scalar(1), batch->num_rows(),
+                                                                   memory_pool()));
+        }
+        ARROW_ASSIGN_OR_RAISE(batch, batch->AddColumn(batch->num_columns(), kRecordsColumn,
+                                                      ones->Slice(0, batch->num_rows())));
+        for (auto& aggregator : aggregators) {
+            ARROW_RETURN_NOT_OK(aggregator->Consume(*batch));
+        }
+    }
+
+    // Cells of every grouping set under one schema; levels outside a set
+    // are null. Level types are those the aggregators emit (e.g. utf8 for
+    // large_utf8 attributes); every level is in its hierarchy's set.
+    std::vector<std::shared_ptr<arrow::Table>> grouped;
+    for (const auto& aggregator : aggregators) {
+        ARROW_ASSIGN_OR_RAISE(auto groups, aggregator->Finish());
+        grouped.push_back(std::move(groups));
+    }
+    for (auto& field : level_fields) {
+        for (const auto& groups : grouped) {
+            if (auto column = groups->GetColumnByName(field->name())) {
+                field = field->WithType(column->type());
+                break;
+            }
+        }
+    }
+    std::vector<std::shared_ptr<arrow::Field>> fields = {arrow::field(kGroupingSetColumn, arrow::utf8())};
+    fields.insert(fields.end(), level_fields.begin(), level_fields.end());
+    std::vector<std::pair<std::string, std::string>> measure_columns;
+    for (const auto& measure : measures) {
+        measure_columns.emplace_back(measure + "_sum", measure);
+    }
+    std::vector<std::shared_ptr<arrow::Table>> cells;
+    for (size_t s = 0; s < grouped.size(); ++s) {
+        const auto& groups = grouped[s];
+        const int64_t rows = groups->num_rows();
+        std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+        ARROW_ASSIGN_OR_RAISE(auto name, arrow::MakeArrayFromScalar(
+                                             arrow::StringScalar(GroupingSetName(CubeGroupingSets()[s])),
+                                             rows, memory_pool()));
+        columns.push_back(std::make_shared<arrow::ChunkedArray>(name));
+        for (const auto& field : level_fields) {
+            auto column = groups->GetColumnByName(field->name());
+            if (!column) {
+                ARROW_ASSIGN_OR_RAISE(auto nulls, arrow::MakeArrayOfNull(field->type(), rows, memory_pool()));
+                column = std::make_shared<arrow::ChunkedArray>(nulls);
+            }
+            columns.push_back(column);
+        }
+        for (const auto& [from, to] : measure_columns) {
+            columns.push_back(groups->GetColumnByName(from));
+        }
+        if (s == 0) {
+            for (const auto& [from, to] : measure_columns) {
+                fields.push_back(arrow::field(to, groups->GetColumnByName(from)->type()));
+            }
+        }
+        cells.push_back(arrow::Table::Make(arrow::schema(fields), columns, rows));
+    }
+
+    ARROW_ASSIGN_OR_RAISE(auto table, arrow::ConcatenateTables(cells, arrow::ConcatenateTablesOptions::Defaults(),
+                                                               memory_pool()));
+    ARROW_ASSIGN_OR_RAISE(cube->table_, table->CombineChunks(memory_pool()));
+    cube->table_ = cube->table_->ReplaceSchemaMetadata(
+        arrow::key_value_metadata({kCubeFingerprintKey}, {cube->fingerprint_}));
+    return cube;
+}
+
+arrow::Result<std::shared_ptr<SalesCube>> SalesCube::Read(const std::string& path) {
+    ARROW_ASSIGN_OR_RAISE(auto source, ParquetSource::Open(path));
+    std::shared_ptr<SalesCube> cube(new SalesCube());
+    ARROW_ASSIGN_OR_RAISE(cube->table_, source->ReadTable({}));
+    const auto& metadata = source->schema()->metadata();
+    const int index = metadata ? metadata->FindKey(kCubeFingerprintKey) : -1;
+    if (index < 0) {
+        return arrow::Status::Invalid(path, " has no ", kCubeFingerprintKey, " metadata; not a sales cube");
+    }
+    cube->fingerprint_ = metadata->value(index);
+    return cube;
+}
+
+arrow::Status SalesCube::Write(const std::string& path) const {
+    ARROW_ASSIGN_OR_RAISE(auto file, arrow::io::FileOutputStream::Open(path));
+    // Storing the Arrow schema also stores its metadata, with the
+    // fingerprint, as key-value pairs in the file footer
+    auto arrow_properties = parquet::ArrowWriterProperties::Builder().store_schema()->build();
+    ARROW_RETURN_NOT_OK(parquet::arrow::WriteTable(*table_, memory_pool(), file, table_->num_rows(),
+                                                   parquet::default_writer_properties(), arrow_properties));
+    return file->Close();
+}
+
+arrow::Result<std::shared_ptr<arrow::Table>> SalesCube::Rollup(const std::vector<std::string>& levels) const {
+    TraceSpan span(kStageAggregate, "SalesCube::Rollup");
+    const std::vector<std::string>* set = FindGroupingSet(levels);
+    if (!set) {
+        return arrow::Status::Invalid("No cube grouping set covers (", GroupingSetName(levels), ")");
+    }
+    // Cells of the set whose requested levels are all known; a null level
+    // holds the facts without a row in that dimension, which a query
+    // joining the dimension leaves out
+    ARROW_ASSIGN_OR_RAISE(auto mask, cp::CallFunction("equal",
+                                                      {table_->GetColumnByName(kGroupingSetColumn),
+                                                       arrow::MakeScalar(GroupingSetName(*set))},
+                                                      exec_context()));
+    for (const auto& level : levels) {
+        ARROW_ASSIGN_OR_RAISE(auto known, cp::CallFunction("is_valid", {table_->GetColumnByName(level)},
+                                                           exec_context()));
+        ARROW_ASSIGN_OR_RAISE(mask, cp::CallFunction("and", {mask, known}, exec_context()));
+    }
+    ARROW_ASSIGN_OR_RAISE(auto cells, cp::Filter(table_, mask, cp::FilterOptions::Defaults(), exec_context()));
+
+    std::vector<std::string> measures = CubeMeasures();
+    measures.push_back(kRecordsColumn);
+    ARROW_ASSIGN_OR_RAISE(auto aggregator, HashAggregator::Make(*cells.table(), levels, measures));
+    ARROW_RETURN_NOT_OK(ForEachBatch(*cells.table(), kDefaultBatchRows, [&](const arrow::RecordBatch& batch) {
+        return aggregator->Consume(batch);
+    }));
+    ARROW_ASSIGN_OR_RAISE(auto groups, aggregator->Finish());
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+    for (const auto& level : levels) {
+        fields.push_back(groups->schema()->GetFieldByName(level));
+        columns.push_back(groups->GetColumnByName(level));
+    }
+    for (const auto& measure : measures) {
+        fields.push_back(groups->schema()->GetFieldByName(measure + "_sum"));
+        columns.push_back(groups->GetColumnByName(measure + "_sum"));
+    }
+    return arrow::Table::Make(arrow::schema(fields), columns, groups->num_rows());
+}
+
+}  // namespace olap
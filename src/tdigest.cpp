@@ -0,0 +1,239 @@
+#include "tdigest.h"
+#include "arrow_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+namespace olap {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// k1 scale function and its inverse: k(q) = compression / (2 pi) * asin(2q - 1).
+// A centroid may only span one unit of k.
+double ScaleK(double q, double compression) {
+    return compression / (2 * kPi) * std::asin(2 * q - 1);
+}
+
+double ScaleQ(double k, double compression) {
+    if (k >= compression / 4) {
+        return 1;
+    }
+    return (std::sin(k * 2 * kPi / compression) + 1) / 2;
+}
+
+// Sorts doubles (no NaN) by LSD radix sort over order-preserving 64-bit
+// keys, one byte per pass; passes where every key has the same byte are
+// skipped. Several times faster than comparison sorting buffer-sized runs.
+void RadixSort(std::vector<double>& values, std::vector<uint64_t>& keys, std::vector<uint64_t>& scratch) {
+    const size_t n = values.size();
+    if (n < 2) {
+        return;
+    }
+    keys.resize(n);
+    scratch.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t bits;
+        std::memcpy(&bits, &values[i], sizeof(bits));
+        // Negative values: flip every bit; positive: flip the sign bit
+        keys[i] = bits ^ ((bits >> 63) ? ~uint64_t{0} : uint64_t{1} << 63);
+    }
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t counts[257] = {};
+        for (size_t i = 0; i < n; ++i) {
+            ++counts[((keys[i] >> shift) & 0xFF) + 1];
+        }
+        if (counts[((keys[0] >> shift) & 0xFF) + 1] == n) {
+            continue;
+        }
+        for (int b = 0; b < 256; ++b) {
+            counts[b + 1] += counts[b];
+        }
+        for (size_t i = 0; i < n; ++i) {
+            scratch[counts[(keys[i] >> shift) & 0xFF]++] = keys[i];
+        }
+        keys.swap(scratch);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        const uint64_t bits = keys[i] ^ ((keys[i] >> 63) ? uint64_t{1} << 63 : ~uint64_t{0});
+        std::memcpy(&values[i], &bits, sizeof(bits));
+    }
+}
+
+}  // namespace
+
+TDigest::TDigest(double compression)
+    : compression_(std::max(compression, 10.0)),
+      buffer_limit_(std::max<size_t>(4096, static_cast<size_t>(10 * compression_))),
+      min_(std::numeric_limits<double>::infinity()),
+      max_(-std::numeric_limits<double>::infinity()) {}
+
+void TDigest::Add(double value) {
+    if (std::isnan(value)) {
+        return;
+    }
+    buffer_.push_back(value);
+    buffered_weight_ += 1;
+    if (buffer_.size() >= buffer_limit_) {
+        Compress();
+    }
+}
+
+arrow::Status TDigest::Add(const arrow::Array& values) {
+    const uint8_t* validity = values.null_count() > 0 ? values.null_bitmap_data() : nullptr;
+    return VisitNumericValues(values, [&](const auto* data) {
+        // Append buffer-sized runs, then compress
+        for (int64_t begin = 0; begin < values.length();) {
+            const int64_t room = static_cast<int64_t>(buffer_limit_ - buffer_.size());
+            const int64_t end = std::min(values.length(), begin + room);
+            const size_t before = buffer_.size();
+            for (int64_t i = begin; i < end; ++i) {
+                const double value = static_cast<double>(data[i]);
+                if ((validity == nullptr || arrow::bit_util::GetBit(validity, values.offset() + i)) &&
+                    !std::isnan(value)) {
+                    buffer_.push_back(value);
+                }
+            }
+            buffered_weight_ += static_cast<double>(buffer_.size() - before);
+            begin = end;
+            if (buffer_.size() >= buffer_limit_) {
+                Compress();
+            }
+        }
+        return arrow::Status::OK();
+    });
+}
+
+void TDigest::Merge(const TDigest& other) {
+    if (other.count() == 0) {
+        return;
+    }
+    other.Compress();
+    incoming_.insert(incoming_.end(), other.centroids_.begin(), other.centroids_.end());
+    buffered_weight_ += other.merged_weight_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    if (incoming_.size() >= buffer_limit_ / 4) {
+        Compress();
+    }
+}
+
+void TDigest::Compress() const {
+    if (buffer_.empty() && incoming_.empty()) {
+        return;
+    }
+    RadixSort(buffer_, keys_, key_scratch_);
+    if (!buffer_.empty()) {
+        min_ = std::min(min_, buffer_.front());
+        max_ = std::max(max_, buffer_.back());
+    }
+    auto by_mean = [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; };
+    if (!incoming_.empty()) {
+        std::sort(incoming_.begin(), incoming_.end(), by_mean);
+        scratch_.resize(centroids_.size() + incoming_.size());
+        std::merge(centroids_.begin(), centroids_.end(), incoming_.begin(), incoming_.end(),
+                   scratch_.begin(), by_mean);
+        centroids_.swap(scratch_);
+        incoming_.clear();
+    }
+
+    // One sweep over the centroids and the sorted values in mean order,
+    // folding neighbours while the result spans at most one unit of k
+    const double total = merged_weight_ + buffered_weight_;
+    scratch_.clear();
+    size_t c = 0, v = 0;
+    auto next = [&]() -> Centroid {
+        if (v == buffer_.size() || (c < centroids_.size() && centroids_[c].mean <= buffer_[v])) {
+            return centroids_[c++];
+        }
+        return {buffer_[v++], 1};
+    };
+    const size_t inputs = centroids_.size() + buffer_.size();
+    Centroid current = next();
+    double weight_before = 0;  // weight of the centroids already emitted
+    double limit = total * ScaleQ(ScaleK(0, compression_) + 1, compression_);
+    for (size_t i = 1; i < inputs; ++i) {
+        const Centroid item = next();
+        if (weight_before + current.weight + item.weight <= limit) {
+            current.weight += item.weight;
+            current.mean += (item.mean - current.mean) * item.weight / current.weight;
+        } else {
+            scratch_.push_back(current);
+            weight_before += current.weight;
+            limit = total * ScaleQ(ScaleK(weight_before / total, compression_) + 1, compression_);
+            current = item;
+        }
+    }
+    scratch_.push_back(current);
+    centroids_.swap(scratch_);
+
+    buffer_.clear();
+    merged_weight_ = total;
+    buffered_weight_ = 0;
+}
+
+double TDigest::Quantile(double q) const {
+    Compress();
+    if (centroids_.empty()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (q <= 0) {
+        return min_;
+    }
+    if (q >= 1) {
+        return max_;
+    }
+
+    // Centroid i sits at the centre of its rank range; with all weights 1
+    // this is linear interpolation between order statistics at q * (n - 1)
+    const double target = q * (merged_weight_ - 1) + 0.5;
+    const Centroid& first = centroids_.front();
+    if (target < first.weight / 2) {
+        return min_ + (first.mean - min_) * target / (first.weight / 2);
+    }
+    double rank = 0;  // rank where centroid i begins
+    for (size_t i = 0; i + 1 < centroids_.size(); ++i) {
+        const double left = rank + centroids_[i].weight / 2;
+        const double right = rank + centroids_[i].weight + centroids_[i + 1].weight / 2;
+        if (target < right) {
+            const double t = (target - left) / (right - left);
+            return centroids_[i].mean + t * (centroids_[i + 1].mean - centroids_[i].mean);
+        }
+        rank += centroids_[i].weight;
+    }
+    const Centroid& last = centroids_.back();
+    const double left = merged_weight_ - last.weight / 2;
+    const double t = std::min(1.0, (target - left) / (last.weight / 2));
+    return last.mean + t * (max_ - last.mean);
+}
+
+double TDigest::MaxRankError(double q) const {
+    q = std::min(1.0, std::max(0.0, q));
+    return kPi * std::sqrt(q * (1 - q)) / compression_;
+}
+
+double TDigest::min() const {
+    Compress();
+    return min_;
+}
+
+double TDigest::max() const {
+    Compress();
+    return max_;
+}
+
+size_t TDigest::num_centroids() const {
+    Compress();
+    return centroids_.size();
+}
+
+std::string PercentileName(double q) {
+    std::ostringstream name;
+    name << "p" << std::round(q * 1e4) / 100;
+    return name.str();
+}
+
+}  // namespace olap
@@ -0,0 +1,218 @@
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace olap {
+
+namespace detail {
+std::atomic<bool> tracing_enabled{std::getenv("OLAP_TRACE") != nullptr && *std::getenv("OLAP_TRACE") != '\0'};
+}  // namespace detail
+
+namespace {
+
+struct SpanRecord {
+    const char* stage;
+    const char* name;
+    int64_t start_ns;
+    int64_t duration_ns;
+    std::string detail;
+};
+
+// The spans of one thread, appended only by that thread
+struct ThreadTrace {
+    int tid;
+    std::vector<SpanRecord> spans;
+};
+
+// Thread buffers outlive their threads, so worker spans survive until the
+// trace is written
+struct TraceRegistry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadTrace>> threads;
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+TraceRegistry& Registry() {
+    static TraceRegistry registry;
+    return registry;
+}
+
+ThreadTrace& CurrentThreadTrace() {
+    thread_local ThreadTrace* trace = [] {
+        TraceRegistry& registry = Registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.threads.push_back(std::make_unique<ThreadTrace>());
+        registry.threads.back()->tid = static_cast<int>(registry.threads.size());
+        return registry.threads.back().get();
+    }();
+    return *trace;
+}
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                Registry().epoch)
+        .count();
+}
+
+void AppendJsonString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out << escaped;
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+}  // namespace
+
+void SetTracingEnabled(bool enabled) {
+    detail::tracing_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void TraceSpan::Begin(const char* stage, const char* name) {
+    stage_ = stage;
+    name_ = name;
+    start_ns_ = NowNs();
+}
+
+void TraceSpan::End() {
+    const int64_t end_ns = NowNs();
+    CurrentThreadTrace().spans.push_back({stage_, name_, start_ns_, end_ns - start_ns_, std::move(detail_)});
+}
+
+std::string ChromeTraceJson() {
+    TraceRegistry& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto& thread : registry.threads) {
+        out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->tid
+            << ",\"args\":{\"name\":\"" << (thread->tid == 1 ? "main" : "worker " + std::to_string(thread->tid))
+            << "\"}}";
+        first = false;
+        for (const auto& span : thread->spans) {
+            // Complete events ("X"), timestamps in microseconds
+            out << ",\n{\"name\":";
+            AppendJsonString(out, span.name);
+            out << ",\"cat\":";
+            AppendJsonString(out, span.stage);
+            out << ",\"ph\":\"X\",\"ts\":" << span.start_ns / 1000.0 << ",\"dur\":" << span.duration_ns / 1000.0
+                << ",\"pid\":1,\"tid\":" << thread->tid;
+            if (!span.detail.empty()) {
+                out << ",\"args\":{\"detail\":";
+                AppendJsonString(out, span.detail);
+                out << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+    return out.str();
+}
+
+void PrintTraceSummary(std::ostream& out) {
+    struct StageTotals {
+        int64_t spans = 0;
+        int64_t total_ns = 0;
+        int64_t self_ns = 0;
+        int64_t max_ns = 0;
+    };
+    std::map<std::string, StageTotals> stages;
+    {
+        TraceRegistry& registry = Registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (const auto& thread : registry.threads) {
+            // Spans of a thread nest; each span's self time excludes the
+            // spans directly inside it
+            std::vector<const SpanRecord*> spans;
+            for (const auto& span : thread->spans) {
+                spans.push_back(&span);
+            }
+            std::sort(spans.begin(), spans.end(), [](const SpanRecord* a, const SpanRecord* b) {
+                return a->start_ns != b->start_ns ? a->start_ns < b->start_ns : a->duration_ns > b->duration_ns;
+            });
+            std::vector<int64_t> self(spans.size());
+            std::vector<size_t> open;
+            for (size_t i = 0; i < spans.size(); ++i) {
+                while (!open.empty() &&
+                       spans[open.back()]->start_ns + spans[open.back()]->duration_ns <= spans[i]->start_ns) {
+                    open.pop_back();
+                }
+                if (!open.empty()) {
+                    self[open.back()] -= spans[i]->duration_ns;
+                }
+                self[i] = spans[i]->duration_ns;
+                open.push_back(i);
+            }
+            for (size_t i = 0; i < spans.size(); ++i) {
+                StageTotals& totals = stages[spans[i]->stage];
+                ++totals.spans;
+                totals.total_ns += spans[i]->duration_ns;
+                totals.self_ns += self[i];
+                totals.max_ns = std::max(totals.max_ns, spans[i]->duration_ns);
+            }
+        }
+    }
+
+    out << "\nTrace Summary (all threads)\n";
+    out << "===========================\n";
+    out << std::setw(12) << "stage" << std::setw(10) << "spans" << std::setw(14) << "total ms" << std::setw(14)
+        << "self ms" << std::setw(14) << "max ms" << "\n";
+    out << std::string(64, '-') << "\n";
+    const auto ms = [](int64_t ns) { return ns / 1e6; };
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(2);
+    for (const auto& [stage, totals] : stages) {
+        out << std::setw(12) << stage << std::setw(10) << totals.spans << std::setw(14) << ms(totals.total_ns)
+            << std::setw(14) << ms(totals.self_ns) << std::setw(14) << ms(totals.max_ns) << "\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void ClearTrace() {
+    TraceRegistry& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto& thread : registry.threads) {
+        thread->spans.clear();
+    }
+}
+
+bool FinishTrace(std::ostream& out) {
+    if (!TracingEnabled()) {
+        return true;
+    }
+    const char* path = std::getenv("OLAP_TRACE");
+    PrintTraceSummary(out);
+    if (!path || !*path) {
+        return true;
+    }
+    std::ofstream file(path);
+    file << ChromeTraceJson();
+    if (!file) {
+        return false;
+    }
+    out << "Chrome trace written to " << path << "\n";
+    return true;
+}
+
+}  // namespace olap